@@ -12,26 +12,23 @@ TARGET = GDV-Framework
 TEMPLATE = app
 CONFIG += c++11
 
+include(framework/framework.pri)
+include(lectures.pri)
+
 SOURCES += main.cpp\
         framework/mainwindow.cpp \
-    framework/meshloader.cpp \
     framework/slotmapper.cpp \
-    framework/performancemonitor.cpp \
     framework/gdvcanvas2d.cpp \
-    framework/gdvcanvas3d.cpp \   
-    examples/frameworkexample.cpp
+    framework/gdvcanvas3d.cpp \
+    framework/renderthread.cpp \
+    framework/framegraph.cpp
 
 HEADERS  += framework/mainwindow.h \
-    framework/meshloader.h \
-    interfaces/GdvCanvas.h \
-    interfaces/GdvGui.h \
     framework/slotmapper.h \
-    interfaces/RendererBase.h \
-    framework/performancemonitor.h \
     framework/gdvcanvas2d.h \
     framework/gdvcanvas3d.h \
-    interfaces/Tuple3.h \
-    examples/frameworkexample.h
+    framework/renderthread.h \
+    framework/framegraph.h
 
 FORMS    += framework/mainwindow.ui
 
@@ -45,4 +42,3 @@ meshes.path = $$OUT_PWD/meshes/
 
 INSTALLS += textures meshes
 
-
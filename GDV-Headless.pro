@@ -0,0 +1,38 @@
+#
+# Leibniz Universität Hannover - Institute for Man-Machine-Communication
+# Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+#
+# You should have received a copy of the MIT License along with this program.
+#
+# Zeichnet eine Abgabe ohne Fenster und Display und misst die Zeit je Bild,
+# z.B. für automatisierte Performance-Messungen (siehe GDV-Headless --help).
+#
+
+# RendererBase.h bindet QtOpenGL ein, es wird aber kein Widget erzeugt
+QT       += core gui opengl
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = GDV-Headless
+TEMPLATE = app
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+include(framework/framework.pri)
+include(lectures.pri)
+
+SOURCES += headless/main.cpp \
+    headless/headlessgui.cpp \
+    headless/headlessrunner.cpp
+
+HEADERS += headless/headlessgui.h \
+    headless/headlessrunner.h
+
+QMAKE_CXXFLAGS_RELEASE = -O3
+
+textures.files = textures/*
+textures.path = $$OUT_PWD/textures/
+
+meshes.files = meshes/*
+meshes.path = $$OUT_PWD/meshes/
+
+INSTALLS += textures meshes
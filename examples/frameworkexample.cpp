@@ -86,9 +86,28 @@ QVector3D FrameworkExample::mixColors(QVector3D first, QVector3D second, float a
 
 void FrameworkExample::render(GdvCanvas& canvas)
 {
+    // Wird nur aufgerufen, wenn usesTiles() false liefert: Das ganze Bild
+    // ist dann eine einzige Kachel.
+    beginFrame(canvas);
+    renderTile(canvas, QRect(0, 0, viewWidth, viewHeight));
+    canvas.flipBuffer();
+}
+
+bool FrameworkExample::usesTiles()
+{
+    return true;
+}
+
+void FrameworkExample::beginFrame(GdvCanvas& canvas)
+{
+    Q_UNUSED(canvas);
+
     if(animate)
         time = time + timeStep/100.0f * 0.1f;
+}
 
+void FrameworkExample::renderTile(GdvCanvas& canvas, const QRect& tile)
+{
     int midX = viewWidth / 2;
     int midY = viewHeight / 2;
 
@@ -96,17 +115,21 @@ void FrameworkExample::render(GdvCanvas& canvas)
 
     canvas.clearBuffer(QVector3D(1.0, 1.0, 1.0));
 
-    for(int y = midY - size; y <= midY + size; y++)
+    // Nur den Teil des Quadrats zeichnen, der in dieser Kachel liegt
+    int startY = qMax(midY - size, tile.top());
+    int endY = qMin(midY + size, tile.bottom());
+    int startX = qMax(midX - size, tile.left());
+    int endX = qMin(midX + size, tile.right());
+
+    for(int y = startY; y <= endY; y++)
     {
-        for(int x = midX - size; x <= midX + size; x++)
+        for(int x = startX; x <= endX; x++)
         {
             float value = prettyFunction(midX - x, midY - y) * amplitude;
             QVector3D color = mixColors(firstColor, secondColor, value);
             canvas.setPixel(x, y, color);
         }
     }
-
-    canvas.flipBuffer();
 }
 
 void FrameworkExample::deinitialize()
@@ -35,6 +35,9 @@ public:
     void select(int index);
 
     // Optionale Methoden aus RendererBase
+    virtual bool usesTiles();
+    virtual void beginFrame(GdvCanvas& canvas);
+    virtual void renderTile(GdvCanvas& canvas, const QRect& tile);
     virtual void wheelMoved(int delta);
     virtual void keyPressed(QString key);
     virtual void keyReleased(QString key);
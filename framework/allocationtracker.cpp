@@ -0,0 +1,368 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "allocationtracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(GDV_ALLOC_TRACKING) && defined(__GLIBC__)
+#define GDV_TRACK_MALLOC
+#include <execinfo.h>
+#include <cxxabi.h>
+#endif
+
+#ifdef GDV_ALLOC_TRACKING
+
+// Alles hier wird aus malloc bzw. operator new heraus aufgerufen und darf
+// daher selbst keinen Speicher anfordern. Die Zähler sind konstant
+// initialisiert und damit schon vor allen Konstruktoren gültig.
+static std::atomic<qint64> totalAllocations(0);
+static std::atomic<qint64> totalFrees(0);
+static std::atomic<qint64> totalBytes(0);
+static thread_local AllocationTracker::Counters threadCounters;
+
+#ifdef GDV_TRACK_MALLOC
+// Rücksprungadressen je Aufrufstelle; die ersten beiden sind recordCallSite und malloc
+static const int CallSiteDepth = 8;
+static const int SkippedFrames = 2;
+static const int CallSiteSlots = 1024;
+
+struct CallSiteSlot
+{
+    void* frames[CallSiteDepth];
+    int depth;
+    qint64 allocations;
+    qint64 bytes;
+};
+
+static CallSiteSlot callSites[CallSiteSlots];
+static std::atomic_flag callSiteLock = ATOMIC_FLAG_INIT;
+static std::atomic<bool> captureCallSites(false);
+static thread_local bool insideCapture = false;   // backtrace fordert beim ersten Aufruf selbst Speicher an
+
+static __attribute__((noinline)) void recordCallSite(size_t size)
+{
+    if(insideCapture)
+        return;
+    insideCapture = true;
+
+    void* trace[CallSiteDepth + SkippedFrames];
+    const int depth = qMax(backtrace(trace, CallSiteDepth + SkippedFrames) - SkippedFrames, 0);
+    void** frames = trace + SkippedFrames;
+
+    quintptr hash = depth;
+    for(int n = 0; n < depth; n++)
+        hash = hash * 31 + reinterpret_cast<quintptr>(frames[n]);
+
+    while(callSiteLock.test_and_set(std::memory_order_acquire))
+        ;
+
+    // Offene Adressierung; ist die Umgebung voll, wird die Aufrufstelle nicht erfasst
+    for(int probe = 0; probe < 16; probe++)
+    {
+        CallSiteSlot& slot = callSites[(hash + probe) % CallSiteSlots];
+        if(slot.depth == 0)
+        {
+            memcpy(slot.frames, frames, depth * sizeof(void*));
+            slot.depth = depth;
+        }
+        else if(slot.depth != depth || memcmp(slot.frames, frames, depth * sizeof(void*)) != 0)
+            continue;
+
+        slot.allocations++;
+        slot.bytes += size;
+        break;
+    }
+
+    callSiteLock.clear(std::memory_order_release);
+    insideCapture = false;
+}
+#endif
+
+static inline void countAllocation(size_t size)
+{
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    totalBytes.fetch_add(size, std::memory_order_relaxed);
+    threadCounters.allocations++;
+    threadCounters.bytes += size;
+
+#ifdef GDV_TRACK_MALLOC
+    if(captureCallSites.load(std::memory_order_relaxed))
+        recordCallSite(size);
+#endif
+}
+
+static inline void countFree()
+{
+    totalFrees.fetch_add(1, std::memory_order_relaxed);
+    threadCounters.frees++;
+}
+
+#ifdef GDV_TRACK_MALLOC
+
+// glibc stellt die eigentliche Implementierung unter diesen Namen bereit
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* pointer, size_t size);
+extern "C" void* __libc_memalign(size_t alignment, size_t size);
+extern "C" void __libc_free(void* pointer);
+
+extern "C" void* malloc(size_t size) __THROW
+{
+    void* pointer = __libc_malloc(size);
+    if(pointer)
+        countAllocation(size);
+    return pointer;
+}
+
+extern "C" void* calloc(size_t count, size_t size) __THROW
+{
+    void* pointer = __libc_calloc(count, size);
+    if(pointer)
+        countAllocation(count * size);
+    return pointer;
+}
+
+extern "C" void* realloc(void* pointer, size_t size) __THROW
+{
+    void* result = __libc_realloc(pointer, size);
+
+    // Zählt wie free und malloc, auch wenn der Block an Ort und Stelle wachsen konnte
+    if(pointer && (result || size == 0))
+        countFree();
+    if(result)
+        countAllocation(size);
+
+    return result;
+}
+
+extern "C" void* memalign(size_t alignment, size_t size) __THROW
+{
+    void* pointer = __libc_memalign(alignment, size);
+    if(pointer)
+        countAllocation(size);
+    return pointer;
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size) __THROW
+{
+    return memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void** result, size_t alignment, size_t size) __THROW
+{
+    if(alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+
+    void* pointer = memalign(alignment, size);
+    if(!pointer)
+        return ENOMEM;
+
+    *result = pointer;
+    return 0;
+}
+
+extern "C" void free(void* pointer) __THROW
+{
+    if(pointer)
+        countFree();
+    __libc_free(pointer);
+}
+
+#else
+
+// Ohne glibc: operator new und delete ersetzen, die Container von Qt werden so nicht erfasst
+void* operator new(std::size_t size)
+{
+    void* pointer = std::malloc(size ? size : 1);
+    if(!pointer)
+        throw std::bad_alloc();
+    countAllocation(size);
+    return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    void* pointer = std::malloc(size ? size : 1);
+    if(pointer)
+        countAllocation(size);
+    return pointer;
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if(pointer)
+        countFree();
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    operator delete(pointer);
+}
+
+#endif
+
+#endif // GDV_ALLOC_TRACKING
+
+bool AllocationTracker::isAvailable()
+{
+#ifdef GDV_ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocationTracker::Counters AllocationTracker::total()
+{
+#ifdef GDV_ALLOC_TRACKING
+    Counters counters = { totalAllocations.load(std::memory_order_relaxed),
+                          totalFrees.load(std::memory_order_relaxed),
+                          totalBytes.load(std::memory_order_relaxed) };
+    return counters;
+#else
+    Counters counters = { 0, 0, 0 };
+    return counters;
+#endif
+}
+
+AllocationTracker::Counters AllocationTracker::thread()
+{
+#ifdef GDV_ALLOC_TRACKING
+    return threadCounters;
+#else
+    Counters counters = { 0, 0, 0 };
+    return counters;
+#endif
+}
+
+bool AllocationTracker::canCaptureCallSites()
+{
+#ifdef GDV_TRACK_MALLOC
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AllocationTracker::setCallSiteCapture(bool enabled)
+{
+#ifdef GDV_TRACK_MALLOC
+    if(enabled)
+    {
+        // Lädt ggf. die Bibliothek für backtrace, bevor malloc sie benötigt
+        void* frame;
+        backtrace(&frame, 1);
+
+        while(callSiteLock.test_and_set(std::memory_order_acquire))
+            ;
+        memset(callSites, 0, sizeof(callSites));
+        callSiteLock.clear(std::memory_order_release);
+    }
+
+    captureCallSites.store(enabled, std::memory_order_relaxed);
+#else
+    Q_UNUSED(enabled);
+#endif
+}
+
+#ifdef GDV_TRACK_MALLOC
+static QString symbolName(const char* symbol)
+{
+    // Format von backtrace_symbols: "datei(symbol+0x12) [0x...]", ohne Symbol bleibt es dabei
+    QString text = QString::fromLocal8Bit(symbol);
+    const int open = text.indexOf('(');
+    const int plus = text.indexOf('+', open);
+    const int close = text.indexOf(')', plus);
+    if(open < 0 || plus <= open + 1 || close < 0)
+        return text;
+
+    // Für C-Funktionen schlägt das fehl, der Name bleibt dann wie er ist
+    const QString mangled = text.mid(open + 1, plus - open - 1);
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(mangled.toLatin1().constData(), 0, 0, &status);
+    const QString name = status == 0 && demangled ? QString::fromLocal8Bit(demangled) : mangled;
+    free(demangled);
+
+    return name + text.mid(plus, close - plus);
+}
+#endif
+
+QVector<AllocationTracker::CallSite> AllocationTracker::topCallSites(int count)
+{
+    QVector<CallSite> result;
+
+#ifdef GDV_TRACK_MALLOC
+    // Die folgenden Anforderungen sollen nicht selbst als Aufrufstellen zählen
+    insideCapture = true;
+
+    QVector<CallSiteSlot> sites;
+    sites.reserve(CallSiteSlots);
+
+    while(callSiteLock.test_and_set(std::memory_order_acquire))
+        ;
+    for(int n = 0; n < CallSiteSlots; n++)
+    {
+        if(callSites[n].depth > 0)
+            sites.append(callSites[n]);
+    }
+    callSiteLock.clear(std::memory_order_release);
+
+    std::sort(sites.begin(), sites.end(), [](const CallSiteSlot& a, const CallSiteSlot& b)
+    {
+        return a.allocations > b.allocations;
+    });
+
+    for(int n = 0; n < sites.size() && n < count; n++)
+    {
+        CallSite site;
+        site.allocations = sites[n].allocations;
+        site.bytes = sites[n].bytes;
+
+        char** symbols = backtrace_symbols(sites[n].frames, sites[n].depth);
+        for(int f = 0; symbols && f < sites[n].depth; f++)
+            site.frames.append(symbolName(symbols[f]));
+        free(symbols);
+
+        result.append(site);
+    }
+
+    insideCapture = false;
+#else
+    Q_UNUSED(count);
+#endif
+
+    return result;
+}
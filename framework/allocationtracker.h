@@ -0,0 +1,88 @@
+#ifndef ALLOCATIONTRACKER_H
+#define ALLOCATIONTRACKER_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QtGlobal>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Die AllocationTracker Klasse
+ *
+ * Zählt Speicheranforderungen und -freigaben des ganzen Programms, z.B. um zu
+ * prüfen, ob render im eingeschwungenen Zustand ohne neuen Speicher auskommt.
+ * Versteckte Anforderungen (QString bei Tastendrücken, QStringList beim
+ * Einlesen, das Abkoppeln eines QImage, ...) sind eine häufige Ursache für
+ * schwankende Bildzeiten.
+ *
+ * Gezählt wird nur, wenn mit "qmake CONFIG+=gdv_alloc_tracking" übersetzt
+ * wurde (siehe isAvailable), sonst liefern alle Methoden 0. Unter Linux
+ * (glibc) werden dazu malloc, calloc, realloc und free ersetzt, das erfasst
+ * auch die Container von Qt; auf anderen Systemen nur operator new und
+ * delete.
+ *
+ * PerformanceMonitor ermittelt daraus die Anforderungen je Bild, der Profiler
+ * die je Zone. Unter glibc lassen sich zusätzlich die Aufrufstellen mit den
+ * meisten Anforderungen ermitteln (setCallSiteCapture, topCallSites).
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class AllocationTracker
+{
+public:
+    struct Counters
+    {
+        qint64 allocations;
+        qint64 frees;
+        qint64 bytes;       // Angeforderte Bytes, Freigaben werden nicht abgezogen
+
+        Counters operator-(const Counters& other) const
+        {
+            Counters difference = { allocations - other.allocations, frees - other.frees, bytes - other.bytes };
+            return difference;
+        }
+    };
+
+    struct CallSite
+    {
+        qint64 allocations;
+        qint64 bytes;
+        QStringList frames;     // Aufrufer zuerst
+    };
+
+    static bool isAvailable();
+
+    /**
+     * @brief total Alle Anforderungen seit Programmstart, aus allen Threads
+     */
+    static Counters total();
+
+    /**
+     * @brief thread Alle Anforderungen des aufrufenden Threads seit dessen Start
+     */
+    static Counters thread();
+
+    static bool canCaptureCallSites();
+
+    /**
+     * @brief setCallSiteCapture Merkt sich ab jetzt zu jeder Anforderung die Aufrufstelle
+     *
+     * Das kostet ein Vielfaches einer Anforderung, die Bildzeiten sind
+     * währenddessen also nicht aussagekräftig. Einschalten verwirft die
+     * bisher gesammelten Aufrufstellen.
+     */
+    static void setCallSiteCapture(bool enabled);
+
+    /**
+     * @brief topCallSites Die count Aufrufstellen mit den meisten Anforderungen, absteigend
+     */
+    static QVector<CallSite> topCallSites(int count);
+};
+
+#endif // ALLOCATIONTRACKER_H
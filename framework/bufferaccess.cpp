@@ -0,0 +1,93 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "bufferaccess.h"
+#include "pixelconversion.h"
+
+#include <cstring>
+
+void BufferAccess::fillSpan(const GdvCanvas::BufferMapping& mapping, unsigned int x, unsigned int y, unsigned int length, const QVector3D& color)
+{
+    if(mapping.format == GdvCanvas::FormatRGB32)
+    {
+        PixelConversion::fillRow(mapping.rgbLine(y) + x, PixelConversion::toRgb(color), length);
+        return;
+    }
+
+    float* target = mapping.floatLine(y) + 4 * x;
+    for(unsigned int n = 0; n < length; n++, target += 4)
+    {
+        target[0] = color.x();
+        target[1] = color.y();
+        target[2] = color.z();
+        target[3] = 1.0f;
+    }
+}
+
+void BufferAccess::storeRow(const GdvCanvas::BufferMapping& mapping, unsigned int x, unsigned int y, unsigned int length, const float* rgb)
+{
+    if(mapping.format == GdvCanvas::FormatRGB32)
+    {
+        PixelConversion::convertRow(rgb, mapping.rgbLine(y) + x, length);
+        return;
+    }
+
+    float* target = mapping.floatLine(y) + 4 * x;
+    for(unsigned int n = 0; n < length; n++, target += 4, rgb += 3)
+    {
+        target[0] = rgb[0];
+        target[1] = rgb[1];
+        target[2] = rgb[2];
+        target[3] = 1.0f;
+    }
+}
+
+void BufferAccess::storeRow(const GdvCanvas::BufferMapping& mapping, unsigned int x, unsigned int y, unsigned int length, const QRgb* pixels)
+{
+    if(mapping.format == GdvCanvas::FormatRGB32)
+    {
+        memcpy(mapping.rgbLine(y) + x, pixels, length * sizeof(QRgb));
+        return;
+    }
+
+    const float scale = 1.0f / 255.0f;
+    float* target = mapping.floatLine(y) + 4 * x;
+    for(unsigned int n = 0; n < length; n++, target += 4)
+    {
+        target[0] = qRed(pixels[n]) * scale;
+        target[1] = qGreen(pixels[n]) * scale;
+        target[2] = qBlue(pixels[n]) * scale;
+        target[3] = 1.0f;
+    }
+}
+
+QVector3D BufferAccess::getPixel(const GdvCanvas::BufferMapping& mapping, unsigned int x, unsigned int y)
+{
+    if(mapping.format == GdvCanvas::FormatRGB32)
+    {
+        const QRgb pixel = mapping.rgbLine(y)[x];
+        const float scale = 1.0f / 255.0f;
+        return QVector3D(qRed(pixel) * scale, qGreen(pixel) * scale, qBlue(pixel) * scale);
+    }
+
+    const float* pixel = mapping.floatLine(y) + 4 * x;
+    return QVector3D(pixel[0], pixel[1], pixel[2]);
+}
+
+void BufferAccess::loadRow(const GdvCanvas::BufferMapping& mapping, unsigned int x, unsigned int y, unsigned int length, QRgb* pixels)
+{
+    if(mapping.format == GdvCanvas::FormatRGB32)
+    {
+        memcpy(pixels, mapping.rgbLine(y) + x, length * sizeof(QRgb));
+        return;
+    }
+
+    PixelConversion::toneMapRow(mapping.floatLine(y) + 4 * x, pixels, length,
+                                GdvCanvas::ToneMapClamp, 1.0f, false);
+}
@@ -0,0 +1,46 @@
+#ifndef BUFFERACCESS_H
+#define BUFFERACCESS_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include "interfaces/GdvCanvas.h"
+
+/**
+ * Schreib- und Lesezugriffe auf einen abgebildeten Back-Buffer, unabhängig
+ * von dessen Pixelformat. Die Koordinaten müssen bereits gegen den Puffer
+ * geprüft sein - dies übernehmen die GdvCanvas-Implementierungen.
+ *
+ * Interne Funktionen, bitte nicht direkt einbinden und/oder verändern!
+ */
+namespace BufferAccess
+{
+    inline void setPixel(const GdvCanvas::BufferMapping& mapping, unsigned int x, unsigned int y, const QVector3D& color)
+    {
+        if(mapping.format == GdvCanvas::FormatRGB32)
+        {
+            mapping.rgbLine(y)[x] = qRgb(color.x()*255, color.y()*255, color.z()*255);
+        }
+        else
+        {
+            float* pixel = mapping.floatLine(y) + 4 * x;
+            pixel[0] = color.x();
+            pixel[1] = color.y();
+            pixel[2] = color.z();
+            pixel[3] = 1.0f;
+        }
+    }
+
+    void fillSpan(const GdvCanvas::BufferMapping& mapping, unsigned int x, unsigned int y, unsigned int length, const QVector3D& color);
+    void storeRow(const GdvCanvas::BufferMapping& mapping, unsigned int x, unsigned int y, unsigned int length, const float* rgb);
+    void storeRow(const GdvCanvas::BufferMapping& mapping, unsigned int x, unsigned int y, unsigned int length, const QRgb* pixels);
+
+    QVector3D getPixel(const GdvCanvas::BufferMapping& mapping, unsigned int x, unsigned int y);
+    void loadRow(const GdvCanvas::BufferMapping& mapping, unsigned int x, unsigned int y, unsigned int length, QRgb* pixels);
+}
+
+#endif // BUFFERACCESS_H
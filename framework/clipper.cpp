@@ -0,0 +1,439 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "clipper.h"
+#include "simd.h"
+
+#include <QtGlobal>
+#include <algorithm>
+
+namespace
+{
+    enum { PlaneCount = 6 };
+
+    // Abstand zu den Ebenen -w <= x, x <= w, -w <= y, y <= w, -w <= z, z <= w (>= 0: innen)
+    inline float planeDistance(const float* position, int plane)
+    {
+        const float w = position[3];
+        switch(plane)
+        {
+        case 0: return w + position[0];
+        case 1: return w - position[0];
+        case 2: return w + position[1];
+        case 3: return w - position[1];
+        case 4: return w + position[2];
+        default: return w - position[2];
+        }
+    }
+
+    /**
+     * Liang-Barsky für vier Linien gleichzeitig. bounds: left, top, right,
+     * bottom. result: je vier x0, y0, x1, y1. Liefert die Bitmaske der
+     * sichtbaren Linien.
+     */
+    int clipLines4(const float* x0, const float* y0, const float* x1, const float* y1,
+                   const float* bounds, float* result)
+    {
+#ifdef GDV_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 left = _mm_set1_ps(bounds[0]);
+        const __m128 top = _mm_set1_ps(bounds[1]);
+        const __m128 right = _mm_set1_ps(bounds[2]);
+        const __m128 bottom = _mm_set1_ps(bounds[3]);
+
+        const __m128 ax = _mm_loadu_ps(x0);
+        const __m128 ay = _mm_loadu_ps(y0);
+        const __m128 dx = _mm_sub_ps(_mm_loadu_ps(x1), ax);
+        const __m128 dy = _mm_sub_ps(_mm_loadu_ps(y1), ay);
+
+        const __m128 p[4] = { _mm_sub_ps(zero, dx), dx, _mm_sub_ps(zero, dy), dy };
+        const __m128 q[4] = { _mm_sub_ps(ax, left), _mm_sub_ps(right, ax), _mm_sub_ps(ay, top), _mm_sub_ps(bottom, ay) };
+
+        __m128 t0 = zero;
+        __m128 t1 = _mm_set1_ps(1.0f);
+        __m128 reject = _mm_setzero_ps();
+
+        for(int n = 0; n < 4; n++)
+        {
+            // Parallel zur Kante und ausserhalb
+            reject = _mm_or_ps(reject, _mm_and_ps(_mm_cmpeq_ps(p[n], zero), _mm_cmplt_ps(q[n], zero)));
+
+            const __m128 t = _mm_div_ps(q[n], p[n]);
+            const __m128 entering = _mm_cmplt_ps(p[n], zero);
+            const __m128 leaving = _mm_cmpgt_ps(p[n], zero);
+            t0 = _mm_or_ps(_mm_and_ps(entering, _mm_max_ps(t0, t)), _mm_andnot_ps(entering, t0));
+            t1 = _mm_or_ps(_mm_and_ps(leaving, _mm_min_ps(t1, t)), _mm_andnot_ps(leaving, t1));
+        }
+
+        __m128 fromX = _mm_add_ps(ax, _mm_mul_ps(t0, dx));
+        __m128 fromY = _mm_add_ps(ay, _mm_mul_ps(t0, dy));
+        __m128 toX = _mm_add_ps(ax, _mm_mul_ps(t1, dx));
+        __m128 toY = _mm_add_ps(ay, _mm_mul_ps(t1, dy));
+
+        // NaN (auch aus unendlichen Koordinaten) verwerfen
+        __m128 accept = _mm_andnot_ps(reject, _mm_cmple_ps(t0, t1));
+        accept = _mm_and_ps(accept, _mm_and_ps(_mm_cmpord_ps(fromX, fromY), _mm_cmpord_ps(toX, toY)));
+
+        // Rundungsfehler dürfen nicht aus dem Rechteck führen
+        fromX = _mm_min_ps(_mm_max_ps(fromX, left), right);
+        fromY = _mm_min_ps(_mm_max_ps(fromY, top), bottom);
+        toX = _mm_min_ps(_mm_max_ps(toX, left), right);
+        toY = _mm_min_ps(_mm_max_ps(toY, top), bottom);
+
+        _mm_storeu_ps(result + 0, fromX);
+        _mm_storeu_ps(result + 4, fromY);
+        _mm_storeu_ps(result + 8, toX);
+        _mm_storeu_ps(result + 12, toY);
+        return _mm_movemask_ps(accept);
+#else
+        int mask = 0;
+        for(int lane = 0; lane < 4; lane++)
+        {
+            const float dx = x1[lane] - x0[lane];
+            const float dy = y1[lane] - y0[lane];
+            const float p[4] = { -dx, dx, -dy, dy };
+            const float q[4] = { x0[lane] - bounds[0], bounds[2] - x0[lane], y0[lane] - bounds[1], bounds[3] - y0[lane] };
+
+            float t0 = 0.0f, t1 = 1.0f;
+            bool reject = false;
+            for(int n = 0; n < 4; n++)
+            {
+                if(p[n] == 0.0f)
+                    reject |= q[n] < 0.0f;
+                else if(p[n] < 0.0f)
+                    t0 = qMax(t0, q[n] / p[n]);
+                else if(p[n] > 0.0f)
+                    t1 = qMin(t1, q[n] / p[n]);
+            }
+
+            const float fromX = x0[lane] + t0 * dx, fromY = y0[lane] + t0 * dy;
+            const float toX = x0[lane] + t1 * dx, toY = y0[lane] + t1 * dy;
+
+            // Selbstvergleich: false für NaN
+            if(reject || !(t0 <= t1) || fromX != fromX || fromY != fromY || toX != toX || toY != toY)
+                continue;
+
+            result[lane] = qBound(bounds[0], fromX, bounds[2]);
+            result[4 + lane] = qBound(bounds[1], fromY, bounds[3]);
+            result[8 + lane] = qBound(bounds[0], toX, bounds[2]);
+            result[12 + lane] = qBound(bounds[1], toY, bounds[3]);
+            mask |= 1 << lane;
+        }
+        return mask;
+#endif
+    }
+}
+
+void Clipper::LineBatch::clear()
+{
+    x0.clear();
+    y0.clear();
+    x1.clear();
+    y1.clear();
+    source.clear();
+}
+
+void Clipper::LineBatch::append(float fromX, float fromY, float toX, float toY, int sourceIndex)
+{
+    x0.push_back(fromX);
+    y0.push_back(fromY);
+    x1.push_back(toX);
+    y1.push_back(toY);
+    source.push_back(sourceIndex < 0 ? size() - 1 : sourceIndex);
+}
+
+void Clipper::TriangleBatch::clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    w.clear();
+}
+
+void Clipper::TriangleBatch::append(const QVector4D& a, const QVector4D& b, const QVector4D& c)
+{
+    const QVector4D* vertices[3] = { &a, &b, &c };
+    for(int n = 0; n < 3; n++)
+    {
+        x.push_back(vertices[n]->x());
+        y.push_back(vertices[n]->y());
+        z.push_back(vertices[n]->z());
+        w.push_back(vertices[n]->w());
+    }
+}
+
+void Clipper::ClippedTriangles::clear()
+{
+    positions.clear();
+    weights.clear();
+    source.clear();
+}
+
+Clipper::Clipper()
+{
+}
+
+int Clipper::clipLines(const QRectF& rect, const LineBatch& input, LineBatch& output)
+{
+    output.clear();
+
+    const int count = input.size();
+    if(rect.isEmpty() || count == 0)
+        return 0;
+
+    const float bounds[4] = { static_cast<float>(rect.left()), static_cast<float>(rect.top()),
+                              static_cast<float>(rect.right()), static_cast<float>(rect.bottom()) };
+    float result[16];
+
+    for(int first = 0; first < count; first += 4)
+    {
+        const int lanes = qMin(4, count - first);
+        int mask;
+
+        if(lanes == 4)
+        {
+            mask = clipLines4(&input.x0[first], &input.y0[first], &input.x1[first], &input.y1[first], bounds, result);
+        }
+        else
+        {
+            // Rest mit Nullen auf vier Linien auffüllen
+            float padded[4][4] = {};
+            for(int lane = 0; lane < lanes; lane++)
+            {
+                padded[0][lane] = input.x0[first + lane];
+                padded[1][lane] = input.y0[first + lane];
+                padded[2][lane] = input.x1[first + lane];
+                padded[3][lane] = input.y1[first + lane];
+            }
+
+            mask = clipLines4(padded[0], padded[1], padded[2], padded[3], bounds, result) & ((1 << lanes) - 1);
+        }
+
+        // Sichtbare Linien lückenlos anhängen
+        for(int lane = 0; mask; lane++, mask >>= 1)
+        {
+            if(mask & 1)
+                output.append(result[lane], result[4 + lane], result[8 + lane], result[12 + lane], input.source[first + lane]);
+        }
+    }
+
+    return output.size();
+}
+
+void Clipper::clipPolygon(const QRectF& rect, const QVector<QPointF>& input, QVector<QPointF>& output)
+{
+    output = input;
+    if(rect.isEmpty())
+    {
+        output.clear();
+        return;
+    }
+
+    // Nacheinander an linker, rechter, oberer und unterer Kante abschneiden
+    for(int edge = 0; edge < 4 && !output.isEmpty(); edge++)
+    {
+        const bool vertical = edge < 2;
+        const double limit = edge == 0 ? rect.left() : edge == 1 ? rect.right() : edge == 2 ? rect.top() : rect.bottom();
+        const double sign = edge % 2 == 0 ? 1.0 : -1.0;
+
+        scratch.clear();
+        for(int n = 0; n < output.size(); n++)
+        {
+            const QPointF& current = output[n];
+            const QPointF& next = output[(n + 1) % output.size()];
+
+            const double currentDistance = sign * ((vertical ? current.x() : current.y()) - limit);
+            const double nextDistance = sign * ((vertical ? next.x() : next.y()) - limit);
+
+            if(currentDistance >= 0.0)
+                scratch.append(current);
+
+            if((currentDistance >= 0.0) != (nextDistance >= 0.0))
+            {
+                const double t = currentDistance / (currentDistance - nextDistance);
+                scratch.append(current + (next - current) * t);
+            }
+        }
+
+        output.swap(scratch);
+    }
+
+    if(output.size() < 3)
+        output.clear();
+}
+
+int Clipper::clipTriangles(const TriangleBatch& input, ClippedTriangles& output)
+{
+    output.clear();
+
+    const int count = input.size();
+    for(int first = 0; first < count; first += 4)
+    {
+        const int lanes = qMin(4, count - first);
+
+        // Outcodes: je Ebene die Bitmaske der vier Dreiecke, bei denen ein
+        // bzw. alle Vertices ausserhalb liegen
+        int anyOutside[PlaneCount] = {};
+        int allOutside[PlaneCount] = { 15, 15, 15, 15, 15, 15 };
+        int nonFinite = 0;
+
+        for(int vertex = 0; vertex < 3; vertex++)
+        {
+            int index[4];
+            for(int lane = 0; lane < 4; lane++)
+                index[lane] = 3 * (first + qMin(lane, lanes - 1)) + vertex;
+
+#ifdef GDV_SSE2
+            const __m128 x = _mm_set_ps(input.x[index[3]], input.x[index[2]], input.x[index[1]], input.x[index[0]]);
+            const __m128 y = _mm_set_ps(input.y[index[3]], input.y[index[2]], input.y[index[1]], input.y[index[0]]);
+            const __m128 z = _mm_set_ps(input.z[index[3]], input.z[index[2]], input.z[index[1]], input.z[index[0]]);
+            const __m128 w = _mm_set_ps(input.w[index[3]], input.w[index[2]], input.w[index[1]], input.w[index[0]]);
+            const __m128 zero = _mm_setzero_ps();
+
+            // v - v ist nur für endliche v nicht NaN
+            const __m128 finite = _mm_add_ps(_mm_add_ps(_mm_sub_ps(x, x), _mm_sub_ps(y, y)),
+                                             _mm_add_ps(_mm_sub_ps(z, z), _mm_sub_ps(w, w)));
+            nonFinite |= _mm_movemask_ps(_mm_cmpunord_ps(finite, finite));
+
+            // "nicht >= 0", damit NaN als ausserhalb gilt
+            const int outside[PlaneCount] =
+            {
+                _mm_movemask_ps(_mm_cmpnge_ps(_mm_add_ps(w, x), zero)),
+                _mm_movemask_ps(_mm_cmpnge_ps(_mm_sub_ps(w, x), zero)),
+                _mm_movemask_ps(_mm_cmpnge_ps(_mm_add_ps(w, y), zero)),
+                _mm_movemask_ps(_mm_cmpnge_ps(_mm_sub_ps(w, y), zero)),
+                _mm_movemask_ps(_mm_cmpnge_ps(_mm_add_ps(w, z), zero)),
+                _mm_movemask_ps(_mm_cmpnge_ps(_mm_sub_ps(w, z), zero))
+            };
+#else
+            int outside[PlaneCount] = {};
+            for(int lane = 0; lane < 4; lane++)
+            {
+                const float position[4] = { input.x[index[lane]], input.y[index[lane]], input.z[index[lane]], input.w[index[lane]] };
+                const float finite = (position[0] - position[0]) + (position[1] - position[1])
+                                   + (position[2] - position[2]) + (position[3] - position[3]);
+                if(finite != finite)
+                    nonFinite |= 1 << lane;
+
+                for(int plane = 0; plane < PlaneCount; plane++)
+                {
+                    if(!(planeDistance(position, plane) >= 0.0f))
+                        outside[plane] |= 1 << lane;
+                }
+            }
+#endif
+
+            for(int plane = 0; plane < PlaneCount; plane++)
+            {
+                anyOutside[plane] |= outside[plane];
+                allOutside[plane] &= outside[plane];
+            }
+        }
+
+        // Unendliche oder NaN-Vertices würden beim Schneiden nur NaN erzeugen
+        int rejected = nonFinite, crossing = 0;
+        for(int plane = 0; plane < PlaneCount; plane++)
+        {
+            rejected |= allOutside[plane];
+            crossing |= anyOutside[plane];
+        }
+
+        for(int lane = 0; lane < lanes; lane++)
+        {
+            const int bit = 1 << lane;
+            if(rejected & bit)
+                continue;
+
+            const int triangle = first + lane;
+            if(crossing & bit)
+            {
+                int planes = 0;
+                for(int plane = 0; plane < PlaneCount; plane++)
+                    planes |= (anyOutside[plane] & bit) ? 1 << plane : 0;
+
+                clipTriangle(input, triangle, planes, output);
+                continue;
+            }
+
+            // Vollständig innen: unverändert übernehmen
+            for(int vertex = 0; vertex < 3; vertex++)
+            {
+                const int index = 3 * triangle + vertex;
+                output.positions.push_back(QVector4D(input.x[index], input.y[index], input.z[index], input.w[index]));
+                output.weights.push_back(QVector3D(vertex == 0, vertex == 1, vertex == 2));
+            }
+            output.source.push_back(triangle);
+        }
+    }
+
+    return output.size();
+}
+
+void Clipper::clipTriangle(const TriangleBatch& input, int triangle, int planes, ClippedTriangles& output)
+{
+    polygon.resize(3);
+    for(int vertex = 0; vertex < 3; vertex++)
+    {
+        const int index = 3 * triangle + vertex;
+        ClipVertex& v = polygon[vertex];
+        v.position[0] = input.x[index];
+        v.position[1] = input.y[index];
+        v.position[2] = input.z[index];
+        v.position[3] = input.w[index];
+        v.weight[0] = vertex == 0;
+        v.weight[1] = vertex == 1;
+        v.weight[2] = vertex == 2;
+    }
+
+    // Sutherland-Hodgman, nur an den Ebenen, die ein Vertex verletzt
+    for(int plane = 0; plane < PlaneCount; plane++)
+    {
+        if(!(planes & (1 << plane)))
+            continue;
+
+        clipped.clear();
+        for(size_t n = 0; n < polygon.size(); n++)
+        {
+            const ClipVertex& current = polygon[n];
+            const ClipVertex& next = polygon[(n + 1) % polygon.size()];
+            const float currentDistance = planeDistance(current.position, plane);
+            const float nextDistance = planeDistance(next.position, plane);
+
+            if(currentDistance >= 0.0f)
+                clipped.push_back(current);
+
+            if((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+            {
+                const float t = currentDistance / (currentDistance - nextDistance);
+                ClipVertex v;
+                for(int k = 0; k < 4; k++)
+                    v.position[k] = current.position[k] + (next.position[k] - current.position[k]) * t;
+                for(int k = 0; k < 3; k++)
+                    v.weight[k] = current.weight[k] + (next.weight[k] - current.weight[k]) * t;
+                clipped.push_back(v);
+            }
+        }
+
+        polygon.swap(clipped);
+        if(polygon.size() < 3)
+            return;
+    }
+
+    // Als Fächer in Dreiecke zerlegen
+    for(size_t n = 1; n + 1 < polygon.size(); n++)
+    {
+        const ClipVertex* fan[3] = { &polygon[0], &polygon[n], &polygon[n + 1] };
+        for(int k = 0; k < 3; k++)
+        {
+            output.positions.push_back(QVector4D(fan[k]->position[0], fan[k]->position[1], fan[k]->position[2], fan[k]->position[3]));
+            output.weights.push_back(QVector3D(fan[k]->weight[0], fan[k]->weight[1], fan[k]->weight[2]));
+        }
+        output.source.push_back(triangle);
+    }
+}
@@ -0,0 +1,143 @@
+#ifndef CLIPPER_H
+#define CLIPPER_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+#include <QVector3D>
+#include <QVector4D>
+#include <vector>
+
+/**
+ * @brief Die Clipper Klasse
+ *
+ * Schneidet ganze Listen von Linien und Dreiecken an einem Sichtbereich ab,
+ * bevor sie gezeichnet werden. Vollständig ausserhalb liegende Primitive
+ * werden verworfen, die übrigen gekürzt; das Ergebnis ist eine lückenlose
+ * Liste, die direkt gezeichnet werden kann.
+ *
+ * Beispiel für Linien in Bildschirmkoordinaten:
+ *
+ * Clipper::LineBatch lines, visible;
+ * lines.append(x0, y0, x1, y1);
+ * ...
+ * clipper.clipLines(QRectF(0, 0, width, height), lines, visible);
+ * for(int n = 0; n < visible.size(); n++)
+ *     ... visible.x0[n], visible.y0[n], visible.x1[n], visible.y1[n] ...
+ *
+ * Dreiecke werden im homogenen Clip-Raum (nach der Projektionsmatrix, vor
+ * der Division durch w) an allen sechs Ebenen -w <= x, y, z <= w
+ * abgeschnitten. Dabei entstehende Vielecke werden wieder in Dreiecke
+ * zerlegt. Für jeden neuen Vertex werden die baryzentrischen Gewichte
+ * bezüglich des ursprünglichen Dreiecks geliefert, mit denen sich Normalen,
+ * Farben usw. interpolieren lassen.
+ *
+ * FÜR FORTGESCHRITTENE:
+ * Die Eingaben liegen als "Structure of Arrays" vor (je Koordinate ein
+ * Array), sodass jeweils vier Primitive mit SSE2 gleichzeitig geprüft
+ * werden. Linien werden vollständig vektorisiert nach Liang-Barsky
+ * abgeschnitten. Bei Dreiecken werden zunächst für vier Dreiecke
+ * gleichzeitig die Outcodes (Cohen-Sutherland) bestimmt; nur Dreiecke, die
+ * eine Ebene tatsächlich schneiden, werden einzeln nach Sutherland-Hodgman
+ * zerschnitten.
+ */
+class Clipper
+{
+public:
+    /**
+     * @brief Eine Liste von Liniensegmenten von (x0, y0) nach (x1, y1)
+     *
+     * source enthält nach clipLines den Index der Eingabelinie, aus der die
+     * Linie hervorgegangen ist.
+     */
+    struct LineBatch
+    {
+        std::vector<float> x0, y0, x1, y1;
+        std::vector<int> source;
+
+        int size() const { return static_cast<int>(x0.size()); }
+        void clear();
+        void append(float fromX, float fromY, float toX, float toY, int sourceIndex = -1);
+    };
+
+    /**
+     * @brief Eine Liste von Dreiecken im homogenen Clip-Raum, je drei aufeinanderfolgende Einträge bilden ein Dreieck
+     */
+    struct TriangleBatch
+    {
+        std::vector<float> x, y, z, w;
+
+        int size() const { return static_cast<int>(x.size()) / 3; }
+        void clear();
+        void append(const QVector4D& a, const QVector4D& b, const QVector4D& c);
+    };
+
+    /**
+     * @brief Die abgeschnittenen Dreiecke, je drei aufeinanderfolgende Vertices bilden ein Dreieck
+     *
+     * weights: Baryzentrische Gewichte je Vertex bezüglich der Eckpunkte des Ursprungsdreiecks
+     * source: Index des Ursprungsdreiecks je Dreieck
+     */
+    struct ClippedTriangles
+    {
+        std::vector<QVector4D> positions;
+        std::vector<QVector3D> weights;
+        std::vector<int> source;
+
+        int size() const { return static_cast<int>(source.size()); }
+        void clear();
+    };
+
+    Clipper();
+
+    /**
+     * @brief clipLines Schneidet Linien am Rechteck rect ab
+     * @param rect Der sichtbare Bereich, z.B. QRectF(0, 0, width, height)
+     * @param input Die Linien
+     * @param output Wird geleert und mit den sichtbaren Teilen gefüllt
+     * @return Die Anzahl sichtbarer Linien
+     */
+    int clipLines(const QRectF& rect, const LineBatch& input, LineBatch& output);
+
+    /**
+     * @brief clipPolygon Schneidet ein (konvexes oder konkaves) Polygon am Rechteck rect ab (Sutherland-Hodgman)
+     * @param rect Der sichtbare Bereich
+     * @param input Die Eckpunkte des Polygons
+     * @param output Die Eckpunkte des abgeschnittenen Polygons, leer falls es ausserhalb liegt
+     *
+     * Bei konkaven Polygonen können entlang des Rands Kanten entstehen, die
+     * zwei sichtbare Teile verbinden; gefüllt ergibt sich dennoch die
+     * korrekte Fläche.
+     */
+    void clipPolygon(const QRectF& rect, const QVector<QPointF>& input, QVector<QPointF>& output);
+
+    /**
+     * @brief clipTriangles Schneidet Dreiecke im homogenen Clip-Raum am Sichtvolumen ab
+     * @param input Die Dreiecke
+     * @param output Wird geleert und mit den sichtbaren Dreiecken gefüllt
+     * @return Die Anzahl sichtbarer Dreiecke
+     */
+    int clipTriangles(const TriangleBatch& input, ClippedTriangles& output);
+
+private:
+    // Vertex während Sutherland-Hodgman: Position und baryzentrische Gewichte
+    struct ClipVertex
+    {
+        float position[4];
+        float weight[3];
+    };
+
+    void clipTriangle(const TriangleBatch& input, int triangle, int planes, ClippedTriangles& output);
+
+    std::vector<ClipVertex> polygon, clipped;
+    QVector<QPointF> scratch;
+};
+
+#endif // CLIPPER_H
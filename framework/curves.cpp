@@ -0,0 +1,220 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "curves.h"
+
+#include <QDebug>
+
+namespace
+{
+    // Obergrenze für die Unterteilung, d.h. höchstens 2^16 Linien je Segment
+    const int MaxDepth = 16;
+}
+
+Curves::Curves() :
+    flatness(0.25f)
+{
+}
+
+void Curves::setTolerance(float pixels)
+{
+    flatness = qMax(pixels, 0.01f);
+}
+
+float Curves::tolerance() const
+{
+    return flatness;
+}
+
+void Curves::drawBezier(GdvCanvas& canvas, const QVector<QPointF>& controlPoints, const QVector3D& color, bool antialiased)
+{
+    polyline.clear();
+    flattenBezier(controlPoints, polyline);
+    draw(canvas, color, antialiased);
+}
+
+void Curves::drawBSpline(GdvCanvas& canvas, const QVector<QPointF>& controlPoints, int degree, const QVector3D& color,
+                         bool antialiased, const QVector<float>& knots)
+{
+    polyline.clear();
+    flattenBSpline(controlPoints, degree, polyline, knots);
+    draw(canvas, color, antialiased);
+}
+
+void Curves::draw(GdvCanvas& canvas, const QVector3D& color, bool antialiased)
+{
+    lines.clear();
+    for(int n = 1; n < polyline.size(); n++)
+        lines.append(Primitives::Line(polyline[n - 1], polyline[n], color));
+
+    primitives.drawLines(canvas, lines, antialiased);
+}
+
+void Curves::flattenBezier(const QVector<QPointF>& controlPoints, QVector<QPointF>& polyline)
+{
+    if(controlPoints.isEmpty())
+        return;
+
+    polyline.append(controlPoints.first());
+    if(controlPoints.size() > 1)
+        subdivide(controlPoints.constData(), controlPoints.size(), polyline);
+}
+
+void Curves::flattenBSpline(const QVector<QPointF>& controlPoints, int degree, QVector<QPointF>& polyline,
+                            const QVector<float>& knots)
+{
+    const int count = controlPoints.size();
+    if(degree < 1 || count <= degree)
+        return;
+
+    const float* t = knots.constData();
+    if(knots.isEmpty())
+    {
+        // Gleichmäßig verteilt, an den Enden degree + 1-fach
+        uniformKnots.resize(count + degree + 1);
+        for(int n = 0; n < count + degree + 1; n++)
+            uniformKnots[n] = qBound(0, n - degree, count - degree);
+        t = uniformKnots.data();
+    }
+    else if(knots.size() != count + degree + 1)
+    {
+        qWarning() << "Curves::drawBSpline: expected" << count + degree + 1 << "knots, got" << knots.size();
+        return;
+    }
+
+    // Jedes nicht leere Knotenintervall [t_i, t_i+1) als Bézier-Segment:
+    // Kontrollpunkt k ist der Blossom mit degree - k mal t_i und k mal t_i+1
+    segment.resize(degree + 1);
+    arguments.resize(degree);
+    bool first = true;
+
+    for(int span = degree; span < count; span++)
+    {
+        if(!(t[span] < t[span + 1]))
+            continue;
+
+        for(int k = 0; k <= degree; k++)
+        {
+            for(int a = 0; a < degree; a++)
+                arguments[a] = a < degree - k ? t[span] : t[span + 1];
+            segment[k] = blossom(controlPoints.constData(), t, span, degree, arguments.data());
+        }
+
+        if(first)
+        {
+            polyline.append(segment[0]);
+            first = false;
+        }
+
+        subdivide(segment.data(), degree + 1, polyline);
+    }
+}
+
+QPointF Curves::blossom(const QPointF* controlPoints, const float* knots, int span, int degree, const float* arguments)
+{
+    // de Boor mit einem eigenen Parameter je Stufe
+    deBoor.assign(controlPoints + span - degree, controlPoints + span + 1);
+
+    for(int r = 1; r <= degree; r++)
+    {
+        for(int m = degree; m >= r; m--)
+        {
+            const int j = span - degree + m;
+            const float alpha = (arguments[r - 1] - knots[j]) / (knots[j + degree - r + 1] - knots[j]);
+            deBoor[m] = deBoor[m - 1] * (1.0f - alpha) + deBoor[m] * alpha;
+        }
+    }
+
+    return deBoor[degree];
+}
+
+void Curves::subdivide(const QPointF* controlPoints, int count, QVector<QPointF>& polyline)
+{
+    stack.assign(controlPoints, controlPoints + count);
+    depths.assign(1, 0);
+
+    split.resize(count);
+    left.resize(count);
+    right.resize(count);
+
+    while(!depths.empty())
+    {
+        const int depth = depths.back();
+        depths.pop_back();
+
+        const size_t base = stack.size() - count;
+        if(depth >= MaxDepth || isFlat(&stack[base], count))
+        {
+            polyline.append(stack[base + count - 1]);
+            stack.resize(base);
+            continue;
+        }
+
+        // de Casteljau bei t = 0.5: die Ränder des Schemas sind die
+        // Kontrollpunkte der linken bzw. rechten Hälfte
+        split.assign(stack.begin() + base, stack.end());
+        left[0] = split[0];
+        right[count - 1] = split[count - 1];
+
+        for(int r = 1; r < count; r++)
+        {
+            for(int j = 0; j < count - r; j++)
+                split[j] = (split[j] + split[j + 1]) * 0.5;
+
+            left[r] = split[0];
+            right[count - 1 - r] = split[count - 1 - r];
+        }
+
+        // Rechte Hälfte zuerst ablegen, damit die linke zuerst ausgegeben wird
+        stack.resize(base);
+        stack.insert(stack.end(), right.begin(), right.end());
+        stack.insert(stack.end(), left.begin(), left.end());
+        depths.push_back(depth + 1);
+        depths.push_back(depth + 1);
+    }
+}
+
+bool Curves::isFlat(const QPointF* controlPoints, int count) const
+{
+    // Alle inneren Kontrollpunkte höchstens flatness von der Sehne entfernt?
+    // Da die Kurve in der konvexen Hülle liegt, gilt dies dann auch für sie.
+    const QPointF start = controlPoints[0];
+    const QPointF end = controlPoints[count - 1];
+    const QPointF chord = end - start;
+    const double length = chord.x() * chord.x() + chord.y() * chord.y();
+    const double limit = static_cast<double>(flatness) * flatness;
+
+    for(int n = 1; n < count - 1; n++)
+    {
+        const QPointF offset = controlPoints[n] - start;
+        const double along = offset.x() * chord.x() + offset.y() * chord.y();
+        double distance;
+
+        if(along <= 0.0)
+        {
+            distance = offset.x() * offset.x() + offset.y() * offset.y();
+        }
+        else if(along >= length)
+        {
+            const QPointF beyond = controlPoints[n] - end;
+            distance = beyond.x() * beyond.x() + beyond.y() * beyond.y();
+        }
+        else
+        {
+            const double cross = offset.x() * chord.y() - offset.y() * chord.x();
+            distance = cross * cross / length;
+        }
+
+        // NaN gilt als gerade, sonst würde bis zur maximalen Tiefe unterteilt
+        if(distance > limit)
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,108 @@
+#ifndef CURVES_H
+#define CURVES_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include "interfaces/GdvCanvas.h"
+#include "primitives.h"
+
+#include <QPointF>
+#include <QVector>
+#include <vector>
+
+/**
+ * @brief Die Curves Klasse
+ *
+ * Zeichnet Bézier- und B-Spline-Kurven beliebigen Grades. Anstatt die Kurve
+ * in festen, sehr kleinen Parameterschritten auszuwerten, wird sie so oft
+ * halbiert (de Casteljau), bis jedes Teilstück bis auf tolerance() Pixel
+ * gerade ist. Gerade Abschnitte bestehen so aus wenigen langen Linien,
+ * enge Kurven aus vielen kurzen.
+ *
+ * Beispiel zur Verwendung in render:
+ *
+ * QVector<QPointF> controlPoints = ...; // in Pixelkoordinaten
+ * curves.drawBezier(canvas, controlPoints, QVector3D(1, 1, 1));
+ * curves.drawBSpline(canvas, controlPoints, 3, QVector3D(1, 0, 0), true);
+ *
+ * Wird die Kurve selbst benötigt (z.B. für eigene Zeichenroutinen), liefern
+ * flattenBezier und flattenBSpline die Punkte des Linienzugs.
+ *
+ * FÜR FORTGESCHRITTENE:
+ * B-Splines werden zunächst je Knotenintervall in Bézier-Segmente
+ * umgerechnet (Blossoming) und dann wie Bézier-Kurven unterteilt. Die
+ * Unterteilung verwendet einen eigenen Stapel statt Rekursion; alle
+ * Zwischenspeicher bleiben zwischen den Aufrufen erhalten (siehe Primitives).
+ */
+class Curves
+{
+public:
+    Curves();
+
+    /**
+     * @brief setTolerance Legt die maximale Abweichung des Linienzugs von der Kurve fest
+     * @param pixels Die erlaubte Abweichung in Pixeln (Standard: 0.25)
+     */
+    void setTolerance(float pixels);
+    float tolerance() const;
+
+    /**
+     * @brief drawBezier Zeichnet eine Bézier-Kurve
+     * @param canvas Die Zeichenfläche
+     * @param controlPoints Die Kontrollpunkte, der Grad der Kurve ist deren Anzahl - 1
+     * @param color Die Farbe der Kurve
+     * @param antialiased true: Kantenglättung (siehe Primitives::drawLines)
+     */
+    void drawBezier(GdvCanvas& canvas, const QVector<QPointF>& controlPoints, const QVector3D& color, bool antialiased = false);
+
+    /**
+     * @brief drawBSpline Zeichnet eine B-Spline-Kurve
+     * @param canvas Die Zeichenfläche
+     * @param controlPoints Die Kontrollpunkte, mindestens degree + 1
+     * @param degree Der Grad der Kurve (z.B. 3 für kubische B-Splines)
+     * @param color Die Farbe der Kurve
+     * @param antialiased true: Kantenglättung (siehe Primitives::drawLines)
+     * @param knots Der Knotenvektor mit controlPoints.size() + degree + 1 aufsteigenden Werten.
+     *              Ohne Angabe werden die Knoten gleichmäßig verteilt und an den Enden
+     *              degree + 1-fach wiederholt, sodass die Kurve im ersten und letzten Kontrollpunkt beginnt bzw. endet.
+     */
+    void drawBSpline(GdvCanvas& canvas, const QVector<QPointF>& controlPoints, int degree, const QVector3D& color,
+                     bool antialiased = false, const QVector<float>& knots = QVector<float>());
+
+    /**
+     * @brief flattenBezier Hängt den Linienzug einer Bézier-Kurve an polyline an
+     */
+    void flattenBezier(const QVector<QPointF>& controlPoints, QVector<QPointF>& polyline);
+
+    /**
+     * @brief flattenBSpline Hängt den Linienzug einer B-Spline-Kurve an polyline an (Parameter wie drawBSpline)
+     */
+    void flattenBSpline(const QVector<QPointF>& controlPoints, int degree, QVector<QPointF>& polyline,
+                        const QVector<float>& knots = QVector<float>());
+
+private:
+    void subdivide(const QPointF* controlPoints, int count, QVector<QPointF>& polyline);
+    bool isFlat(const QPointF* controlPoints, int count) const;
+    QPointF blossom(const QPointF* controlPoints, const float* knots, int span, int degree, const float* arguments);
+    void draw(GdvCanvas& canvas, const QVector3D& color, bool antialiased);
+
+    float flatness;
+
+    std::vector<QPointF> stack;     // Kontrollpunkte der noch zu prüfenden Teilstücke
+    std::vector<int> depths;        // Unterteilungstiefe je Teilstück
+    std::vector<QPointF> split, left, right, segment;
+    std::vector<float> uniformKnots;
+    std::vector<QPointF> deBoor;
+    std::vector<float> arguments;
+
+    QVector<QPointF> polyline;
+    QVector<Primitives::Line> lines;
+    Primitives primitives;
+};
+
+#endif // CURVES_H
@@ -0,0 +1,198 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "depthbuffer.h"
+#include "simd.h"
+
+#include <QtGlobal>
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    const float Far = std::numeric_limits<float>::infinity();
+}
+
+DepthBuffer::DepthBuffer() :
+    w(0), h(0), stride(0), tilesX(0), tilesY(0)
+{
+}
+
+void DepthBuffer::resize(unsigned int width, unsigned int height)
+{
+    w = width;
+    h = height;
+
+    // Zeilen auf vier Pixel auffüllen, damit testAndWrite4 nie in die
+    // nächste Zeile (und damit evtl. in die Kachel eines anderen Threads) greift
+    stride = (w + 3) & ~3u;
+    tilesX = (w + TileSize - 1) / TileSize;
+    tilesY = (h + TileSize - 1) / TileSize;
+
+    values.assign(static_cast<size_t>(stride) * h, Far);
+    tileMin.assign(tilesX * tilesY, Far);
+    tileMax.assign(tilesX * tilesY, Far);
+    tileStale.assign(tilesX * tilesY, 0);
+}
+
+void DepthBuffer::clear()
+{
+    clear(QRect(0, 0, w, h));
+}
+
+void DepthBuffer::clear(const QRect& area)
+{
+    const QRect bounds(0, 0, w, h);
+    const QRect clipped = area.intersected(bounds);
+    if(clipped.isEmpty())
+        return;
+
+    for(int ty = clipped.top() / TileSize; ty <= clipped.bottom() / TileSize; ty++)
+    {
+        for(int tx = clipped.left() / TileSize; tx <= clipped.right() / TileSize; tx++)
+        {
+            const unsigned int tile = ty * tilesX + tx;
+
+            // In diese Kachel wurde seit dem letzten clear nichts geschrieben
+            if(tileMin[tile] == Far)
+                continue;
+
+            const QRect tileRect = QRect(tx * TileSize, ty * TileSize, TileSize, TileSize).intersected(bounds);
+            const QRect cleared = tileRect.intersected(clipped);
+
+            for(int y = cleared.top(); y <= cleared.bottom(); y++)
+            {
+                float* row = values.data() + static_cast<size_t>(y) * stride;
+                std::fill(row + cleared.left(), row + cleared.right() + 1, Far);
+            }
+
+            if(cleared == tileRect)
+            {
+                tileMin[tile] = Far;
+                tileStale[tile] = 0;
+            }
+
+            tileMax[tile] = Far;
+        }
+    }
+}
+
+float DepthBuffer::depth(unsigned int x, unsigned int y) const
+{
+    if(x >= w || y >= h)
+        return Far;
+
+    return values[static_cast<size_t>(y) * stride + x];
+}
+
+bool DepthBuffer::testAndWrite(unsigned int x, unsigned int y, float z)
+{
+    if(x >= w || y >= h)
+        return false;
+
+    float& stored = values[static_cast<size_t>(y) * stride + x];
+    if(!(z < stored))
+        return false;
+
+    stored = z;
+
+    const unsigned int tile = (y / TileSize) * tilesX + x / TileSize;
+    tileMin[tile] = qMin(tileMin[tile], z);
+    tileStale[tile] = 1;
+    return true;
+}
+
+int DepthBuffer::testAndWrite4(unsigned int x, unsigned int y, const float* z, int mask)
+{
+    Q_ASSERT(x % 4 == 0);
+
+    if(x >= w || y >= h)
+        return 0;
+
+    if(x + 4 > w)
+        mask &= (1 << (w - x)) - 1;
+
+    float* stored = values.data() + static_cast<size_t>(y) * stride + x;
+
+#ifdef GDV_SSE2
+    const __m128 current = _mm_loadu_ps(stored);
+    const __m128 incoming = _mm_loadu_ps(z);
+    mask &= _mm_movemask_ps(_mm_cmplt_ps(incoming, current));
+
+    if(!mask)
+        return 0;
+
+    const __m128 select = _mm_castsi128_ps(_mm_set_epi32(-((mask >> 3) & 1), -((mask >> 2) & 1),
+                                                         -((mask >> 1) & 1), -(mask & 1)));
+    _mm_storeu_ps(stored, _mm_or_ps(_mm_and_ps(select, incoming), _mm_andnot_ps(select, current)));
+#else
+    for(int lane = 0; lane < 4; lane++)
+    {
+        if((mask & (1 << lane)) && z[lane] < stored[lane])
+            stored[lane] = z[lane];
+        else
+            mask &= ~(1 << lane);
+    }
+
+    if(!mask)
+        return 0;
+#endif
+
+    const unsigned int tile = (y / TileSize) * tilesX + x / TileSize;
+    for(int lane = 0; lane < 4; lane++)
+    {
+        if(mask & (1 << lane))
+            tileMin[tile] = qMin(tileMin[tile], z[lane]);
+    }
+
+    tileStale[tile] = 1;
+    return mask;
+}
+
+bool DepthBuffer::isOccluded(const QRect& area, float nearestZ)
+{
+    const QRect clipped = area.intersected(QRect(0, 0, w, h));
+    if(clipped.isEmpty())
+        return true;
+
+    for(int ty = clipped.top() / TileSize; ty <= clipped.bottom() / TileSize; ty++)
+    {
+        for(int tx = clipped.left() / TileSize; tx <= clipped.right() / TileSize; tx++)
+        {
+            const unsigned int tile = ty * tilesX + tx;
+
+            if(tileStale[tile])
+                updateTileMax(tile);
+
+            if(nearestZ < tileMax[tile])
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void DepthBuffer::updateTileMax(unsigned int tile)
+{
+    const unsigned int left = (tile % tilesX) * TileSize;
+    const unsigned int top = (tile / tilesX) * TileSize;
+    const unsigned int right = qMin(left + TileSize, w);
+    const unsigned int bottom = qMin(top + TileSize, h);
+
+    float result = -Far;
+    for(unsigned int y = top; y < bottom; y++)
+    {
+        const float* row = values.data() + static_cast<size_t>(y) * stride;
+        for(unsigned int x = left; x < right; x++)
+            result = qMax(result, row[x]);
+    }
+
+    tileMax[tile] = result;
+    tileStale[tile] = 0;
+}
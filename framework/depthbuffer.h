@@ -0,0 +1,100 @@
+#ifndef DEPTHBUFFER_H
+#define DEPTHBUFFER_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QRect>
+#include "pooledbuffer.h"
+
+/**
+ * @brief Die DepthBuffer Klasse
+ *
+ * Ein Tiefenpuffer (z-Buffer) in der Größe der Zeichenfläche. Kleinere
+ * z-Werte liegen vorne; nach clear sind alle Pixel unendlich weit entfernt.
+ * Fordert eine Abgabe mit RendererBase::usesDepthBuffer() einen Tiefenpuffer
+ * an, liefert GdvCanvas::depthBuffer() diesen. Er wird dann mit jedem
+ * clearBuffer ebenfalls gelöscht.
+ *
+ * Beispiel zur Verwendung:
+ *
+ * DepthBuffer* depth = canvas.depthBuffer();
+ * if(depth->testAndWrite(x, y, z))
+ *     canvas.setPixel(x, y, color);
+ *
+ * FÜR FORTGESCHRITTENE:
+ * Für jeweils 8x8 Pixel wird zusätzlich der größte z-Wert mitgeführt. Mit
+ * isOccluded lassen sich so ganze Dreiecke oder Bereiche verwerfen, ohne
+ * einzelne Pixel zu prüfen. testAndWrite4 prüft vier Pixel gleichzeitig.
+ *
+ * Wichtig: Im Kachelmodus bzw. mit dem Rasterizer darf jeder Thread nur
+ * innerhalb seiner eigenen (an 64 Pixeln ausgerichteten) Kachel zugreifen.
+ */
+class DepthBuffer
+{
+public:
+    enum { TileSize = 8 };
+
+    DepthBuffer();
+
+    void resize(unsigned int width, unsigned int height);
+    unsigned int width() const { return w; }
+    unsigned int height() const { return h; }
+
+    void clear();
+    void clear(const QRect& area);
+
+    float depth(unsigned int x, unsigned int y) const;
+
+    /**
+     * @brief testAndWrite Prüft, ob z vor dem gespeicherten Wert liegt, und übernimmt ihn ggf.
+     * @return true, falls der Pixel sichtbar ist und gezeichnet werden sollte
+     */
+    bool testAndWrite(unsigned int x, unsigned int y, float z);
+
+    /**
+     * @brief testAndWrite4 Wie testAndWrite für die vier Pixel x bis x+3 einer Zeile
+     * @param x Die x-Koordinate des ersten Pixels, muss durch 4 teilbar sein
+     * @param z Vier z-Werte
+     * @param mask Bit n gesetzt: Pixel x+n soll geprüft werden
+     * @return Bit n gesetzt: Pixel x+n ist sichtbar, sein z-Wert wurde übernommen
+     */
+    int testAndWrite4(unsigned int x, unsigned int y, const float* z, int mask);
+
+    /**
+     * @brief isOccluded Prüft, ob ein Bereich vollständig verdeckt ist
+     * @param area Der zu prüfende Bereich in Pixeln
+     * @param nearestZ Der kleinste z-Wert, der im Bereich gezeichnet werden soll
+     * @return true, falls jeder Pixel im Bereich bereits vor nearestZ liegt
+     */
+    bool isOccluded(const QRect& area, float nearestZ);
+
+    /**
+     * @brief maxDepthAt Obere Schranke für alle z-Werte der 8x8 Pixel um (x, y)
+     *
+     * Kann nach Schreibzugriffen größer sein als nötig, solange isOccluded
+     * die Kachel noch nicht neu vermessen hat.
+     */
+    float maxDepthAt(unsigned int x, unsigned int y) const
+    {
+        return tileMax[(y / TileSize) * tilesX + x / TileSize];
+    }
+
+private:
+    void updateTileMax(unsigned int tile);
+
+    unsigned int w, h, stride;
+    unsigned int tilesX, tilesY;
+
+    PooledBuffer<float> values;
+
+    // Je 8x8 Pixel: kleinster/größter z-Wert und ob der größte neu zu bestimmen ist
+    PooledBuffer<float> tileMin, tileMax;
+    PooledBuffer<unsigned char> tileStale;
+};
+
+#endif // DEPTHBUFFER_H
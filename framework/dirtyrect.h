@@ -0,0 +1,77 @@
+#ifndef DIRTYRECT_H
+#define DIRTYRECT_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QRect>
+#include <climits>
+
+/**
+ * @brief Die DirtyRect Struktur
+ *
+ * Das umschließende Rechteck aller seit dem letzten clear veränderten Pixel.
+ * Im Gegensatz zu QRect::united reichen für einzelne Pixel vier Vergleiche,
+ * sodass auch setPixel die Fläche mitführen kann.
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+struct DirtyRect
+{
+    unsigned int left, top, right, bottom; // right/bottom exklusiv
+
+    DirtyRect() { clear(); }
+
+    void clear()
+    {
+        left = top = UINT_MAX;
+        right = bottom = 0;
+    }
+
+    bool isEmpty() const { return left >= right || top >= bottom; }
+
+    void add(unsigned int x, unsigned int y)
+    {
+        if(x < left) left = x;
+        if(x >= right) right = x + 1;
+        if(y < top) top = y;
+        if(y >= bottom) bottom = y + 1;
+    }
+
+    void add(unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+    {
+        if(width == 0 || height == 0)
+            return;
+
+        if(x < left) left = x;
+        if(x + width > right) right = x + width;
+        if(y < top) top = y;
+        if(y + height > bottom) bottom = y + height;
+    }
+
+    void add(const DirtyRect& other)
+    {
+        if(!other.isEmpty())
+            add(other.left, other.top, other.right - other.left, other.bottom - other.top);
+    }
+
+    void add(const QRect& rect)
+    {
+        if(!rect.isEmpty())
+            add(rect.x(), rect.y(), rect.width(), rect.height());
+    }
+
+    QRect toRect() const
+    {
+        if(isEmpty())
+            return QRect();
+
+        return QRect(left, top, right - left, bottom - top);
+    }
+};
+
+#endif // DIRTYRECT_H
@@ -0,0 +1,321 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "framecapture.h"
+
+#include <QMutexLocker>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+#include <cstring>
+
+FrameCapture::FrameCapture() :
+    format(FormatPPM), framesPerSecond(30),
+    first(0), queued(0),
+    capturing(false), stopRequested(false),
+    submitted(0), captured(0), dropped(0),
+    headerWritten(false)
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+    stop();
+}
+
+bool FrameCapture::start(const QString& fileName, int framesPerSecond, int ringSize)
+{
+    stop();
+
+    const QString suffix = QFileInfo(fileName).suffix().toLower();
+    if(suffix == "ppm")
+        format = FormatPPM;
+    else if(suffix == "png")
+        format = FormatPNG;
+    else if(suffix == "y4m")
+        format = FormatY4M;
+    else
+    {
+        error = QString("Unknown capture format '%1', use .ppm, .png or .y4m.").arg(suffix);
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    if(format == FormatY4M)
+    {
+        stream.setFileName(fileName);
+        if(!stream.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            error = QString("Could not create '%1'.").arg(fileName);
+            return false;
+        }
+    }
+
+    this->fileName = fileName;
+    this->framesPerSecond = qMax(framesPerSecond, 1);
+
+    // Die Puffer selbst werden mit dem ersten Bild angelegt, erst dann ist die Größe bekannt
+    ring = QVector<Slot>(qMax(ringSize, 1));
+    first = queued = 0;
+    submitted = captured = dropped = 0;
+    streamSize = QSize();
+    headerWritten = false;
+    error.clear();
+
+    capturing = true;
+    stopRequested = false;
+    QThread::start();
+
+    qDebug() << "Capturing frames to" << fileName;
+    return true;
+}
+
+void FrameCapture::stop()
+{
+    {
+        QMutexLocker lock(&mutex);
+        capturing = false;
+        stopRequested = true;
+        frameQueued.wakeAll();
+    }
+
+    wait();
+
+    if(stream.isOpen())
+        stream.close();
+}
+
+bool FrameCapture::isCapturing()
+{
+    QMutexLocker lock(&mutex);
+    return capturing;
+}
+
+void FrameCapture::submit(const QImage& frame)
+{
+    QMutexLocker lock(&mutex);
+
+    if(!capturing || frame.isNull())
+        return;
+
+    const int frameNumber = submitted++;
+
+    if(queued == ring.size())
+    {
+        dropped++;
+        return;
+    }
+
+    // Eine Videodatei hat eine feste Größe, die des ersten Bildes
+    if(format == FormatY4M)
+    {
+        if(streamSize.isEmpty())
+            streamSize = frame.size();
+        else if(frame.size() != streamSize)
+        {
+            dropped++;
+            return;
+        }
+    }
+
+    const QImage source = frame.depth() == 32 ? frame : frame.convertToFormat(QImage::Format_RGB32);
+
+    // Nach einer Größenänderung alle freien Plätze neu anlegen, damit
+    // nicht bei jedem der folgenden Bilder Speicher angefordert wird
+    const int next = (first + queued) % ring.size();
+    if(ring[next].image.size() != source.size())
+    {
+        for(int n = queued; n < ring.size(); n++)
+            ring[(first + n) % ring.size()].image = QImage(source.size(), QImage::Format_RGB32);
+    }
+
+    // Das Kopieren hält nur den Schreib-Thread kurz auf, nie umgekehrt:
+    // dieser hält den Mutex nicht, während er schreibt
+    Slot& slot = ring[next];
+    const size_t bytes = source.width() * sizeof(QRgb);
+    for(int row = 0; row < source.height(); row++)
+        memcpy(slot.image.scanLine(row), source.constScanLine(row), bytes);
+
+    slot.frameNumber = frameNumber;
+    queued++;
+    frameQueued.wakeOne();
+}
+
+int FrameCapture::capturedFrames()
+{
+    QMutexLocker lock(&mutex);
+    return captured;
+}
+
+int FrameCapture::droppedFrames()
+{
+    QMutexLocker lock(&mutex);
+    return dropped;
+}
+
+QString FrameCapture::errorString()
+{
+    QMutexLocker lock(&mutex);
+    return error;
+}
+
+void FrameCapture::run()
+{
+    forever
+    {
+        mutex.lock();
+        while(queued == 0 && !stopRequested)
+            frameQueued.wait(&mutex);
+
+        // Beim Beenden werden erst alle wartenden Bilder geschrieben
+        if(queued == 0)
+        {
+            mutex.unlock();
+            break;
+        }
+
+        const Slot& slot = ring[first];
+        const bool failed = !error.isEmpty();
+        mutex.unlock();
+
+        // Nach einem Fehler werden die restlichen Bilder nur noch verworfen
+        const bool written = !failed && writeFrame(slot);
+
+        mutex.lock();
+        if(written)
+            captured++;
+        else
+        {
+            dropped++;
+            if(!failed)
+            {
+                error = QString("Could not write frame %1 to '%2'.").arg(slot.frameNumber).arg(fileName);
+                qWarning() << error;
+                capturing = false;
+            }
+        }
+
+        first = (first + 1) % ring.size();
+        queued--;
+        mutex.unlock();
+    }
+}
+
+bool FrameCapture::writeFrame(const Slot& slot)
+{
+    switch(format)
+    {
+    case FormatPPM:
+        return writePPM(slot.image, sequenceFileName(slot.frameNumber));
+    case FormatPNG:
+        return slot.image.save(sequenceFileName(slot.frameNumber), "PNG");
+    case FormatY4M:
+        return writeY4M(slot.image);
+    }
+
+    return false;
+}
+
+bool FrameCapture::writePPM(const QImage& image, const QString& fileName)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    const QByteArray header = QString("P6\n%1 %2\n255\n").arg(image.width()).arg(image.height()).toLatin1();
+    if(file.write(header) != header.size())
+        return false;
+
+    const int width = image.width();
+    planes.resize(width * 3);
+
+    for(int row = 0; row < image.height(); row++)
+    {
+        const QRgb* source = reinterpret_cast<const QRgb*>(image.constScanLine(row));
+        uchar* target = planes.data();
+        for(int x = 0; x < width; x++)
+        {
+            *target++ = qRed(source[x]);
+            *target++ = qGreen(source[x]);
+            *target++ = qBlue(source[x]);
+        }
+
+        if(file.write(reinterpret_cast<const char*>(planes.constData()), width * 3) != width * 3)
+            return false;
+    }
+
+    return true;
+}
+
+bool FrameCapture::writeY4M(const QImage& image)
+{
+    const int width = image.width();
+    const int height = image.height();
+
+    if(!headerWritten)
+    {
+        const QByteArray header = QString("YUV4MPEG2 W%1 H%2 F%3:1 Ip A1:1 C420jpeg\n")
+                .arg(width).arg(height).arg(framesPerSecond).toLatin1();
+        if(stream.write(header) != header.size())
+            return false;
+        headerWritten = true;
+    }
+
+    // BT.601 mit eingeschränktem Wertebereich, Farbanteile je 2x2 Pixel gemittelt
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+    const int lumaSize = width * height;
+    const int chromaSize = chromaWidth * chromaHeight;
+    planes.resize(lumaSize + 2 * chromaSize);
+
+    uchar* luma = planes.data();
+    uchar* cb = luma + lumaSize;
+    uchar* cr = cb + chromaSize;
+
+    for(int row = 0; row < height; row++)
+    {
+        const QRgb* source = reinterpret_cast<const QRgb*>(image.constScanLine(row));
+        uchar* target = luma + row * width;
+        for(int x = 0; x < width; x++)
+        {
+            const int r = qRed(source[x]), g = qGreen(source[x]), b = qBlue(source[x]);
+            target[x] = static_cast<uchar>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+    }
+
+    for(int row = 0; row < chromaHeight; row++)
+    {
+        const QRgb* top = reinterpret_cast<const QRgb*>(image.constScanLine(2 * row));
+        const QRgb* bottom = reinterpret_cast<const QRgb*>(image.constScanLine(qMin(2 * row + 1, height - 1)));
+        for(int x = 0; x < chromaWidth; x++)
+        {
+            const int left = 2 * x;
+            const int right = qMin(2 * x + 1, width - 1);
+            const int r = (qRed(top[left]) + qRed(top[right]) + qRed(bottom[left]) + qRed(bottom[right]) + 2) >> 2;
+            const int g = (qGreen(top[left]) + qGreen(top[right]) + qGreen(bottom[left]) + qGreen(bottom[right]) + 2) >> 2;
+            const int b = (qBlue(top[left]) + qBlue(top[right]) + qBlue(bottom[left]) + qBlue(bottom[right]) + 2) >> 2;
+
+            // Der Versatz von 128 << 8 hält die Summen positiv
+            cb[row * chromaWidth + x] = static_cast<uchar>((-38 * r - 74 * g + 112 * b + 128 + (128 << 8)) >> 8);
+            cr[row * chromaWidth + x] = static_cast<uchar>((112 * r - 94 * g - 18 * b + 128 + (128 << 8)) >> 8);
+        }
+    }
+
+    const qint64 frameBytes = planes.size();
+    return stream.write("FRAME\n", 6) == 6 &&
+           stream.write(reinterpret_cast<const char*>(planes.constData()), frameBytes) == frameBytes;
+}
+
+QString FrameCapture::sequenceFileName(int frameNumber) const
+{
+    const QFileInfo info(fileName);
+    return info.path() + "/" + info.completeBaseName() +
+           QString("_%1.").arg(frameNumber, 6, 10, QChar('0')) + info.suffix();
+}
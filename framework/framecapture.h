@@ -0,0 +1,114 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QImage>
+#include <QFile>
+#include <QVector>
+
+/**
+ * @brief Die FrameCapture Klasse
+ *
+ * Zeichnet die mit flipBuffer fertiggestellten Bilder auf, ohne den
+ * Render-Thread auf die Festplatte warten zu lassen: submit kopiert das Bild
+ * nur in einen freien Platz eines Rings aus vorab angelegten Puffern, ein
+ * eigener Thread schreibt die Bilder von dort als Bildfolge (PPM, PNG) oder
+ * als unkomprimiertes Video (Y4M, 4:2:0). Ist der Ring voll, weil das
+ * Schreiben nicht hinterherkommt, wird das Bild verworfen und gezählt.
+ *
+ * Die Endung des bei start übergebenen Dateinamens legt das Format fest:
+ * "aufnahme.y4m" ergibt eine Videodatei, "bilder/frame.png" die Dateien
+ * "bilder/frame_000000.png", "bilder/frame_000001.png" usw. Die Nummer ist
+ * die des Bildes seit dem Start, verworfene Bilder hinterlassen also Lücken.
+ *
+ * submit darf jeweils nur aus einem Thread aufgerufen werden, alle übrigen
+ * Methoden aus einem beliebigen (anderen) Thread.
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class FrameCapture : public QThread
+{
+    Q_OBJECT
+public:
+    enum Format
+    {
+        FormatPPM,
+        FormatPNG,
+        FormatY4M
+    };
+
+    FrameCapture();
+    ~FrameCapture();
+
+    /**
+     * @brief start Beginnt eine neue Aufnahme, eine laufende wird vorher beendet
+     * @param fileName Ziel, die Endung (.ppm, .png oder .y4m) bestimmt das Format
+     * @param framesPerSecond Bildrate, die in Y4M-Dateien eingetragen wird
+     * @param ringSize Anzahl der Bilder, die höchstens auf das Schreiben warten
+     * @return false, falls das Format unbekannt ist oder die Datei nicht angelegt werden kann
+     */
+    bool start(const QString& fileName, int framesPerSecond = 30, int ringSize = 4);
+
+    /**
+     * @brief stop Beendet die Aufnahme, noch wartende Bilder werden vorher geschrieben
+     */
+    void stop();
+
+    bool isCapturing();
+
+    /**
+     * @brief submit Übernimmt eine Kopie des Bildes, ohne auf das Schreiben zu warten
+     */
+    void submit(const QImage& frame);
+
+    int capturedFrames();
+    int droppedFrames();
+    QString errorString();
+
+protected:
+    virtual void run();
+
+private:
+    struct Slot
+    {
+        QImage image;
+        int frameNumber;
+    };
+
+    bool writeFrame(const Slot& slot);
+    bool writePPM(const QImage& image, const QString& fileName);
+    bool writeY4M(const QImage& image);
+    QString sequenceFileName(int frameNumber) const;
+
+    Format format;
+    QString fileName;
+    int framesPerSecond;
+    QFile stream;
+
+    // Ring der Bilder: ring[first] bis ring[first + queued - 1] warten auf
+    // das Schreiben, alle übrigen sind frei
+    QVector<Slot> ring;
+    int first, queued;
+
+    QMutex mutex;
+    QWaitCondition frameQueued;
+    bool capturing, stopRequested;
+    int submitted, captured, dropped;
+    QString error;
+    QSize streamSize;
+
+    // Nur im Schreib-Thread verwendet
+    bool headerWritten;
+    QVector<uchar> planes;
+};
+
+#endif // FRAMECAPTURE_H
@@ -0,0 +1,66 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "framegraph.h"
+
+#include <QPainter>
+
+// Oberer Rand der Darstellung in ms, etwas über 30 Frames/s
+static const float GraphRange = 40.0f;
+
+FrameGraph::FrameGraph(PerformanceMonitor& monitor, QWidget *parent) :
+    QWidget(parent), monitor(monitor), count(0)
+{
+    setFixedSize(128, 36);
+}
+
+void FrameGraph::refresh()
+{
+    count = monitor.recentFrameTimes(times);
+
+    const PerformanceMonitor::FrameStatistics stats = monitor.statistics();
+    setToolTip(QString("%1 frames, %2 stutters\n"
+                       "min %3 ms, mean %4 ms, max %5 ms\n"
+                       "p50 %6 ms, p95 %7 ms, p99 %8 ms")
+               .arg(stats.frames).arg(stats.stutters)
+               .arg(stats.min, 0, 'f', 1).arg(stats.mean, 0, 'f', 1).arg(stats.max, 0, 'f', 1)
+               .arg(stats.p50, 0, 'f', 1).arg(stats.p95, 0, 'f', 1).arg(stats.p99, 0, 'f', 1));
+
+    update();
+}
+
+void FrameGraph::paintEvent(QPaintEvent*)
+{
+    QPainter p(this);
+    p.fillRect(rect(), QColor(255, 255, 255, 160));
+
+    const int h = height();
+    const float scale = h / GraphRange;
+
+    // Ein Pixel je Bild, das neueste ganz rechts
+    const int visible = qMin(count, width());
+    for(int n = 0; n < visible; n++)
+    {
+        const float time = times[count - visible + n];
+        const int x = width() - visible + n;
+
+        QColor color(0, 160, 0);
+        if(time > 33.3f)
+            color = QColor(200, 0, 0);
+        else if(time > 16.7f)
+            color = QColor(220, 160, 0);
+
+        const int bar = qMin(h, qMax(1, static_cast<int>(time * scale + 0.5f)));
+        p.fillRect(x, h - bar, 1, bar, color);
+    }
+
+    p.setPen(QColor(0, 0, 0, 96));
+    p.drawLine(0, h - static_cast<int>(16.7f * scale), width(), h - static_cast<int>(16.7f * scale));
+    p.drawLine(0, h - static_cast<int>(33.3f * scale), width(), h - static_cast<int>(33.3f * scale));
+}
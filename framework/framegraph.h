@@ -0,0 +1,44 @@
+#ifndef FRAMEGRAPH_H
+#define FRAMEGRAPH_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QWidget>
+#include "performancemonitor.h"
+
+/**
+ * @brief Die FrameGraph Klasse
+ *
+ * Zeigt die letzten Bildzeiten eines PerformanceMonitors als Balken an, die
+ * neuesten rechts. Die Linien markieren 16.7 ms (60 Frames/s) und 33.3 ms
+ * (30 Frames/s); längere Bilder werden rot und bis zum oberen Rand gezeichnet.
+ * Der Tooltip enthält die Statistik seit dem letzten reset.
+ *
+ * Aktualisiert wird mit refresh, z.B. zusammen mit der FPS-Anzeige.
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class FrameGraph : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit FrameGraph(PerformanceMonitor& monitor, QWidget *parent = 0);
+
+public slots:
+    void refresh();
+
+protected:
+    virtual void paintEvent(QPaintEvent*);
+
+private:
+    PerformanceMonitor& monitor;
+    float times[PerformanceMonitor::HistoryLength];
+    int count;
+};
+
+#endif // FRAMEGRAPH_H
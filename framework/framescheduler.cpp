@@ -0,0 +1,198 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "framescheduler.h"
+
+#include <QMutexLocker>
+#include <cmath>
+
+FrameScheduler::FrameScheduler() :
+    currentPolicy(PacingDisplayRate), fixedRate(60.0f), refreshRate(60.0f),
+    period(0), deadline(0), deadlineValid(false),
+    renderAhead(1), framesInFlight(0),
+    lastStart(0), meanInterval(0.0f), intervalVariance(0.0f), intervalCount(0)
+{
+    clock.start();
+    updatePeriod();
+}
+
+void FrameScheduler::setPolicy(Policy policy, float framesPerSecond)
+{
+    QMutexLocker lock(&mutex);
+    currentPolicy = policy;
+    if(framesPerSecond > 0.0f)
+        fixedRate = framesPerSecond;
+    updatePeriod();
+    condition.wakeAll();
+}
+
+FrameScheduler::Policy FrameScheduler::policy()
+{
+    QMutexLocker lock(&mutex);
+    return currentPolicy;
+}
+
+float FrameScheduler::frameRate()
+{
+    QMutexLocker lock(&mutex);
+    return period > 0 ? 1.0e9f / period : 0.0f;
+}
+
+void FrameScheduler::setDisplayRate(float hertz)
+{
+    QMutexLocker lock(&mutex);
+    if(hertz > 0.0f)
+        refreshRate = hertz;
+    updatePeriod();
+}
+
+float FrameScheduler::displayRate()
+{
+    QMutexLocker lock(&mutex);
+    return refreshRate;
+}
+
+void FrameScheduler::setRenderAhead(int frames)
+{
+    QMutexLocker lock(&mutex);
+    renderAhead = qMax(frames, 0);
+    condition.wakeAll();
+}
+
+void FrameScheduler::reset()
+{
+    QMutexLocker lock(&mutex);
+    deadlineValid = false;
+    framesInFlight = 0;
+    lastStart = 0;
+    meanInterval = intervalVariance = 0.0f;
+    intervalCount = 0;
+    condition.wakeAll();
+}
+
+void FrameScheduler::frameStarted()
+{
+    QMutexLocker lock(&mutex);
+    const qint64 now = clock.nsecsElapsed();
+
+    // Abstand zum vorherigen Bild als gleitendes Mittel, die ersten Werte
+    // gehen stärker ein, damit sich die Anzeige schnell einpendelt
+    if(lastStart > 0)
+    {
+        const float interval = (now - lastStart) * 1.0e-6f;
+        const float weight = qMax(0.05f, 1.0f / ++intervalCount);
+        const float deviation = interval - meanInterval;
+        meanInterval += weight * deviation;
+        intervalVariance = (1.0f - weight) * (intervalVariance + weight * deviation * deviation);
+    }
+    lastStart = now;
+
+    if(period == 0)
+        return;
+
+    // Mehr als ein Bild im Verzug: Raster neu ausrichten statt nachzuholen
+    if(!deadlineValid || now - deadline > period)
+    {
+        deadline = now;
+        deadlineValid = true;
+    }
+
+    deadline += period;
+}
+
+int FrameScheduler::nextFrameDelay()
+{
+    QMutexLocker lock(&mutex);
+    if(period == 0 || !deadlineValid)
+        return 0;
+
+    // Abgerundet; ein etwas zu frühes Bild verschiebt das Raster nicht
+    const qint64 remaining = deadline - clock.nsecsElapsed();
+    return remaining > 0 ? static_cast<int>(remaining / 1000000) : 0;
+}
+
+void FrameScheduler::waitForNextFrame(const std::atomic<bool>& cancel)
+{
+    QMutexLocker lock(&mutex);
+
+    forever
+    {
+        if(cancel)
+            return;
+
+        unsigned long timeout;
+        if(framesInFlight > renderAhead)
+        {
+            // framePresented weckt den Thread; das Timeout ist nur eine Absicherung
+            timeout = 100;
+        }
+        else
+        {
+            if(period == 0 || !deadlineValid)
+                return;
+
+            const qint64 remaining = deadline - clock.nsecsElapsed();
+            if(remaining <= 0)
+                return;
+
+            timeout = static_cast<unsigned long>((remaining + 999999) / 1000000);
+        }
+
+        condition.wait(&mutex, timeout);
+    }
+}
+
+void FrameScheduler::wakeUp()
+{
+    QMutexLocker lock(&mutex);
+    condition.wakeAll();
+}
+
+void FrameScheduler::frameQueued()
+{
+    QMutexLocker lock(&mutex);
+    framesInFlight++;
+}
+
+void FrameScheduler::framePresented()
+{
+    QMutexLocker lock(&mutex);
+    framesInFlight = qMax(framesInFlight - 1, 0);
+    condition.wakeAll();
+}
+
+float FrameScheduler::averageInterval()
+{
+    QMutexLocker lock(&mutex);
+    return meanInterval;
+}
+
+float FrameScheduler::intervalJitter()
+{
+    QMutexLocker lock(&mutex);
+    return std::sqrt(intervalVariance);
+}
+
+void FrameScheduler::updatePeriod()
+{
+    switch(currentPolicy)
+    {
+    case PacingFixedRate:
+        period = static_cast<qint64>(1.0e9 / fixedRate);
+        break;
+    case PacingDisplayRate:
+        period = static_cast<qint64>(1.0e9 / refreshRate);
+        break;
+    case PacingAsFastAsPossible:
+        period = 0;
+        break;
+    }
+
+    deadlineValid = false;
+}
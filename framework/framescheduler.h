@@ -0,0 +1,115 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+
+/**
+ * @brief Die FrameScheduler Klasse
+ *
+ * Legt fest, wann das nächste Bild gezeichnet wird. Die Zeitpunkte liegen
+ * auf einem festen Raster (Bildrate bzw. Bildwiederholrate des Displays),
+ * sodass die Abstände gleichmäßig bleiben und die Zeit dazwischen dem
+ * übrigen System zur Verfügung steht. Wird ein Bild zu spät fertig, wird
+ * das Raster neu ausgerichtet statt verpasste Bilder nachzuholen.
+ *
+ * Im Render-Thread-Modus begrenzt der Scheduler zusätzlich, wie viele
+ * fertige Bilder noch auf die Darstellung warten dürfen (render ahead),
+ * damit der Render-Thread der Anzeige nicht davonläuft.
+ *
+ * Gemessen wird der Abstand zwischen dem Beginn zweier Bilder: Mittelwert
+ * und Standardabweichung ("Jitter") als gleitende Mittel.
+ *
+ * Die Methoden dürfen aus verschiedenen Threads aufgerufen werden.
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class FrameScheduler
+{
+public:
+    /**
+     * @brief Die Verfahren zur Wahl des nächsten Bildes
+     *
+     * PacingFixedRate: Feste Bildrate (setPolicy)
+     * PacingDisplayRate: Bildwiederholrate des Displays (setDisplayRate)
+     * PacingAsFastAsPossible: Ohne Pause, nur durch render ahead begrenzt
+     */
+    enum Policy
+    {
+        PacingFixedRate,
+        PacingDisplayRate,
+        PacingAsFastAsPossible
+    };
+
+    FrameScheduler();
+
+    void setPolicy(Policy policy, float framesPerSecond = 60.0f);
+    Policy policy();
+    float frameRate();
+
+    void setDisplayRate(float hertz);
+    float displayRate();
+
+    /**
+     * @brief setRenderAhead Wie viele Bilder der Render-Thread der Darstellung voraus sein darf
+     */
+    void setRenderAhead(int frames);
+
+    /**
+     * @brief reset Vergisst Raster, wartende Bilder und Messwerte (z.B. beim Wechsel der Abgabe)
+     */
+    void reset();
+
+    /**
+     * @brief frameStarted Zu Beginn jedes Bildes aufrufen, legt den Zeitpunkt des nächsten fest
+     */
+    void frameStarted();
+
+    /**
+     * @brief nextFrameDelay Millisekunden bis zum nächsten Bild, für einen QTimer
+     */
+    int nextFrameDelay();
+
+    /**
+     * @brief waitForNextFrame Wartet bis zum nächsten Bild und bis die Darstellung nachgezogen hat
+     * @param cancel Wird dieser Wert true, kehrt die Methode nach wakeUp sofort zurück
+     */
+    void waitForNextFrame(const std::atomic<bool>& cancel);
+    void wakeUp();
+
+    void frameQueued();
+    void framePresented();
+
+    float averageInterval();    // ms
+    float intervalJitter();     // ms, Standardabweichung
+
+private:
+    void updatePeriod();
+
+    QMutex mutex;
+    QWaitCondition condition;
+    QElapsedTimer clock;
+
+    Policy currentPolicy;
+    float fixedRate, refreshRate;
+    qint64 period;              // ns, 0: ohne Pause
+    qint64 deadline;            // ns, Beginn des nächsten Bildes
+    bool deadlineValid;
+
+    int renderAhead;
+    int framesInFlight;
+
+    qint64 lastStart;
+    float meanInterval, intervalVariance;
+    int intervalCount;
+};
+
+#endif // FRAMESCHEDULER_H
@@ -0,0 +1,73 @@
+#
+# Leibniz Universität Hannover - Institute for Man-Machine-Communication
+# Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+#
+# You should have received a copy of the MIT License along with this program.
+#
+# Die Teile des Frameworks, die ohne Fenster auskommen. Werden von
+# GDV-Framework.pro und GDV-Headless.pro gemeinsam verwendet.
+#
+
+# Mit "qmake CONFIG+=gdv_alloc_tracking" werden alle Speicheranforderungen
+# gezählt und je Bild angezeigt (siehe AllocationTracker)
+gdv_alloc_tracking {
+    DEFINES += GDV_ALLOC_TRACKING
+}
+
+SOURCES += \
+    $$PWD/meshloader.cpp \
+    $$PWD/performancemonitor.cpp \
+    $$PWD/softwarecanvas.cpp \
+    $$PWD/pixelconversion.cpp \
+    $$PWD/bufferaccess.cpp \
+    $$PWD/outofboundscounter.cpp \
+    $$PWD/rasterizer.cpp \
+    $$PWD/depthbuffer.cpp \
+    $$PWD/texture.cpp \
+    $$PWD/primitives.cpp \
+    $$PWD/curves.cpp \
+    $$PWD/seedfill.cpp \
+    $$PWD/clipper.cpp \
+    $$PWD/multisamplebuffer.cpp \
+    $$PWD/workerpool.cpp \
+    $$PWD/tilerenderer.cpp \
+    $$PWD/framecapture.cpp \
+    $$PWD/resolutionscaler.cpp \
+    $$PWD/framescheduler.cpp \
+    $$PWD/inputqueue.cpp \
+    $$PWD/swapchain.cpp \
+    $$PWD/profiler.cpp \
+    $$PWD/allocationtracker.cpp
+
+HEADERS += \
+    $$PWD/meshloader.h \
+    $$PWD/../interfaces/GdvCanvas.h \
+    $$PWD/../interfaces/GdvGui.h \
+    $$PWD/../interfaces/RendererBase.h \
+    $$PWD/performancemonitor.h \
+    $$PWD/softwarecanvas.h \
+    $$PWD/../interfaces/Tuple3.h \
+    $$PWD/../interfaces/InputEvent.h \
+    $$PWD/simd.h \
+    $$PWD/pixelconversion.h \
+    $$PWD/bufferaccess.h \
+    $$PWD/dirtyrect.h \
+    $$PWD/outofboundscounter.h \
+    $$PWD/rasterizer.h \
+    $$PWD/depthbuffer.h \
+    $$PWD/texture.h \
+    $$PWD/primitives.h \
+    $$PWD/curves.h \
+    $$PWD/seedfill.h \
+    $$PWD/clipper.h \
+    $$PWD/multisamplebuffer.h \
+    $$PWD/workerpool.h \
+    $$PWD/tilerenderer.h \
+    $$PWD/framecapture.h \
+    $$PWD/resolutionscaler.h \
+    $$PWD/framescheduler.h \
+    $$PWD/inputqueue.h \
+    $$PWD/swapchain.h \
+    $$PWD/pooledbuffer.h \
+    $$PWD/profiler.h \
+    $$PWD/allocationtracker.h
@@ -8,95 +8,203 @@
 
 
 #include "gdvcanvas2d.h"
+#include "inputqueue.h"
+#include "profiler.h"
 
 #include <QColor>
 #include <QPainter>
 #include <QMouseEvent>
 #include <QKeyEvent>
 #include <QDebug>
+#include <QMutexLocker>
 
 GdvCanvas2D::GdvCanvas2D(QWidget *parent) :
     QWidget(parent)
 {
 }
 
-void GdvCanvas2D::setPixel(unsigned int x, unsigned int y, const QVector3D& color)
+void GdvCanvas2D::setThreadedRendering(bool enabled)
 {
-    if(x >= static_cast<unsigned int>(width()) || y >= static_cast<unsigned int>(height()))
-    {
-        qDebug() << "Warning: Drawing outside of viewport! (" << x << "," << y << ")";
-        return;
-    }
+    threadedRendering = enabled;
+}
 
-    if(y != lastY)
-    {
-        lastLine = reinterpret_cast<QRgb*>(buffer2D.scanLine(y));
-        lastY = y;
-    }
+void GdvCanvas2D::setOutputSize(int width, int height)
+{
+    outputWidth = width;
+    outputHeight = height;
+
+    const QSize size = scaler.scaledSize(width, height);
+    resizeBuffer(size.width(), size.height());
+}
+
+void GdvCanvas2D::setTargetFrameRate(float fps)
+{
+    scaler.setTargetFrameTime(fps > 0.0f ? 1000.0f / fps : 0.0f);
+}
 
-    *(lastLine+x) = qRgb(color.x()*255, color.y()*255, color.z()*255);
+bool GdvCanvas2D::adaptResolution(qint64 frameTime)
+{
+    if(!scaler.addFrame(frameTime))
+        return false;
+
+    setOutputSize(outputWidth, outputHeight);
+    return true;
 }
 
-void GdvCanvas2D::clearBuffer(const QVector3D &clearColor)
+void GdvCanvas2D::presentBuffer(const QRect& changed)
 {
-    buffer2D.fill(QColor(clearColor.x()*255,
-                         clearColor.y()*255,
-                         clearColor.z()*255));
+    // Die SwapChain hat die Puffer bereits getauscht, hier wird nichts kopiert
+    QMutexLocker lock(&frameMutex);
+
+    if(externalShown || frameSize != bufferSize())
+    {
+        externalImage = QImage();
+        externalShown = false;
+        frameSize = bufferSize();
+        updateRegion = QRegion(QRect(QPoint(0, 0), frameSize));
+        return;
+    }
+
+    if(!changed.isEmpty())
+        updateRegion += changed;
 }
 
-void GdvCanvas2D::flipBuffer()
+void GdvCanvas2D::presentImage(const QImage& image)
 {
-    currentBuf = buffer2D;
+    // QImage wird implizit geteilt: Verändert die Abgabe ihr Bild danach,
+    // erhält sie dabei automatisch eine eigene Kopie
+    SoftwareCanvas::presentImage(image);
+
+    QMutexLocker lock(&frameMutex);
+    externalImage = image;
+    externalShown = true;
+    frameSize = externalImage.size();
+    updateRegion = QRegion(externalImage.rect());
 }
 
-void GdvCanvas2D::flipBuffer(const QImage& buffer)
+void GdvCanvas2D::presentFrame(bool immediate)
 {
-    currentBuf = buffer.copy(); // Evtl. ist das copy nicht notwendig...
+    frameMutex.lock();
+    QRegion region = updateRegion;
+    updateRegion = QRegion();
+    const bool scaled = frameSize != size();
+    frameMutex.unlock();
+
+    if(region.isEmpty())
+        return;
+
+    // Ein skaliertes Bild wird immer vollständig neu gezeichnet
+    if(scaled)
+        region = rect();
+
+    if(immediate)
+        repaint(region);
+    else
+        update(region);
 }
 
 void GdvCanvas2D::paintEvent(QPaintEvent* pe)
 {
-    Q_UNUSED(pe);
-    QPainter p(this);
-    p.drawImage(0,0, currentBuf);
+    GDV_PROFILE_ZONE("present");
+
+    // Nur eine (flache) Kopie unter dem Lock, damit ein Render-Thread nicht
+    // auf das Zeichnen warten muss. Den Front-Buffer verwendet er solange nicht.
+    frameMutex.lock();
+    const bool external = externalShown;
+    QImage frame = externalImage;
+    frameMutex.unlock();
+
+    if(!external)
+        frame = swapChain.acquireFront();
+
+    {
+        QPainter p(this);
+
+        if(frame.size() != size())
+        {
+            // Dynamische Auflösung: auf die Größe des Widgets skalieren
+            p.setRenderHint(QPainter::SmoothPixmapTransform);
+            p.drawImage(rect(), frame);
+        }
+        else
+        {
+            // Nur den neu darzustellenden Bereich zeichnen (siehe presentFrame)
+            p.drawImage(pe->rect(), frame, pe->rect());
+        }
+    }
+
+    if(!external)
+        swapChain.releaseFront(frame);
 }
 
 void GdvCanvas2D::resizeEvent(QResizeEvent* pe)
 {
     Q_UNUSED(pe);
-    buffer2D = QImage(this->size(), QImage::Format_RGB32);
+
+    // Im Render-Thread-Modus wird der Puffer zwischen zwei Bildern vom
+    // Render-Thread selbst angepasst (siehe MainWindow::resized)
+    if(!threadedRendering)
+        setOutputSize(this->width(), this->height());
+
     emit sizeChanged(this->width(), this->height());
 }
 
+QPoint GdvCanvas2D::toBuffer(const QPoint& position)
+{
+    // Mauspositionen beziehen sich auf das zuletzt dargestellte Bild
+    frameMutex.lock();
+    const QSize shown = frameSize;
+    frameMutex.unlock();
+
+    if(shown.isEmpty() || shown == size())
+        return position;
+
+    return QPoint(position.x() * shown.width() / qMax(width(), 1),
+                  position.y() * shown.height() / qMax(height(), 1));
+}
+
+void GdvCanvas2D::setInputQueue(InputQueue* queue)
+{
+    inputQueue = queue;
+}
+
 void GdvCanvas2D::mousePressEvent(QMouseEvent* e)
 {
-    emit mousePressed(e->pos().x(), e->pos().y());
+    const QPoint position = toBuffer(e->pos());
+    if(inputQueue)
+        inputQueue->mousePressed(position.x(), position.y(), e->button());
 }
 
 void GdvCanvas2D::mouseReleaseEvent(QMouseEvent* e)
 {
-    emit mouseReleased(e->pos().x(), e->pos().y());
+    const QPoint position = toBuffer(e->pos());
+    if(inputQueue)
+        inputQueue->mouseReleased(position.x(), position.y(), e->button());
 }
 
 void GdvCanvas2D::mouseMoveEvent(QMouseEvent* e)
 {
-    emit mouseMoved(e->pos().x(), e->pos().y());
+    const QPoint position = toBuffer(e->pos());
+    if(inputQueue)
+        inputQueue->mouseMoved(position.x(), position.y(), e->buttons());
 }
 
 void GdvCanvas2D::wheelEvent(QWheelEvent* e)
 {
-    emit wheelMoved(e->delta());
+    if(inputQueue)
+        inputQueue->wheelMoved(e->delta());
 }
 
 void GdvCanvas2D::keyPressEvent(QKeyEvent* e)
 {
-    qDebug() << "Key pressed:" << e->text();
-    emit keyPressed(e->text());
+    if(inputQueue)
+        inputQueue->keyPressed(e->key(), e->text());
 }
 
 void GdvCanvas2D::keyReleaseEvent(QKeyEvent* e)
 {
-    emit keyReleased(e->text());
+    if(inputQueue)
+        inputQueue->keyReleased(e->key(), e->text());
 }
 
 void GdvCanvas2D::enterEvent(QEvent*)
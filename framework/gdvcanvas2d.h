@@ -9,41 +9,67 @@
  **/
 
 
-#include "interfaces/GdvCanvas.h"
+#include "softwarecanvas.h"
+#include "resolutionscaler.h"
+
+class InputQueue;
 
 #include <QWidget>
 #include <QImage>
+#include <QMutex>
+#include <QRegion>
 
 /**
  * @brief Die GdvCanvas2D Klasse
  *
  * Ermöglicht direktes Zeichnen in einen Puffer. Implementiert das GdvCanvas-
- * Interface.
+ * Interface (siehe SoftwareCanvas) und stellt das fertige Bild im Fenster dar.
+ * Mit setTargetFrameRate ist der Puffer ggf. kleiner als das Widget und wird
+ * beim Zeichnen auf dessen Größe skaliert.
  *
  * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
  */
-class GdvCanvas2D : public QWidget, public GdvCanvas
+class GdvCanvas2D : public QWidget, public SoftwareCanvas
 {
     Q_OBJECT
 public:
     explicit GdvCanvas2D(QWidget *parent = 0);
 
-    virtual void setPixel(unsigned int x, unsigned int y, const QVector3D& color);
-    virtual void clearBuffer(const QVector3D& clearColor);
-    virtual void flipBuffer();
-    virtual void flipBuffer(const QImage& buffer);
+    void setThreadedRendering(bool enabled);
+
+    /**
+     * @brief setOutputSize Passt den Puffer an die Größe des Widgets an (ggf. skaliert)
+     */
+    void setOutputSize(int width, int height);
+
+    /**
+     * @brief setTargetFrameRate Schaltet die dynamische Auflösung ein (fps > 0.0) oder aus
+     *
+     * Wirkt sich erst mit dem nächsten setOutputSize bzw. adaptResolution auf den Puffer aus.
+     */
+    void setTargetFrameRate(float fps);
 
+    /**
+     * @brief adaptResolution Übernimmt die Dauer des letzten Bildes in die Regelung der Auflösung
+     * @return true, falls der Puffer dabei eine neue Größe erhalten hat
+     */
+    bool adaptResolution(qint64 frameTime);
+
+    /**
+     * @brief setInputQueue Maus- und Tastatureingaben ab jetzt in queue sammeln (0: verwerfen)
+     */
+    void setInputQueue(InputQueue* queue);
+
+public slots:
+    void presentFrame(bool immediate = false);
 
 signals:
     void sizeChanged(int, int);
-    void mousePressed(int, int);
-    void mouseReleased(int, int);
-    void mouseMoved(int, int);
-    void wheelMoved(int);
-    void keyPressed(QString);
-    void keyReleased(QString);
 
 protected:
+    virtual void presentBuffer(const QRect& changed);
+    virtual void presentImage(const QImage& image);
+
     virtual void paintEvent(QPaintEvent*);
     virtual void resizeEvent(QResizeEvent*);
 
@@ -60,11 +86,26 @@ protected:
 
 
 private:
-    QImage buffer2D;
-    QImage currentBuf;
+    QPoint toBuffer(const QPoint& position);
+
+    InputQueue* inputQueue = 0;
+
+    QMutex frameMutex;
+
+    // Mit flipBuffer(const QImage&) übergebenes Bild, wird anstelle des
+    // Front-Buffers der SwapChain dargestellt
+    QImage externalImage;
+    bool externalShown = false;
+    QSize frameSize;
+
+    // Noch nicht neu gezeichneter Bereich des dargestellten Bildes
+    QRegion updateRegion;
+
+    bool threadedRendering = false;
 
-    unsigned int lastY = INT_MAX;
-    QRgb* lastLine = 0;
+    // Dynamische Auflösung, nur im rendernden Thread verwendet
+    ResolutionScaler scaler;
+    int outputWidth = 0, outputHeight = 0;
 };
 
 #endif // GDVCANVAS2D_H
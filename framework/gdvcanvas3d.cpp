@@ -8,12 +8,13 @@
 
 
 #include "gdvcanvas3d.h"
+#include "inputqueue.h"
 #include <QDebug>
 #include <QMouseEvent>
 #include <QKeyEvent>
 
 GdvCanvas3D::GdvCanvas3D(QGLFormat format) :
-    QGLWidget(format)
+    QGLWidget(format), inputQueue(0)
 {
 }
 
@@ -23,12 +24,99 @@ void GdvCanvas3D::setPixel(unsigned int x, unsigned int y, const QVector3D &colo
     qWarning() << "'setPixel' is not supported in OpenGL mode. Please use the appropriate OpenGL functions.";
 }
 
+void GdvCanvas3D::setPixelUnchecked(unsigned int x, unsigned int y, const QVector3D &color)
+{
+    Q_UNUSED(x); Q_UNUSED(y); Q_UNUSED(color);
+    qWarning() << "'setPixelUnchecked' is not supported in OpenGL mode. Please use the appropriate OpenGL functions.";
+}
+
+void GdvCanvas3D::setSpan(unsigned int x, unsigned int y, unsigned int length, const QVector3D &color)
+{
+    Q_UNUSED(x); Q_UNUSED(y); Q_UNUSED(length); Q_UNUSED(color);
+    qWarning() << "'setSpan' is not supported in OpenGL mode. Please use the appropriate OpenGL functions.";
+}
+
+void GdvCanvas3D::setRow(unsigned int x, unsigned int y, unsigned int length, const float* rgb)
+{
+    Q_UNUSED(x); Q_UNUSED(y); Q_UNUSED(length); Q_UNUSED(rgb);
+    qWarning() << "'setRow' is not supported in OpenGL mode. Please use the appropriate OpenGL functions.";
+}
+
+void GdvCanvas3D::setRow(unsigned int x, unsigned int y, unsigned int length, const QRgb* pixels)
+{
+    Q_UNUSED(x); Q_UNUSED(y); Q_UNUSED(length); Q_UNUSED(pixels);
+    qWarning() << "'setRow' is not supported in OpenGL mode. Please use the appropriate OpenGL functions.";
+}
+
+void GdvCanvas3D::fillRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const QVector3D &color)
+{
+    Q_UNUSED(x); Q_UNUSED(y); Q_UNUSED(width); Q_UNUSED(height); Q_UNUSED(color);
+    qWarning() << "'fillRect' is not supported in OpenGL mode. Please use the appropriate OpenGL functions.";
+}
+
+void GdvCanvas3D::setClipRect(const QRect& rect)
+{
+    Q_UNUSED(rect);
+    qWarning() << "'setClipRect' is not supported in OpenGL mode. Please use the appropriate OpenGL functions.";
+}
+
+QRect GdvCanvas3D::clipRect()
+{
+    return QRect();
+}
+
+QVector3D GdvCanvas3D::getPixel(unsigned int x, unsigned int y)
+{
+    Q_UNUSED(x); Q_UNUSED(y);
+    qWarning() << "'getPixel' is not supported in OpenGL mode. Please use the appropriate OpenGL functions.";
+    return QVector3D();
+}
+
+void GdvCanvas3D::getRow(unsigned int x, unsigned int y, unsigned int length, QRgb* pixels)
+{
+    Q_UNUSED(x); Q_UNUSED(y); Q_UNUSED(length); Q_UNUSED(pixels);
+    qWarning() << "'getRow' is not supported in OpenGL mode. Please use the appropriate OpenGL functions.";
+}
+
+GdvCanvas::BufferMapping GdvCanvas3D::mapBuffer()
+{
+    qWarning() << "'mapBuffer' is not supported in OpenGL mode. Please use the appropriate OpenGL functions.";
+    return BufferMapping();
+}
+
+void GdvCanvas3D::unmapBuffer()
+{
+}
+
+void GdvCanvas3D::unmapBuffer(const QRect& modified)
+{
+    Q_UNUSED(modified);
+}
+
 void GdvCanvas3D::clearBuffer(const QVector3D &clearColor)
 {
     Q_UNUSED(clearColor);
     qWarning() << "'clearBuffer' is not supported in OpenGL mode. Please use the appropriate OpenGL functions.";
 }
 
+DepthBuffer* GdvCanvas3D::depthBuffer()
+{
+    // Im OpenGL-Modus übernimmt OpenGL den Tiefentest
+    return 0;
+}
+
+MultisampleBuffer* GdvCanvas3D::multisampleBuffer()
+{
+    // Kantenglättung im OpenGL-Modus z.B. mit QGLFormat::setSampleBuffers
+    return 0;
+}
+
+void GdvCanvas3D::setToneMapping(ToneMapping mode, float exposure, bool sRGB)
+{
+    Q_UNUSED(mode); Q_UNUSED(exposure); Q_UNUSED(sRGB);
+    qWarning() << "'setToneMapping' is not supported in OpenGL mode. Please use the appropriate OpenGL functions.";
+}
+
 void GdvCanvas3D::flipBuffer()
 {
     qWarning() << "'flipBuffer' is not supported in OpenGL mode. Please use the appropriate OpenGL functions.";
@@ -55,36 +143,46 @@ void GdvCanvas3D::resizeGL(int width, int height)
     emit sizeChanged(width, height);
 }
 
+void GdvCanvas3D::setInputQueue(InputQueue* queue)
+{
+    inputQueue = queue;
+}
+
 void GdvCanvas3D::mousePressEvent(QMouseEvent* e)
 {
-    emit mousePressed(e->pos().x(), e->pos().y());
+    if(inputQueue)
+        inputQueue->mousePressed(e->pos().x(), e->pos().y(), e->button());
 }
 
 void GdvCanvas3D::mouseReleaseEvent(QMouseEvent* e)
 {
-    emit mouseReleased(e->pos().x(), e->pos().y());
+    if(inputQueue)
+        inputQueue->mouseReleased(e->pos().x(), e->pos().y(), e->button());
 }
 
 void GdvCanvas3D::mouseMoveEvent(QMouseEvent* e)
 {
-    emit mouseMoved(e->pos().x(), e->pos().y());
+    if(inputQueue)
+        inputQueue->mouseMoved(e->pos().x(), e->pos().y(), e->buttons());
 }
 
 void GdvCanvas3D::wheelEvent(QWheelEvent* e)
 {
-    emit wheelMoved(e->delta());
+    if(inputQueue)
+        inputQueue->wheelMoved(e->delta());
 }
 
 
 void GdvCanvas3D::keyPressEvent(QKeyEvent* e)
 {
-    qDebug() << "Key pressed:" << e->text();
-    emit keyPressed(e->text());
+    if(inputQueue)
+        inputQueue->keyPressed(e->key(), e->text());
 }
 
 void GdvCanvas3D::keyReleaseEvent(QKeyEvent* e)
 {
-    emit keyReleased(e->text());
+    if(inputQueue)
+        inputQueue->keyReleased(e->key(), e->text());
 }
 
 void GdvCanvas3D::enterEvent(QEvent*)
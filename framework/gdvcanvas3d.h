@@ -12,6 +12,8 @@
 #include <QGLWidget>
 #include "interfaces/GdvCanvas.h"
 
+class InputQueue;
+
 /**
  * @brief Die GdvCanvas3D Klasse
  *
@@ -27,18 +29,32 @@ public:
     explicit GdvCanvas3D(QGLFormat format);
 
     virtual void setPixel(unsigned int x, unsigned int y, const QVector3D& color);
+    virtual void setPixelUnchecked(unsigned int x, unsigned int y, const QVector3D& color);
+    virtual void setSpan(unsigned int x, unsigned int y, unsigned int length, const QVector3D& color);
+    virtual void setRow(unsigned int x, unsigned int y, unsigned int length, const float* rgb);
+    virtual void setRow(unsigned int x, unsigned int y, unsigned int length, const QRgb* pixels);
+    virtual void fillRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const QVector3D& color);
+    virtual void setClipRect(const QRect& rect);
+    virtual QRect clipRect();
+    virtual QVector3D getPixel(unsigned int x, unsigned int y);
+    virtual void getRow(unsigned int x, unsigned int y, unsigned int length, QRgb* pixels);
+    virtual BufferMapping mapBuffer();
+    virtual void unmapBuffer();
+    virtual void unmapBuffer(const QRect& modified);
     virtual void clearBuffer(const QVector3D& clearColor);
+    virtual DepthBuffer* depthBuffer();
+    virtual MultisampleBuffer* multisampleBuffer();
+    virtual void setToneMapping(ToneMapping mode, float exposure = 1.0f, bool sRGB = false);
     virtual void flipBuffer();
     virtual void flipBuffer(const QImage& buffer);
 
+    /**
+     * @brief setInputQueue Maus- und Tastatureingaben ab jetzt in queue sammeln (0: verwerfen)
+     */
+    void setInputQueue(InputQueue* queue);
+
 signals:
     void sizeChanged(int, int);
-    void mousePressed(int, int);
-    void mouseReleased(int, int);
-    void mouseMoved(int, int);
-    void wheelMoved(int);
-    void keyPressed(QString);
-    void keyReleased(QString);
 
     void drawGL();
 
@@ -58,6 +74,8 @@ protected:
     virtual void enterEvent(QEvent*);
     virtual void leaveEvent(QEvent*);
 
+private:
+    InputQueue* inputQueue;
 };
 
 #endif // GDVCANVAS3D_H
@@ -0,0 +1,131 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "inputqueue.h"
+
+#include <QMutexLocker>
+
+// Erstes Zeichen von text als Unicode-Codepunkt, 0 falls leer
+static char32_t firstCharacter(const QString& text)
+{
+    if(text.isEmpty())
+        return 0;
+
+    if(text.size() > 1 && text.at(0).isHighSurrogate() && text.at(1).isLowSurrogate())
+        return QChar::surrogateToUcs4(text.at(0), text.at(1));
+
+    return text.at(0).unicode();
+}
+
+InputQueue::InputQueue()
+{
+    clock.start();
+}
+
+void InputQueue::mousePressed(int x, int y, int button)
+{
+    QMutexLocker lock(&mutex);
+    InputEvent& event = append(InputEvent::MousePressed);
+    event.x = x;
+    event.y = y;
+    event.button = button;
+}
+
+void InputQueue::mouseReleased(int x, int y, int button)
+{
+    QMutexLocker lock(&mutex);
+    InputEvent& event = append(InputEvent::MouseReleased);
+    event.x = x;
+    event.y = y;
+    event.button = button;
+}
+
+void InputQueue::mouseMoved(int x, int y, int buttons)
+{
+    QMutexLocker lock(&mutex);
+
+    // Zwischenpositionen werden nicht benötigt, solange sich die gehaltenen Tasten nicht ändern
+    if(!events.isEmpty() && events.last().type == InputEvent::MouseMoved && events.last().button == buttons)
+    {
+        InputEvent& event = events.last();
+        event.x = x;
+        event.y = y;
+        event.timestamp = clock.nsecsElapsed() / 1000;
+        event.merged++;
+        return;
+    }
+
+    InputEvent& event = append(InputEvent::MouseMoved);
+    event.x = x;
+    event.y = y;
+    event.button = buttons;
+}
+
+void InputQueue::wheelMoved(int delta)
+{
+    QMutexLocker lock(&mutex);
+
+    if(!events.isEmpty() && events.last().type == InputEvent::WheelMoved)
+    {
+        InputEvent& event = events.last();
+        event.delta += delta;
+        event.timestamp = clock.nsecsElapsed() / 1000;
+        event.merged++;
+        return;
+    }
+
+    append(InputEvent::WheelMoved).delta = delta;
+}
+
+void InputQueue::keyPressed(int key, const QString& text)
+{
+    QMutexLocker lock(&mutex);
+    InputEvent& event = append(InputEvent::KeyPressed);
+    event.key = key;
+    event.character = firstCharacter(text);
+}
+
+void InputQueue::keyReleased(int key, const QString& text)
+{
+    QMutexLocker lock(&mutex);
+    InputEvent& event = append(InputEvent::KeyReleased);
+    event.key = key;
+    event.character = firstCharacter(text);
+}
+
+void InputQueue::take(QVector<InputEvent>& events)
+{
+    // Nach dem Tausch behält die Warteschlange den Speicher der übergebenen Liste
+    events.clear();
+
+    QMutexLocker lock(&mutex);
+    this->events.swap(events);
+}
+
+void InputQueue::clear()
+{
+    QMutexLocker lock(&mutex);
+    events.clear();
+}
+
+InputEvent& InputQueue::append(InputEvent::Type type)
+{
+    InputEvent event;
+    event.type = type;
+    event.x = event.y = 0;
+    event.button = 0;
+    event.delta = 0;
+    event.key = 0;
+    event.character = 0;
+    event.timestamp = clock.nsecsElapsed() / 1000;
+    event.merged = 1;
+
+    events.append(event);
+    return events.last();
+}
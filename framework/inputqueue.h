@@ -0,0 +1,60 @@
+#ifndef INPUTQUEUE_H
+#define INPUTQUEUE_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QVector>
+#include "interfaces/InputEvent.h"
+
+/**
+ * @brief Die InputQueue Klasse
+ *
+ * Sammelt die Eingaben der Zeichenflächen bis zum nächsten Bild. Folgt eine
+ * Mausbewegung direkt auf eine Mausbewegung, wird nur die vorhandene
+ * aktualisiert; ebenso werden Mausradbewegungen aufsummiert. Die Reihenfolge
+ * gegenüber Klicks und Tasten bleibt dabei erhalten.
+ *
+ * Der rendernde Thread holt mit take alle Eingaben auf einmal ab. Dabei werden
+ * die Listen nur getauscht, sodass nach kurzer Zeit keine Speicheranforderungen
+ * mehr nötig sind.
+ *
+ * Die Methoden dürfen aus verschiedenen Threads aufgerufen werden.
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class InputQueue
+{
+public:
+    InputQueue();
+
+    void mousePressed(int x, int y, int button);
+    void mouseReleased(int x, int y, int button);
+    void mouseMoved(int x, int y, int buttons);
+    void wheelMoved(int delta);
+    void keyPressed(int key, const QString& text);
+    void keyReleased(int key, const QString& text);
+
+    /**
+     * @brief take Übergibt alle gesammelten Eingaben an events und leert die Warteschlange
+     *
+     * Der bisherige Inhalt von events wird verworfen, dessen Speicher aber weiterverwendet.
+     */
+    void take(QVector<InputEvent>& events);
+
+    void clear();
+
+private:
+    InputEvent& append(InputEvent::Type type);
+
+    QMutex mutex;
+    QElapsedTimer clock;
+    QVector<InputEvent> events;
+};
+
+#endif // INPUTQUEUE_H
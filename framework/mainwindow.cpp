@@ -21,6 +21,9 @@
 #include "interfaces/RendererBase.h"
 #include "framework/gdvcanvas2d.h"
 #include "framework/gdvcanvas3d.h"
+#include "framework/renderthread.h"
+#include "framework/framegraph.h"
+#include "framework/profiler.h"
 
 #include <QDir>
 #include <QGLWidget>
@@ -28,6 +31,14 @@
 #include <QPushButton>
 #include <QComboBox>
 #include <QMessageBox>
+#include <QMenu>
+#include <QActionGroup>
+#include <QDateTime>
+
+#if QT_VERSION >= 0x050000
+#include <QGuiApplication>
+#include <QScreen>
+#endif
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -36,6 +47,7 @@ MainWindow::MainWindow(QWidget *parent) :
 {
     ui->setupUi(this);
     this->setWindowTitle(qApp->applicationName() + " - " + qApp->applicationVersion());
+    Profiler::setThreadName("GUI");
 
     guiUpdate.setInterval(50);
     guiUpdate.start();
@@ -44,8 +56,14 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->comboMesh, SIGNAL(activated(int)), this, SLOT(activateMesh(int)));
     connect(ui->comboTexture, SIGNAL(activated(int)), this, SLOT(activateTexture(int)));
 
-    redrawUpdate.setInterval(0);
-    redrawUpdate.start();
+    // redraw plant das jeweils nächste Bild selbst (siehe FrameScheduler)
+    redrawUpdate.setSingleShot(true);
+#if QT_VERSION >= 0x050000
+    redrawUpdate.setTimerType(Qt::PreciseTimer);
+    if(QGuiApplication::primaryScreen())
+        frameScheduler.setDisplayRate(QGuiApplication::primaryScreen()->refreshRate());
+#endif
+    redrawUpdate.start(0);
     connect(&redrawUpdate, SIGNAL(timeout()), this, SLOT(redraw()));
 
     currentLecture = 0;
@@ -59,6 +77,11 @@ MainWindow::MainWindow(QWidget *parent) :
     canvas2D = new GdvCanvas2D();
     ui->splitter->addWidget(canvas2D);
     canvas2D->hide();
+    canvas2D->setFrameCapture(&frameCapture);
+
+    renderThread = new RenderThread(*canvas2D, tileRenderer, perfCount, frameScheduler, inputQueue);
+    connect(renderThread, SIGNAL(frameFinished()), this, SLOT(presentRenderedFrame()));
+    dispatchToLecture = [this](const std::function<void()>& task) { renderThread->post(task); };
 
     QGLFormat glFormat;
     glFormat.setVersion( 3, 2 );
@@ -70,6 +93,8 @@ MainWindow::MainWindow(QWidget *parent) :
 
     fullscreenControls = ui->frameInscreen;
     ui->frame->layout()->removeWidget(fullscreenControls);
+    frameGraph = new FrameGraph(perfCount);
+    static_cast<QBoxLayout*>(fullscreenControls->layout())->insertWidget(0, frameGraph);
     ui->buttonFullscreen->setIcon(QIcon::fromTheme("view-fullscreen"));
     fullscreen = true;
     updateFullscreenBar();
@@ -83,22 +108,35 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(canvas3D, SIGNAL(sizeChanged(int,int)), this, SLOT(resized(int,int)));
     connect(&guiUpdate, SIGNAL(timeout()), this, SLOT(showFPS()));
 
-    connect(canvas2D, SIGNAL(mouseMoved(int,int)), this, SLOT(mouseMoved(int,int)));
-    connect(canvas2D, SIGNAL(mousePressed(int,int)), this, SLOT(mousePressed(int,int)));
-    connect(canvas2D, SIGNAL(mouseReleased(int,int)), this, SLOT(mouseReleased(int,int)));
-    connect(canvas2D, SIGNAL(wheelMoved(int)), this, SLOT(wheelMoved(int)));
-    connect(canvas2D, SIGNAL(keyPressed(QString)), this, SLOT(keyPressed(QString)));
-    connect(canvas2D, SIGNAL(keyReleased(QString)), this, SLOT(keyReleased(QString)));
-
-    connect(canvas3D, SIGNAL(mouseMoved(int,int)), this, SLOT(mouseMoved(int,int)));
-    connect(canvas3D, SIGNAL(mousePressed(int,int)), this, SLOT(mousePressed(int,int)));
-    connect(canvas3D, SIGNAL(mouseReleased(int,int)), this, SLOT(mouseReleased(int,int)));
-    connect(canvas3D, SIGNAL(wheelMoved(int)), this, SLOT(wheelMoved(int)));
-    connect(canvas3D, SIGNAL(keyPressed(QString)), this, SLOT(keyPressed(QString)));
-    connect(canvas3D, SIGNAL(keyReleased(QString)), this, SLOT(keyReleased(QString)));
+    // Eingaben werden gesammelt und vor dem nächsten Bild gemeinsam übergeben
+    canvas2D->setInputQueue(&inputQueue);
+    canvas3D->setInputQueue(&inputQueue);
 
     connect(ui->buttonFullscreen, SIGNAL(toggled(bool)), this, SLOT(toggleFullscreen()));
 
+    QMenu* captureMenu = new QMenu(this);
+    captureMenu->addAction("Record PNG sequence", this, SLOT(startCapturePNG()));
+    captureMenu->addAction("Record PPM sequence", this, SLOT(startCapturePPM()));
+    captureMenu->addAction("Record Y4M video", this, SLOT(startCaptureY4M()));
+    captureMenu->addSeparator();
+    captureMenu->addAction("Stop recording", this, SLOT(stopCapture()));
+    captureMenu->addSeparator();
+    captureMenu->addAction("Record profiler trace", this, SLOT(startTrace()));
+    captureMenu->addAction("Stop profiler trace", this, SLOT(stopTrace()));
+    ui->buttonCapture->setMenu(captureMenu);
+
+    QMenu* pacingMenu = new QMenu(this);
+    QActionGroup* pacingGroup = new QActionGroup(this);
+    pacingGroup->addAction(pacingMenu->addAction("30 Frames/s"));
+    pacingGroup->addAction(pacingMenu->addAction("60 Frames/s"));
+    pacingGroup->addAction(pacingMenu->addAction(QString("Display refresh (%1 Hz)").arg(qRound(frameScheduler.displayRate()))));
+    pacingGroup->addAction(pacingMenu->addAction("As fast as possible"));
+    foreach(QAction* action, pacingGroup->actions())
+        action->setCheckable(true);
+    pacingGroup->actions().at(2)->setChecked(true);
+    connect(pacingGroup, SIGNAL(triggered(QAction*)), this, SLOT(selectPacing(QAction*)));
+    ui->buttonPacing->setMenu(pacingMenu);
+
     populateMeshList();
     populateTextureList();
 
@@ -110,6 +148,7 @@ MainWindow::MainWindow(QWidget *parent) :
 
 MainWindow::~MainWindow()
 {
+    renderThread->stopRendering();
     clearElements();
 
     if(currentLecture)
@@ -121,6 +160,7 @@ MainWindow::~MainWindow()
     {
         delete r;
     }
+    delete renderThread;
     delete ui;
 }
 
@@ -129,7 +169,7 @@ void MainWindow::addCheckBox(QString label, bool defaultValue, bool& mappedValue
     mappedValue = defaultValue;
     QCheckBox* element = new QCheckBox(label);
     element->setChecked(defaultValue);
-    SlotMapper* map = new SlotMapper(mappedValue);
+    SlotMapper* map = new SlotMapper(mappedValue, dispatchToLecture);
     connect(element, SIGNAL(toggled(bool)), map, SLOT(mapBool(bool)));
     connect(map, SIGNAL(boolChanged(bool)), element, SLOT(setChecked(bool)));
     connect(&guiUpdate, SIGNAL(timeout()), map, SLOT(mapToWidget()));
@@ -144,7 +184,7 @@ void MainWindow::addColorSelector(QString label, QVector3D defaultValue, QVector
 {
     mappedValue = defaultValue;
     QPushButton* element = new QPushButton(label);
-    SlotMapper* map = new SlotMapper(mappedValue);
+    SlotMapper* map = new SlotMapper(mappedValue, dispatchToLecture);
     QColorDialog* dialog = new QColorDialog();
     dialog->setWindowTitle(QString("Change color: ") + label);
 
@@ -170,7 +210,7 @@ void MainWindow::addSlider(QString label, int minimalValue, int maximalValue, in
     element->setMinimum(minimalValue);
     element->setMaximum(maximalValue);
     element->setValue(defaultValue);
-    SlotMapper* map = new SlotMapper(mappedValue);
+    SlotMapper* map = new SlotMapper(mappedValue, dispatchToLecture);
     connect(element, SIGNAL(valueChanged(int)), map, SLOT(mapInteger(int)));
     connect(map, SIGNAL(intChanged(int)), element, SLOT(setValue(int)));
     connect(&guiUpdate, SIGNAL(timeout()), map, SLOT(mapToWidget()));
@@ -185,7 +225,7 @@ void MainWindow::addLabel(QString defaultValue, QString& mappedValue, QString st
 {
     mappedValue = defaultValue;
     QLabel* element = new QLabel(defaultValue);
-    SlotMapper* map = new SlotMapper(mappedValue);
+    SlotMapper* map = new SlotMapper(mappedValue, dispatchToLecture);
     connect(map, SIGNAL(stringChanged(QString)), element, SLOT(setText(QString)));
     connect(&guiUpdate, SIGNAL(timeout()), map, SLOT(mapToWidget()));
 
@@ -207,7 +247,7 @@ void MainWindow::addLabel(QString value, QString styleSheet)
 void MainWindow::addButton(QString label, std::function<void()> fun)
 {
     QPushButton* button = new QPushButton(label);
-    EventMapper* map = new ActionEventMapper(fun);
+    EventMapper* map = new ActionEventMapper(fun, dispatchToLecture);
 
     connect(button, SIGNAL(clicked()), map, SLOT(mapEvent()));
 
@@ -219,7 +259,7 @@ void MainWindow::addButton(QString label, std::function<void()> fun)
 void MainWindow::addDropdownList(QString entries, unsigned int defaultIndex, std::function<void(int)> fun)
 {
     QComboBox* combo = new QComboBox();
-    EventMapper* map = new SelectionEventMapper(fun);
+    EventMapper* map = new SelectionEventMapper(fun, dispatchToLecture);
 
     QStringList entryList = entries.split(';');
     combo->addItems(entryList);
@@ -301,6 +341,7 @@ void MainWindow::activateLecture(int index)
 
     if(currentLecture)
     {
+        renderThread->stopRendering();
         clearElements();
         currentLecture->deinitialize();
     }
@@ -320,6 +361,14 @@ void MainWindow::activateLecture(int index)
 
 
     enableGL = currentLecture->usesOpenGL();
+    ui->buttonCapture->setEnabled(!enableGL);
+    canvas2D->setHDREnabled(!currentLecture->usesOpenGL() && currentLecture->usesHDR());
+    canvas2D->setToneMapping(GdvCanvas::ToneMapClamp);
+    canvas2D->setClipRect(QRect());
+    canvas2D->setDepthBufferEnabled(!currentLecture->usesOpenGL() && currentLecture->usesDepthBuffer());
+    canvas2D->setSampleCount(!currentLecture->usesOpenGL() && !currentLecture->usesTiles() ? currentLecture->sampleCount() : 1);
+    canvas2D->setTargetFrameRate(!currentLecture->usesOpenGL() ? currentLecture->targetFrameRate() : 0.0f);
+    tileRenderer.invalidate();
 
     currentLecture->setupGUI(*this);
     currentLecture->initialize();
@@ -328,83 +377,111 @@ void MainWindow::activateLecture(int index)
     if(currentLecture->usesOpenGL())
         currentLecture->sizeChanged(canvas3D->width(), canvas3D->height());
     else
-        currentLecture->sizeChanged(canvas2D->width(), canvas2D->height());
+    {
+        canvas2D->setOutputSize(canvas2D->width(), canvas2D->height());
+        currentLecture->sizeChanged(canvas2D->bufferSize().width(), canvas2D->bufferSize().height());
+    }
 
     // Reload the current mesh
     activateMesh(ui->comboMesh->currentIndex());
     activateTexture(ui->comboTexture->currentIndex());
     perfCount.reset();
+
+    frameScheduler.reset();
+    inputQueue.clear();
+
+    if(!currentLecture->usesOpenGL() && currentLecture->usesRenderThread())
+    {
+        redrawUpdate.stop();
+        renderThread->startRendering(currentLecture);
+    }
+    else
+        redrawUpdate.start(0);
 }
 
 void MainWindow::redraw()
 {
+    // Im Render-Thread-Modus plant der Render-Thread selbst
+    if(renderThread->isRendering())
+        return;
+
     if(currentLecture && !currentLecture->usesOpenGL())
     {
+        frameScheduler.frameStarted();
+        deliverInput();
         perfCount.startFrame();
-        currentLecture->render(*canvas2D);
+        {
+            GDV_PROFILE_ZONE("render");
+            if(currentLecture->usesTiles())
+                tileRenderer.renderFrame(*currentLecture, *canvas2D);
+            else
+                currentLecture->render(*canvas2D);
+        }
         perfCount.stopFrame();
 
-        canvas2D->repaint();
+        if(canvas2D->adaptResolution(perfCount.lastFrameTime()))
+            currentLecture->sizeChanged(canvas2D->bufferSize().width(), canvas2D->bufferSize().height());
+
+        canvas2D->presentFrame(true);
     }
 
     if(currentLecture && currentLecture->usesOpenGL())
     {
+        frameScheduler.frameStarted();
+        deliverInput();
         perfCount.startFrame();
-        currentLecture->render(*canvas3D);
+        {
+            GDV_PROFILE_ZONE("render");
+            currentLecture->render(*canvas3D);
+        }
         perfCount.stopFrame();
 
         canvas3D->repaint();
     }
+
+    redrawUpdate.start(frameScheduler.nextFrameDelay());
 }
 
 void MainWindow::resized(int width, int height)
 {
     if(width > 0 && height > 0)
     {
-        if(currentLecture)
+        if(renderThread->isRendering())
+        {
+            // Puffer und Abgabe werden zwischen zwei Bildern angepasst
+            RendererBase* lecture = currentLecture;
+            if(sender() == canvas2D)
+            {
+                renderThread->post([=]()
+                {
+                    canvas2D->setOutputSize(width, height);
+                    lecture->sizeChanged(canvas2D->bufferSize().width(), canvas2D->bufferSize().height());
+                });
+            }
+        }
+        else if(currentLecture && sender() == canvas2D)
+        {
+            // Bei dynamischer Auflösung ist der Puffer kleiner als das Widget
+            currentLecture->sizeChanged(canvas2D->bufferSize().width(), canvas2D->bufferSize().height());
+        }
+        else if(currentLecture)
             currentLecture->sizeChanged(width, height);
 
         perfCount.reset();
 
-        fullscreenControls->setGeometry(QRect(width-250,0, 250, 48));
+        fullscreenControls->setGeometry(QRect(width-560,0, 560, 48));
 
     }
 }
 
-void MainWindow::mousePressed(int x, int y)
-{
-    if(currentLecture)
-        currentLecture->mousePressed(x, y);
-}
-
-void MainWindow::mouseReleased(int x, int y)
+void MainWindow::deliverInput()
 {
-    if(currentLecture)
-        currentLecture->mouseReleased(x, y);
-}
-
-void MainWindow::mouseMoved(int x, int y)
-{
-    if(currentLecture)
-        currentLecture->mouseMoved(x, y);
-}
-
-void MainWindow::wheelMoved(int delta)
-{
-    if(currentLecture)
-        currentLecture->wheelMoved(delta);
-}
+    GDV_PROFILE_ZONE("input");
 
-void MainWindow::keyPressed(QString key)
-{
-    if(currentLecture)
-        currentLecture->keyPressed(key);
-}
-
-void MainWindow::keyReleased(QString key)
-{
-    if(currentLecture)
-        currentLecture->keyReleased(key);
+    // Im Render-Thread-Modus übernimmt das RenderThread::run
+    inputQueue.take(inputBatch);
+    if(!inputBatch.isEmpty())
+        currentLecture->inputEvents(inputBatch);
 }
 
 void MainWindow::activateMesh(int index)
@@ -434,7 +511,10 @@ void MainWindow::activateMesh(int index)
     {
         qDebug() << "Changing mesh to" << ui->comboMesh->itemText(index)
                  << "containing" << meshes[index].faces().size() << "faces.";
-        currentLecture->meshChanged(meshes[index].faces());
+
+        RendererBase* lecture = currentLecture;
+        const MeshLoader* mesh = &meshes.at(index);
+        renderThread->post([=]() { lecture->meshChanged(mesh->faces()); });
     }
 
 }
@@ -465,7 +545,11 @@ void MainWindow::activateTexture(int index)
         if(currentLecture->usesOpenGL())
             currentLecture->textureChanged(QGLWidget::convertToGLFormat(textures[index]));
         else
-            currentLecture->textureChanged(textures[index]);
+        {
+            RendererBase* lecture = currentLecture;
+            QImage texture = textures[index];
+            renderThread->post([=]() { lecture->textureChanged(texture); });
+        }
     }
 }
 
@@ -528,13 +612,31 @@ void MainWindow::updateFullscreenBar()
                                         "QToolButton:checked { background-color: qlineargradient(x1: 0, y1: 0, x2: 0, y2: 1, stop: 0 #dadbde, stop: 1 #f6f7fa);}");
     ui->labelFPS->setStyleSheet("border:0px solid transparent; font-weight:bold; background-color:transparent;");
 
-    fullscreenControls->setGeometry(QRect(wd->width()-250,0, 250, 48));
+    fullscreenControls->setGeometry(QRect(wd->width()-560,0, 560, 48));
 }
 
 void MainWindow::showFPS()
 {
     int fps = round(perfCount.averageFPS());
-    ui->labelFPS->setText(QString::number(fps) + QString(" Frames/s"));
+    QString text = QString::number(fps) + QString(" Frames/s");
+
+    // Schwankung der Abstände zwischen zwei Bildern
+    if(fps > 0)
+        text += QString(" (±%1 ms)").arg(frameScheduler.intervalJitter(), 0, 'f', 1);
+
+    if(frameCapture.isCapturing())
+        text += QString(" - REC %1 (%2 dropped)").arg(frameCapture.capturedFrames()).arg(frameCapture.droppedFrames());
+
+    // Im eingeschwungenen Zustand sollte render ohne neuen Speicher auskommen
+    if(AllocationTracker::isAvailable())
+        text += QString(" - %1 allocs (%2 KB)/frame").arg(qRound(perfCount.averageAllocations()))
+                .arg(perfCount.averageAllocatedBytes() / 1024.0f, 0, 'f', 1);
+
+    if(Profiler::isRecording())
+        text += QString(" - TRACE %1 zones").arg(Profiler::instance().recordedZones());
+
+    ui->labelFPS->setText(text);
+    frameGraph->refresh();
 
     if(fps < 5)
         ui->labelFPS->setStyleSheet("color:#A00;");
@@ -575,3 +677,87 @@ void MainWindow::toggleFullscreen()
 
     updateFullscreenBar();
 }
+
+void MainWindow::startCapturePNG()
+{
+    startCapture("png");
+}
+
+void MainWindow::startCapturePPM()
+{
+    startCapture("ppm");
+}
+
+void MainWindow::startCaptureY4M()
+{
+    startCapture("y4m");
+}
+
+void MainWindow::stopCapture()
+{
+    if(!frameCapture.isCapturing())
+        return;
+
+    frameCapture.stop();
+    qDebug() << "Capture finished:" << frameCapture.capturedFrames() << "frames written,"
+             << frameCapture.droppedFrames() << "dropped.";
+}
+
+void MainWindow::startCapture(const QString& suffix)
+{
+    // Bildfolgen landen als captures/<Abgabe>_<Zeit>_000000.png usw. im Build-Verzeichnis
+    const QString fileName = QString("captures/%1_%2.%3")
+            .arg(ui->comboClass->currentText(),
+                 QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"),
+                 suffix);
+
+    if(!frameCapture.start(fileName))
+        QMessageBox::warning(this, "Recording failed", frameCapture.errorString());
+}
+
+void MainWindow::startTrace()
+{
+    Profiler::instance().start();
+}
+
+void MainWindow::stopTrace()
+{
+    Profiler& profiler = Profiler::instance();
+    if(!profiler.isRecording())
+        return;
+
+    profiler.stop();
+
+    // Landet als traces/<Abgabe>_<Zeit>.json im Build-Verzeichnis, siehe chrome://tracing bzw. ui.perfetto.dev
+    const QString fileName = QString("traces/%1_%2.json")
+            .arg(ui->comboClass->currentText(),
+                 QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+
+    if(!profiler.exportChromeTrace(fileName))
+        QMessageBox::warning(this, "Profiler trace failed", profiler.errorString());
+    else
+        qDebug() << "Profiler trace written to" << fileName << "-" << profiler.recordedZones() << "zones,"
+                 << profiler.droppedZones() << "dropped.";
+}
+
+void MainWindow::selectPacing(QAction* action)
+{
+    const int index = action->actionGroup()->actions().indexOf(action);
+
+    if(index == 0)
+        frameScheduler.setPolicy(FrameScheduler::PacingFixedRate, 30.0f);
+    else if(index == 1)
+        frameScheduler.setPolicy(FrameScheduler::PacingFixedRate, 60.0f);
+    else if(index == 2)
+        frameScheduler.setPolicy(FrameScheduler::PacingDisplayRate);
+    else
+        frameScheduler.setPolicy(FrameScheduler::PacingAsFastAsPossible);
+
+    perfCount.reset();
+}
+
+void MainWindow::presentRenderedFrame()
+{
+    canvas2D->presentFrame();
+    frameScheduler.framePresented();
+}
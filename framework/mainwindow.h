@@ -22,6 +22,10 @@
 #include "interfaces/GdvGui.h"
 #include "meshloader.h"
 #include "performancemonitor.h"
+#include "tilerenderer.h"
+#include "framecapture.h"
+#include "framescheduler.h"
+#include "inputqueue.h"
 
 namespace Ui {
     class MainWindow;
@@ -31,6 +35,9 @@ class SlotMapper;
 class EventMapper;
 class GdvCanvas2D;
 class GdvCanvas3D;
+class RenderThread;
+class FrameGraph;
+class QAction;
 
 /**
  * @brief Die MainWindow Klasse
@@ -67,12 +74,6 @@ protected slots:
     void activateLecture(int index);
     void redraw();
     void resized(int width, int height);
-    void mousePressed(int, int);
-    void mouseReleased(int, int);
-    void mouseMoved(int, int);
-    void wheelMoved(int);
-    void keyPressed(QString);
-    void keyReleased(QString);
 
     void activateMesh(int index);
     void activateTexture(int index);
@@ -81,11 +82,23 @@ protected slots:
 
     void toggleFullscreen();
 
+    void startCapturePNG();
+    void startCapturePPM();
+    void startCaptureY4M();
+    void stopCapture();
+    void startTrace();
+    void stopTrace();
+
+    void selectPacing(QAction* action);
+    void presentRenderedFrame();
+
 private:
 
     void populateMeshList();
     void populateTextureList();
     void updateFullscreenBar();
+    void startCapture(const QString& suffix);
+    void deliverInput();
 
     RendererBase* currentLecture;
     QVector<RendererBase*> allLectures;
@@ -102,10 +115,18 @@ private:
     QTimer guiUpdate;
     QTimer redrawUpdate;
     PerformanceMonitor perfCount;
+    TileRenderer tileRenderer;
+    RenderThread* renderThread;
+    FrameCapture frameCapture;
+    FrameScheduler frameScheduler;
+    InputQueue inputQueue;
+    QVector<InputEvent> inputBatch;
+    std::function<void(const std::function<void()>&)> dispatchToLecture;
 
     GdvCanvas2D* canvas2D;
     GdvCanvas3D* canvas3D;
     QWidget*     fullscreenControls;
+    FrameGraph*  frameGraph;
 
     bool enableGL;
 
@@ -8,6 +8,7 @@
 
 
 #include "meshloader.h"
+#include "profiler.h"
 #include <QDebug>
 
 #include <QFile>
@@ -72,6 +73,8 @@ MeshLoader::MeshLoader()
 
 void MeshLoader::parseFile()
 {
+    GDV_PROFILE_ZONE("mesh load");
+
     _valid = false;
     _faces.clear();
 
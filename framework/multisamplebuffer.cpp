@@ -0,0 +1,582 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "multisamplebuffer.h"
+#include "bufferaccess.h"
+#include "pixelconversion.h"
+#include "workerpool.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    const float Far = std::numeric_limits<float>::infinity();
+
+    // Sample-Positionen in 1/16 Pixel relativ zur Pixelmitte (wie die
+    // Standardmuster von Direct3D): gedrehte Raster, sodass fast waagerechte
+    // und fast senkrechte Kanten gleichermaßen viele Stufen erhalten
+    struct Offset
+    {
+        int x, y;
+    };
+
+    const Offset Pattern2[2] = { { 4, 4 }, { -4, -4 } };
+    const Offset Pattern4[4] = { { -2, -6 }, { 6, -2 }, { -6, 2 }, { 2, 6 } };
+    const Offset Pattern8[8] = { { 1, -3 }, { -1, 3 }, { 5, 1 }, { -3, -5 },
+                                 { -5, 5 }, { -7, -1 }, { 3, 7 }, { 7, -7 } };
+
+    const Offset* pattern(int samples)
+    {
+        return samples == 2 ? Pattern2 : samples == 4 ? Pattern4 : Pattern8;
+    }
+
+    int log2(int samples)
+    {
+        return samples == 2 ? 1 : samples == 4 ? 2 : 3;
+    }
+
+    // Box-Filter für die Pixel first bis end-1 einer Zeile, Summe je Kanal in 16 Bit
+    void boxRow(const QRgb* const* rows, int count, int shift, QRgb* target, int first, int end)
+    {
+        int x = first;
+
+#ifdef GDV_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi16(static_cast<short>(1 << (shift - 1)));
+        const __m128i bits = _mm_cvtsi32_si128(shift);
+
+        for(; x + 4 <= end; x += 4)
+        {
+            __m128i low = round, high = round;
+            for(int s = 0; s < count; s++)
+            {
+                const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[s] + x));
+                low = _mm_add_epi16(low, _mm_unpacklo_epi8(pixels, zero));
+                high = _mm_add_epi16(high, _mm_unpackhi_epi8(pixels, zero));
+            }
+
+            low = _mm_srl_epi16(low, bits);
+            high = _mm_srl_epi16(high, bits);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + x), _mm_packus_epi16(low, high));
+        }
+#endif
+
+        for(; x < end; x++)
+        {
+            int red = 1 << (shift - 1), green = red, blue = red;
+            for(int s = 0; s < count; s++)
+            {
+                red += qRed(rows[s][x]);
+                green += qGreen(rows[s][x]);
+                blue += qBlue(rows[s][x]);
+            }
+            target[x] = qRgb(red >> shift, green >> shift, blue >> shift);
+        }
+    }
+
+    void boxRow(const float* const* rows, int count, float* target, int first, int end)
+    {
+        const float scale = 1.0f / count;
+
+        for(int x = first; x < end; x++)
+        {
+#ifdef GDV_SSE2
+            __m128 sum = _mm_loadu_ps(rows[0] + 4 * x);
+            for(int s = 1; s < count; s++)
+                sum = _mm_add_ps(sum, _mm_loadu_ps(rows[s] + 4 * x));
+            _mm_storeu_ps(target + 4 * x, _mm_mul_ps(sum, _mm_set1_ps(scale)));
+#else
+            for(int k = 0; k < 4; k++)
+            {
+                float sum = rows[0][4 * x + k];
+                for(int s = 1; s < count; s++)
+                    sum += rows[s][4 * x + k];
+                target[4 * x + k] = sum * scale;
+            }
+#endif
+        }
+    }
+
+#ifdef GDV_SSE2
+    // Tent-Filter für 4 * Blocks Pixel ab x > 0 in 8.8-Festkomma: sources[n] zeigt auf
+    // die Zeile des Beitrags n, verschoben um dessen dx + 1; weights[n] ist dessen Gewicht
+    template<int Blocks>
+    void tentPixels(const QRgb* const* sources, const __m128i* weights, int count, int x, QRgb* target)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i low[Blocks], high[Blocks];
+        for(int b = 0; b < Blocks; b++)
+            low[b] = high[b] = _mm_set1_epi16(128);
+
+        for(int n = 0; n < count; n++)
+        {
+            const __m128i weight = weights[n];
+            for(int b = 0; b < Blocks; b++)
+            {
+                const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sources[n] + x - 1 + 4 * b));
+
+                // (Wert * 256) * Gewicht / 65536
+                low[b] = _mm_add_epi16(low[b], _mm_mulhi_epu16(_mm_unpacklo_epi8(zero, pixels), weight));
+                high[b] = _mm_add_epi16(high[b], _mm_mulhi_epu16(_mm_unpackhi_epi8(zero, pixels), weight));
+            }
+        }
+
+        for(int b = 0; b < Blocks; b++)
+        {
+            const __m128i result = _mm_packus_epi16(_mm_srli_epi16(low[b], 8), _mm_srli_epi16(high[b], 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + x + 4 * b), _mm_or_si128(result, _mm_set1_epi32(0xff000000)));
+        }
+    }
+#endif
+}
+
+MultisampleBuffer::MultisampleBuffer() :
+    w(0), h(0), samples(1), pixelFormat(GdvCanvas::FormatRGB32), filter(ResolveBox)
+{
+}
+
+void MultisampleBuffer::resize(unsigned int width, unsigned int height, int samples, GdvCanvas::PixelFormat format, bool depth)
+{
+    Q_ASSERT(samples == 2 || samples == 4 || samples == 8);
+
+    w = width;
+    h = height;
+    this->samples = samples;
+    pixelFormat = format;
+
+    const size_t values = static_cast<size_t>(w) * h * samples;
+
+    if(format == GdvCanvas::FormatRGB32)
+    {
+        rgbValues.assign(values, qRgb(0, 0, 0));
+        floatValues.release();
+    }
+    else
+    {
+        rgbValues.release();
+        floatValues.assign(values * 4, 0.0f);
+        for(size_t n = 3; n < floatValues.size(); n += 4)
+            floatValues[n] = 1.0f;
+    }
+
+    if(depth)
+        depthValues.assign(values, Far);
+    else
+        depthValues.release();
+
+    // Gewichte des Tent-Filters: (1 - |dx|) * (1 - |dy|) für alle Samples im
+    // Abstand von weniger als einem Pixel zur Mitte, in der Summe 1
+    taps.clear();
+    const Offset* offsets = pattern(samples);
+    float total = 0.0f;
+
+    for(int dy = -1; dy <= 1; dy++)
+    {
+        for(int dx = -1; dx <= 1; dx++)
+        {
+            for(int s = 0; s < samples; s++)
+            {
+                const float distanceX = std::fabs(dx + offsets[s].x / 16.0f);
+                const float distanceY = std::fabs(dy + offsets[s].y / 16.0f);
+                const float weight = qMax(0.0f, 1.0f - distanceX) * qMax(0.0f, 1.0f - distanceY);
+                if(weight <= 0.0f)
+                    continue;
+
+                const Tap tap = { dx, dy, s, weight, 0 };
+                taps.push_back(tap);
+                total += weight;
+            }
+        }
+    }
+
+    for(size_t n = 0; n < taps.size(); n++)
+    {
+        taps[n].weight /= total;
+        taps[n].fixedWeight = static_cast<unsigned short>(taps[n].weight * 65535.0f + 0.5f);
+    }
+
+    modified.clear();
+    modified.add(0, 0, w, h);
+    depthWritten.clear();
+}
+
+QPointF MultisampleBuffer::samplePosition(int sample) const
+{
+    const Offset& offset = pattern(samples)[sample];
+    return QPointF((8 + offset.x) / 16.0, (8 + offset.y) / 16.0);
+}
+
+GdvCanvas::BufferMapping MultisampleBuffer::plane(int sample) const
+{
+    GdvCanvas::BufferMapping mapping;
+    mapping.width = w;
+    mapping.height = h;
+    mapping.format = pixelFormat;
+
+    const size_t offset = static_cast<size_t>(sample) * w * h;
+
+    if(pixelFormat == GdvCanvas::FormatRGB32)
+    {
+        mapping.bits = const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(rgbValues.data() + offset));
+        mapping.stride = w * sizeof(QRgb);
+    }
+    else
+    {
+        mapping.bits = const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(floatValues.data() + 4 * offset));
+        mapping.stride = w * 4 * sizeof(float);
+    }
+
+    return mapping;
+}
+
+void MultisampleBuffer::write(unsigned int x, unsigned int y, unsigned int mask, const QVector3D& color)
+{
+    Q_ASSERT(x < w && y < h);
+
+    const size_t planeSize = static_cast<size_t>(w) * h;
+    const size_t index = static_cast<size_t>(y) * w + x;
+
+    if(pixelFormat == GdvCanvas::FormatRGB32)
+    {
+        const QRgb value = PixelConversion::toRgb(color);
+        for(int s = 0; s < samples; s++)
+        {
+            if(mask & (1u << s))
+                rgbValues[s * planeSize + index] = value;
+        }
+        return;
+    }
+
+    for(int s = 0; s < samples; s++)
+    {
+        if(!(mask & (1u << s)))
+            continue;
+
+        float* pixel = &floatValues[4 * (s * planeSize + index)];
+        pixel[0] = color.x();
+        pixel[1] = color.y();
+        pixel[2] = color.z();
+        pixel[3] = 1.0f;
+    }
+}
+
+void MultisampleBuffer::fillSpan(unsigned int x, unsigned int y, unsigned int length, unsigned int mask, const QVector3D& color)
+{
+    Q_ASSERT(x + length <= w && y < h);
+
+    for(int s = 0; s < samples; s++)
+    {
+        if(mask & (1u << s))
+            BufferAccess::fillSpan(plane(s), x, y, length, color);
+    }
+}
+
+void MultisampleBuffer::storeRow(unsigned int x, unsigned int y, unsigned int length, const float* rgb)
+{
+    BufferAccess::storeRow(plane(0), x, y, length, rgb);
+    broadcast(QRect(x, y, length, 1));
+}
+
+void MultisampleBuffer::storeRow(unsigned int x, unsigned int y, unsigned int length, const QRgb* pixels)
+{
+    BufferAccess::storeRow(plane(0), x, y, length, pixels);
+    broadcast(QRect(x, y, length, 1));
+}
+
+void MultisampleBuffer::blend(unsigned int x, unsigned int y, const QVector3D& color, float alpha)
+{
+    Q_ASSERT(x < w && y < h);
+
+    const size_t planeSize = static_cast<size_t>(w) * h;
+    const size_t index = static_cast<size_t>(y) * w + x;
+    const float keep = 1.0f - alpha;
+
+    if(pixelFormat == GdvCanvas::FormatRGB32)
+    {
+        const QRgb value = PixelConversion::toRgb(color);
+        for(int s = 0; s < samples; s++)
+        {
+            QRgb& pixel = rgbValues[s * planeSize + index];
+            pixel = qRgb(qRed(pixel) * keep + qRed(value) * alpha + 0.5f,
+                         qGreen(pixel) * keep + qGreen(value) * alpha + 0.5f,
+                         qBlue(pixel) * keep + qBlue(value) * alpha + 0.5f);
+        }
+        return;
+    }
+
+    for(int s = 0; s < samples; s++)
+    {
+        float* pixel = &floatValues[4 * (s * planeSize + index)];
+        pixel[0] += (color.x() - pixel[0]) * alpha;
+        pixel[1] += (color.y() - pixel[1]) * alpha;
+        pixel[2] += (color.z() - pixel[2]) * alpha;
+    }
+}
+
+void MultisampleBuffer::broadcast(const QRect& area)
+{
+    const QRect clipped = area.intersected(QRect(0, 0, w, h));
+    if(clipped.isEmpty())
+        return;
+
+    const GdvCanvas::BufferMapping source = plane(0);
+    const size_t pixelSize = pixelFormat == GdvCanvas::FormatRGB32 ? sizeof(QRgb) : 4 * sizeof(float);
+
+    // Ganze Zeilen liegen direkt hintereinander und werden am Stück kopiert
+    const bool whole = clipped.width() == static_cast<int>(w);
+    const int rows = whole ? 1 : clipped.height();
+    const size_t bytes = (whole ? static_cast<size_t>(w) * clipped.height() : clipped.width()) * pixelSize;
+    const size_t offset = clipped.x() * pixelSize;
+
+    for(int s = 1; s < samples; s++)
+    {
+        const GdvCanvas::BufferMapping target = plane(s);
+        for(int row = clipped.top(); row < clipped.top() + rows; row++)
+            memcpy(target.bits + row * target.stride + offset, source.bits + row * source.stride + offset, bytes);
+    }
+}
+
+void MultisampleBuffer::clear(const QRect& area, const QVector3D& color)
+{
+    const QRect clipped = area.intersected(QRect(0, 0, w, h));
+    if(clipped.isEmpty())
+        return;
+
+    WorkerPool::instance().run(samples, [&](int s)
+    {
+        const GdvCanvas::BufferMapping target = plane(s);
+
+        if(pixelFormat == GdvCanvas::FormatRGB32 && clipped.width() == static_cast<int>(w))
+        {
+            PixelConversion::fillRow(target.rgbLine(clipped.top()), PixelConversion::toRgb(color), w * clipped.height());
+            return;
+        }
+
+        for(int row = clipped.top(); row <= clipped.bottom(); row++)
+            BufferAccess::fillSpan(target, clipped.x(), row, clipped.width(), color);
+    });
+}
+
+void MultisampleBuffer::clearDepth(const QRect& area)
+{
+    if(depthValues.empty() || depthWritten.isEmpty())
+        return;
+
+    // Nur löschen, was seit dem letzten Löschen beschrieben wurde
+    const QRect written = depthWritten.toRect();
+    const QRect cleared = area.intersected(written);
+    if(cleared.isEmpty())
+        return;
+
+    for(int s = 0; s < samples; s++)
+    {
+        for(int row = cleared.top(); row <= cleared.bottom(); row++)
+        {
+            float* line = depthValues.data() + (static_cast<size_t>(s) * h + row) * w;
+            std::fill(line + cleared.left(), line + cleared.right() + 1, Far);
+        }
+    }
+
+    if(cleared == written)
+        depthWritten.clear();
+}
+
+void MultisampleBuffer::setResolveFilter(ResolveFilter filter)
+{
+    if(filter == this->filter)
+        return;
+
+    this->filter = filter;
+    modified.add(0, 0, w, h);
+}
+
+QRect MultisampleBuffer::resolve(const GdvCanvas::BufferMapping& target, const QRect& area) const
+{
+    Q_ASSERT(target.width == w && target.height == h && target.format == pixelFormat);
+
+    const QRect bounds(0, 0, w, h);
+    QRect region = area.intersected(bounds);
+
+    // Der Tent-Filter verteilt jedes Sample auch auf die Nachbarpixel
+    if(filter == ResolveTent && !region.isEmpty())
+        region = region.adjusted(-1, -1, 1, 1).intersected(bounds);
+
+    if(region.isEmpty())
+        return QRect();
+
+    const int bandHeight = 16;
+    const int bands = (region.height() + bandHeight - 1) / bandHeight;
+
+    WorkerPool::instance().run(bands, [&](int band)
+    {
+        const int firstRow = region.top() + band * bandHeight;
+        resolveRows(target, region, firstRow, qMin(firstRow + bandHeight, region.bottom() + 1));
+    });
+
+    return region;
+}
+
+void MultisampleBuffer::resolveRows(const GdvCanvas::BufferMapping& target, const QRect& area, int firstRow, int lastRow) const
+{
+    const size_t planeSize = static_cast<size_t>(w) * h;
+    const int first = area.left();
+    const int end = area.right() + 1;
+
+    for(int y = firstRow; y < lastRow; y++)
+    {
+        if(filter == ResolveBox)
+        {
+            if(pixelFormat == GdvCanvas::FormatRGB32)
+            {
+                const QRgb* rows[MaxSamples];
+                for(int s = 0; s < samples; s++)
+                    rows[s] = rgbValues.data() + s * planeSize + static_cast<size_t>(y) * w;
+
+                boxRow(rows, samples, log2(samples), target.rgbLine(y), first, end);
+            }
+            else
+            {
+                const float* rows[MaxSamples];
+                for(int s = 0; s < samples; s++)
+                    rows[s] = floatValues.data() + 4 * (s * planeSize + static_cast<size_t>(y) * w);
+
+                boxRow(rows, samples, target.floatLine(y), first, end);
+            }
+            continue;
+        }
+
+        // Tent: Zeilen y-1, y und y+1 (am Rand wiederholt) aller Samples
+        const int neighbours[3] = { y > 0 ? y - 1 : 0, y, y + 1 < static_cast<int>(h) ? y + 1 : y };
+        size_t rowOffset[3][MaxSamples];
+        for(int k = 0; k < 3; k++)
+            for(int s = 0; s < samples; s++)
+                rowOffset[k][s] = s * planeSize + static_cast<size_t>(neighbours[k]) * w;
+
+#ifdef GDV_SSE2
+        // Zeiger und Gewichte der Beiträge einmal je Zeile, nicht je Pixel
+        const int tapCount = static_cast<int>(taps.size());
+        const QRgb* sources[9 * MaxSamples];
+        __m128i weights[9 * MaxSamples];
+        int blockEnd = 0;
+
+        if(pixelFormat == GdvCanvas::FormatRGB32)
+        {
+            for(int n = 0; n < tapCount; n++)
+            {
+                sources[n] = rgbValues.data() + rowOffset[taps[n].dy + 1][taps[n].sample] + taps[n].dx + 1;
+                weights[n] = _mm_set1_epi16(static_cast<short>(taps[n].fixedWeight));
+            }
+
+            // Am Stück nur, solange alle Nachbarn in der Zeile liegen
+            blockEnd = qMin(end, static_cast<int>(w) - 1);
+        }
+#endif
+
+        for(int x = first; x < end; x++)
+        {
+#ifdef GDV_SSE2
+            if(x > 0 && x + 8 <= blockEnd)
+            {
+                tentPixels<2>(sources, weights, tapCount, x, target.rgbLine(y));
+                x += 7;
+                continue;
+            }
+
+            if(x > 0 && x + 4 <= blockEnd)
+            {
+                tentPixels<1>(sources, weights, tapCount, x, target.rgbLine(y));
+                x += 3;
+                continue;
+            }
+#endif
+
+            const int columns[3] = { x > 0 ? x - 1 : 0, x, x + 1 < static_cast<int>(w) ? x + 1 : x };
+
+#ifdef GDV_SSE2
+            __m128 sum = _mm_setzero_ps();
+
+            if(pixelFormat == GdvCanvas::FormatRGB32)
+            {
+                const __m128i zero = _mm_setzero_si128();
+                for(size_t n = 0; n < taps.size(); n++)
+                {
+                    const Tap& tap = taps[n];
+                    const QRgb value = rgbValues[rowOffset[tap.dy + 1][tap.sample] + columns[tap.dx + 1]];
+                    const __m128i channels = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero), zero);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(channels), _mm_set1_ps(tap.weight)));
+                }
+
+                __m128i pixel = _mm_cvtps_epi32(sum);
+                pixel = _mm_packs_epi32(pixel, pixel);
+                pixel = _mm_packus_epi16(pixel, pixel);
+                target.rgbLine(y)[x] = static_cast<QRgb>(_mm_cvtsi128_si32(pixel)) | 0xff000000;
+            }
+            else
+            {
+                for(size_t n = 0; n < taps.size(); n++)
+                {
+                    const Tap& tap = taps[n];
+                    const float* value = &floatValues[4 * (rowOffset[tap.dy + 1][tap.sample] + columns[tap.dx + 1])];
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(value), _mm_set1_ps(tap.weight)));
+                }
+
+                _mm_storeu_ps(target.floatLine(y) + 4 * x, sum);
+            }
+#else
+            float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+            for(size_t n = 0; n < taps.size(); n++)
+            {
+                const Tap& tap = taps[n];
+                const size_t index = rowOffset[tap.dy + 1][tap.sample] + columns[tap.dx + 1];
+
+                if(pixelFormat == GdvCanvas::FormatRGB32)
+                {
+                    const QRgb value = rgbValues[index];
+                    sum[0] += qRed(value) * tap.weight;
+                    sum[1] += qGreen(value) * tap.weight;
+                    sum[2] += qBlue(value) * tap.weight;
+                }
+                else
+                {
+                    for(int k = 0; k < 4; k++)
+                        sum[k] += floatValues[4 * index + k] * tap.weight;
+                }
+            }
+
+            if(pixelFormat == GdvCanvas::FormatRGB32)
+                target.rgbLine(y)[x] = qRgb(qMin(255, static_cast<int>(sum[0] + 0.5f)),
+                                            qMin(255, static_cast<int>(sum[1] + 0.5f)),
+                                            qMin(255, static_cast<int>(sum[2] + 0.5f)));
+            else
+                memcpy(target.floatLine(y) + 4 * x, sum, sizeof(sum));
+#endif
+        }
+    }
+}
+
+void MultisampleBuffer::markModified(const QRect& area)
+{
+    const QRect clipped = area.intersected(QRect(0, 0, w, h));
+    modified.add(clipped);
+
+    if(!depthValues.empty())
+        depthWritten.add(clipped);
+}
+
+QRect MultisampleBuffer::takeModified()
+{
+    const QRect area = modified.toRect();
+    modified.clear();
+    return area;
+}
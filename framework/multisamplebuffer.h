@@ -0,0 +1,194 @@
+#ifndef MULTISAMPLEBUFFER_H
+#define MULTISAMPLEBUFFER_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include "interfaces/GdvCanvas.h"
+#include "dirtyrect.h"
+#include "pooledbuffer.h"
+
+#include <QPointF>
+#include <vector>
+
+/**
+ * @brief Die MultisampleBuffer Klasse
+ *
+ * Speichert für jeden Pixel der Zeichenfläche mehrere Farbwerte (Samples),
+ * die an festen Positionen innerhalb des Pixels liegen. Beim flipBuffer
+ * werden die Samples zu je einem Pixel zusammengefasst ("Resolve"), Kanten
+ * erscheinen dadurch geglättet. Fordert eine Abgabe mit
+ * RendererBase::sampleCount() mehr als ein Sample an, liefert
+ * GdvCanvas::multisampleBuffer() diesen Puffer.
+ *
+ * setPixel, setSpan, clearBuffer usw. der Zeichenfläche setzen immer alle
+ * Samples eines Pixels. Primitives und Rasterizer schreiben dagegen nur die
+ * Samples, die tatsächlich überdeckt sind. Eigene Verfahren können die
+ * Überdeckung mit samplePosition bestimmen und mit write übergeben:
+ *
+ * MultisampleBuffer* samples = canvas.multisampleBuffer();
+ * unsigned int mask = 0;
+ * for(int s = 0; s < samples->sampleCount(); s++)
+ *     if(inside(x + samples->samplePosition(s).x(), y + samples->samplePosition(s).y()))
+ *         mask |= 1 << s;
+ * samples->write(x, y, mask, color);
+ * samples->markModified(QRect(x, y, 1, 1));
+ *
+ * FÜR FORTGESCHRITTENE:
+ * Jedes Sample liegt in einer eigenen Ebene im Format des Back-Buffers
+ * (siehe plane), ohne Auffüllung zwischen den Zeilen. Der Resolve
+ * verarbeitet mit SSE2 jeweils vier Pixel gleichzeitig (Tent: acht, in
+ * 8.8-Festkomma) und verteilt die Zeilen auf alle Prozessorkerne; dabei
+ * wird nur der seit dem letzten Bild veränderte Bereich neu berechnet.
+ *
+ * Wichtig: Schreibzugriffe mit write, fillSpan oder testAndWriteDepth
+ * dürfen aus mehreren Threads erfolgen, solange jeder Thread eigene Pixel
+ * bearbeitet. Alle übrigen Methoden dürfen nur aus einem Thread aufgerufen
+ * werden.
+ */
+class MultisampleBuffer
+{
+public:
+    /**
+     * @brief Die Filter zum Zusammenfassen der Samples
+     *
+     * ResolveBox: Mittelwert der Samples des Pixels, am schärfsten
+     * ResolveTent: Mit dem Abstand gewichtete Samples des Pixels und seiner acht Nachbarn, glatter
+     */
+    enum ResolveFilter
+    {
+        ResolveBox,
+        ResolveTent
+    };
+
+    enum { MaxSamples = 8 };
+
+    MultisampleBuffer();
+
+    /**
+     * @brief resize Legt Größe, Anzahl der Samples und Format neu fest, der Inhalt ist danach schwarz
+     * @param samples 2, 4 oder 8
+     * @param depth true, falls zusätzlich ein z-Wert je Sample gespeichert werden soll
+     */
+    void resize(unsigned int width, unsigned int height, int samples, GdvCanvas::PixelFormat format, bool depth);
+
+    unsigned int width() const { return w; }
+    unsigned int height() const { return h; }
+    int sampleCount() const { return samples; }
+    unsigned int fullMask() const { return (1u << samples) - 1; }
+    GdvCanvas::PixelFormat format() const { return pixelFormat; }
+    bool hasDepth() const { return !depthValues.empty(); }
+
+    /**
+     * @brief samplePosition Position eines Samples innerhalb des Pixels
+     * @return x und y jeweils im Bereich 0.0 bis 1.0, auf 1/16 Pixel genau; (0.5, 0.5) ist die Pixelmitte
+     */
+    QPointF samplePosition(int sample) const;
+
+    /**
+     * @brief plane Liefert die Ebene, die ein einzelnes Sample aller Pixel enthält
+     */
+    GdvCanvas::BufferMapping plane(int sample) const;
+
+    /**
+     * @brief write Setzt die Samples eines Pixels, deren Bit in mask gesetzt ist
+     * @param mask Bit n gesetzt: Sample n wird überschrieben
+     */
+    void write(unsigned int x, unsigned int y, unsigned int mask, const QVector3D& color);
+
+    /**
+     * @brief fillSpan Wie write für die Pixel x bis x+length-1 einer Zeile
+     */
+    void fillSpan(unsigned int x, unsigned int y, unsigned int length, unsigned int mask, const QVector3D& color);
+
+    /**
+     * @brief storeRow Übernimmt eine Folge von Pixeln in alle Samples (siehe GdvCanvas::setRow)
+     */
+    void storeRow(unsigned int x, unsigned int y, unsigned int length, const float* rgb);
+    void storeRow(unsigned int x, unsigned int y, unsigned int length, const QRgb* pixels);
+
+    /**
+     * @brief blend Mischt alle Samples eines Pixels mit einer Farbe
+     * @param alpha Der Anteil von color, 0.0 bis 1.0
+     */
+    void blend(unsigned int x, unsigned int y, const QVector3D& color, float alpha);
+
+    /**
+     * @brief broadcast Kopiert Sample 0 im Bereich area in alle übrigen Samples
+     */
+    void broadcast(const QRect& area);
+
+    /**
+     * @brief clear Setzt alle Samples im Bereich area auf eine Farbe
+     */
+    void clear(const QRect& area, const QVector3D& color);
+
+    /**
+     * @brief clearDepth Setzt die z-Werte aller Samples im Bereich area auf unendlich
+     */
+    void clearDepth(const QRect& area);
+
+    /**
+     * @brief testAndWriteDepth Tiefentest für ein einzelnes Sample (kleinere z-Werte liegen vorne)
+     * @return true, falls das Sample sichtbar ist; z wurde dann übernommen
+     */
+    bool testAndWriteDepth(unsigned int x, unsigned int y, int sample, float z)
+    {
+        float& stored = depthValues[(static_cast<size_t>(sample) * h + y) * w + x];
+        if(!(z < stored))
+            return false;
+
+        stored = z;
+        return true;
+    }
+
+    void setResolveFilter(ResolveFilter filter);
+    ResolveFilter resolveFilter() const { return filter; }
+
+    /**
+     * @brief resolve Fasst die Samples im Bereich area zu Pixeln in target zusammen
+     * @param target Der Zielpuffer, gleiche Größe und gleiches Format
+     * @return Der tatsächlich neu berechnete Bereich (beim Tent-Filter inkl. der Nachbarpixel)
+     */
+    QRect resolve(const GdvCanvas::BufferMapping& target, const QRect& area) const;
+
+    /**
+     * @brief markModified Meldet Pixel, deren Samples direkt (ohne die Zeichenfläche) verändert wurden
+     *
+     * Die Zeichenfläche fasst beim nächsten flipBuffer alle gemeldeten
+     * Bereiche neu zusammen.
+     */
+    void markModified(const QRect& area);
+    QRect takeModified();
+
+private:
+    // Ein Beitrag zum Tent-Filter: Sample eines Nachbarpixels (dx, dy) mit Gewicht
+    struct Tap
+    {
+        int dx, dy, sample;
+        float weight;
+        unsigned short fixedWeight;     // weight * 65535 für vier Pixel am Stück
+    };
+
+    void resolveRows(const GdvCanvas::BufferMapping& target, const QRect& area, int firstRow, int lastRow) const;
+
+    unsigned int w, h;
+    int samples;
+    GdvCanvas::PixelFormat pixelFormat;
+    ResolveFilter filter;
+
+    PooledBuffer<QRgb> rgbValues;       // FormatRGB32: w*h je Sample
+    PooledBuffer<float> floatValues;    // FormatRGBA32F: 4*w*h je Sample
+    PooledBuffer<float> depthValues;    // w*h je Sample
+
+    std::vector<Tap> taps;
+
+    DirtyRect modified;
+    DirtyRect depthWritten;
+};
+
+#endif // MULTISAMPLEBUFFER_H
@@ -0,0 +1,58 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "outofboundscounter.h"
+
+#include <QDebug>
+
+OutOfBoundsCounter::OutOfBoundsCounter() :
+    frameCount(0), firstX(0), firstY(0), pendingCount(0), pendingFrames(0), pendingX(0), pendingY(0)
+{
+}
+
+void OutOfBoundsCounter::merge(OutOfBoundsCounter& other)
+{
+    if(other.frameCount == 0)
+        return;
+
+    if(frameCount == 0)
+    {
+        firstX = other.firstX;
+        firstY = other.firstY;
+    }
+
+    frameCount += other.frameCount;
+    other.frameCount = 0;
+}
+
+void OutOfBoundsCounter::endFrame()
+{
+    if(frameCount > 0)
+    {
+        if(pendingCount == 0)
+        {
+            pendingX = firstX;
+            pendingY = firstY;
+        }
+
+        pendingCount += frameCount;
+        pendingFrames++;
+        frameCount = 0;
+    }
+
+    if(pendingCount == 0 || (lastReport.isValid() && lastReport.elapsed() < 1000))
+        return;
+
+    qDebug() << "Warning: Drawing outside of viewport!" << pendingCount << "pixels in"
+             << pendingFrames << "frame(s), first at (" << pendingX << "," << pendingY << ")";
+
+    pendingCount = 0;
+    pendingFrames = 0;
+    lastReport.start();
+}
@@ -0,0 +1,51 @@
+#ifndef OUTOFBOUNDSCOUNTER_H
+#define OUTOFBOUNDSCOUNTER_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QElapsedTimer>
+
+/**
+ * @brief Die OutOfBoundsCounter Klasse
+ *
+ * Zählt Schreibzugriffe ausserhalb des Viewports. Anstatt jeden einzelnen
+ * Pixel auszugeben (was das Zeichnen drastisch verlangsamt), fasst endFrame
+ * die Zugriffe zusammen und gibt höchstens einmal pro Sekunde eine Warnung
+ * mit der Anzahl und dem ersten betroffenen Pixel aus.
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class OutOfBoundsCounter
+{
+public:
+    OutOfBoundsCounter();
+
+    void count(unsigned int x, unsigned int y)
+    {
+        if(frameCount++ == 0)
+        {
+            firstX = x;
+            firstY = y;
+        }
+    }
+
+    void merge(OutOfBoundsCounter& other);
+    void endFrame();
+
+private:
+    unsigned long long frameCount;
+    unsigned int firstX, firstY;
+
+    // Seit der letzten Warnung aufgelaufen
+    unsigned long long pendingCount;
+    unsigned int pendingFrames;
+    unsigned int pendingX, pendingY;
+    QElapsedTimer lastReport;
+};
+
+#endif // OUTOFBOUNDSCOUNTER_H
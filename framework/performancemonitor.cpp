@@ -8,6 +8,12 @@
 
 
 #include "performancemonitor.h"
+#include <QMutexLocker>
+#include <cmath>
+#include <cstring>
+
+const int PerformanceMonitor::HistoryLength;
+const int PerformanceMonitor::BucketCount;
 
 PerformanceMonitor::PerformanceMonitor()
 {
@@ -17,31 +23,153 @@ PerformanceMonitor::PerformanceMonitor()
 
 void PerformanceMonitor::startFrame()
 {
+    QMutexLocker lock(&mutex);
     timer.restart();
+    frameStartAllocations = AllocationTracker::total();
 }
 
 void PerformanceMonitor::stopFrame()
 {
-    double secs = timer.nsecsElapsed() * 1.0e-9;
+    QMutexLocker lock(&mutex);
+    _lastFrameTime = timer.nsecsElapsed();
+    double secs = _lastFrameTime * 1.0e-9;
+
+    _lastFrameAllocations = AllocationTracker::total() - frameStartAllocations;
+    _averageAllocations = 0.1f * _lastFrameAllocations.allocations + 0.9f * _averageAllocations;
+    _averageAllocatedBytes = 0.1f * _lastFrameAllocations.bytes + 0.9f * _averageAllocatedBytes;
 
     _currentFPS = 1.0 / secs;
 
     _averageFPS = 0.1 * _currentFPS + (1.0 - 0.1) * _averageFPS;
+
+    // Die ersten Bilder nach einem reset legen das Mittel erst fest
+    if(frameCounter >= 8 && _lastFrameTime > 2.0f * meanFrameTime)
+        stutters++;
+    meanFrameTime = frameCounter == 0 ? _lastFrameTime : 0.1f * _lastFrameTime + 0.9f * meanFrameTime;
+
+    histogram[bucket(_lastFrameTime)]++;
+    history[frameCounter % HistoryLength] = _lastFrameTime;
+    totalTime += _lastFrameTime;
+    minTime = frameCounter == 0 ? _lastFrameTime : qMin(minTime, _lastFrameTime);
+    maxTime = qMax(maxTime, _lastFrameTime);
+    frameCounter++;
 }
 
 void PerformanceMonitor::reset()
 {
+    QMutexLocker lock(&mutex);
     _averageFPS = 0.0;
     _currentFPS = 0.0;
+    _lastFrameTime = 0;
     frameCounter = 0;
+
+    frameStartAllocations = _lastFrameAllocations = AllocationTracker::Counters();
+    _averageAllocations = _averageAllocatedBytes = 0.0f;
+
+    memset(histogram, 0, sizeof(histogram));
+    totalTime = minTime = maxTime = 0;
+    meanFrameTime = 0.0f;
+    stutters = 0;
 }
 
 float PerformanceMonitor::currentFPS()
 {
+    QMutexLocker lock(&mutex);
     return _currentFPS;
 }
 
 float PerformanceMonitor::averageFPS()
 {
+    QMutexLocker lock(&mutex);
     return _averageFPS;
 }
+
+qint64 PerformanceMonitor::lastFrameTime()
+{
+    QMutexLocker lock(&mutex);
+    return _lastFrameTime;
+}
+
+AllocationTracker::Counters PerformanceMonitor::lastFrameAllocations()
+{
+    QMutexLocker lock(&mutex);
+    return _lastFrameAllocations;
+}
+
+float PerformanceMonitor::averageAllocations()
+{
+    QMutexLocker lock(&mutex);
+    return _averageAllocations;
+}
+
+float PerformanceMonitor::averageAllocatedBytes()
+{
+    QMutexLocker lock(&mutex);
+    return _averageAllocatedBytes;
+}
+
+PerformanceMonitor::FrameStatistics PerformanceMonitor::statistics()
+{
+    QMutexLocker lock(&mutex);
+
+    FrameStatistics result;
+    result.frames = frameCounter;
+    result.stutters = stutters;
+
+    if(frameCounter == 0)
+    {
+        result.min = result.mean = result.p50 = result.p95 = result.p99 = result.max = 0.0f;
+        return result;
+    }
+
+    result.min = minTime * 1.0e-6f;
+    result.max = maxTime * 1.0e-6f;
+    result.mean = totalTime * 1.0e-6f / frameCounter;
+    result.p50 = percentile(0.5f);
+    result.p95 = percentile(0.95f);
+    result.p99 = percentile(0.99f);
+    return result;
+}
+
+int PerformanceMonitor::recentFrameTimes(float* times)
+{
+    QMutexLocker lock(&mutex);
+
+    const int count = frameCounter < HistoryLength ? static_cast<int>(frameCounter) : HistoryLength;
+    const long first = frameCounter - count;
+
+    for(int n = 0; n < count; n++)
+        times[n] = history[(first + n) % HistoryLength] * 1.0e-6f;
+
+    return count;
+}
+
+int PerformanceMonitor::bucket(qint64 frameTime)
+{
+    if(frameTime < BucketBase)
+        return 0;
+
+    const int index = 1 + static_cast<int>(BucketsPerOctave * std::log2(static_cast<double>(frameTime) / BucketBase));
+    return index < BucketCount ? index : BucketCount - 1;
+}
+
+float PerformanceMonitor::bucketLimit(int bucket)
+{
+    // Obere Grenze der Klasse; Klasse 0 enthält alles unter BucketBase
+    return BucketBase * 1.0e-6f * std::pow(2.0f, static_cast<float>(bucket) / BucketsPerOctave);
+}
+
+float PerformanceMonitor::percentile(float fraction) const
+{
+    const double rank = fraction * frameCounter;
+    quint64 count = 0;
+
+    for(int n = 0; n < BucketCount; n++)
+    {
+        count += histogram[n];
+        if(count >= rank && count > 0)
+            return qBound(minTime * 1.0e-6f, bucketLimit(n), maxTime * 1.0e-6f);
+    }
+
+    return maxTime * 1.0e-6f;
+}
@@ -12,16 +12,50 @@
  **/
 
 #include <QElapsedTimer>
+#include <QMutex>
+#include "allocationtracker.h"
 
 /**
  * @brief Die PerformanceMonitor Klasse
  *
  * Wird verwendet, um die Framerate des aktiven Renderers zu ermitteln
+ *
+ * Zusätzlich wird jede Bildzeit (Dauer von startFrame bis stopFrame) in ein
+ * Histogramm mit logarithmisch verteilten Klassen (acht je Verdopplung)
+ * eingetragen. Daraus ergeben sich seit dem letzten reset Minimum, Mittelwert,
+ * Perzentile und Maximum, ohne die einzelnen Zeiten aufzubewahren; einzelne
+ * Ausreißer gehen so nicht im gleitenden Mittel der Framerate unter. Die
+ * letzten HistoryLength Bildzeiten stehen außerdem für den Verlauf
+ * (FrameGraph) zur Verfügung.
+ *
+ * Als Ruckler zählt ein Bild, das mehr als doppelt so lange dauert wie das
+ * gleitende Mittel der vorherigen Bilder.
+ *
+ * Ist der AllocationTracker verfügbar, werden außerdem die Speicheranforderungen
+ * zwischen startFrame und stopFrame gezählt - aus allen Threads, im
+ * Render-Thread-Modus also auch die der GUI.
+ *
+ * Die Methoden dürfen aus verschiedenen Threads aufgerufen werden.
  * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
  */
 class PerformanceMonitor
 {
 public:
+    /**
+     * @brief Die FrameStatistics Struktur fasst die Bildzeiten seit dem letzten reset zusammen
+     *
+     * Alle Zeiten in Millisekunden. Die Perzentile sind auf die Breite einer
+     * Histogramm-Klasse (etwa 9%) genau.
+     */
+    struct FrameStatistics
+    {
+        int frames;
+        float min, mean, p50, p95, p99, max;
+        int stutters;
+    };
+
+    static const int HistoryLength = 256;
+
     PerformanceMonitor();
 
     void startFrame();
@@ -31,12 +65,47 @@ public:
 
     float currentFPS();
     float averageFPS();
+    qint64 lastFrameTime();     // ns
+
+    AllocationTracker::Counters lastFrameAllocations();
+    float averageAllocations();         // Je Bild, gleitendes Mittel
+    float averageAllocatedBytes();
+
+    FrameStatistics statistics();
+
+    /**
+     * @brief recentFrameTimes Kopiert die letzten Bildzeiten (ms, älteste zuerst) nach times
+     * @return Die Anzahl der kopierten Werte, höchstens HistoryLength
+     */
+    int recentFrameTimes(float* times);
 
 private:
+    static const int BucketsPerOctave = 8;
+    static const int BucketCount = 1 + 20 * BucketsPerOctave;   // 10 µs bis etwa 10 s
+    static const qint64 BucketBase = 10000;                      // ns
+
+    static int bucket(qint64 frameTime);
+    static float bucketLimit(int bucket);   // ms
+    float percentile(float fraction) const;
+
     long frameCounter;
+    quint32 histogram[BucketCount];
+    qint64 history[HistoryLength];
+    qint64 totalTime, minTime, maxTime;
+    float meanFrameTime;        // ns, gleitendes Mittel
+    int stutters;
+
     QElapsedTimer timer;
     float _averageFPS;
     float _currentFPS;
+    qint64 _lastFrameTime;
+
+    AllocationTracker::Counters frameStartAllocations;
+    AllocationTracker::Counters _lastFrameAllocations;
+    float _averageAllocations;
+    float _averageAllocatedBytes;
+
+    QMutex mutex;
 };
 
 #endif // PERFORMANCEMONITOR_H
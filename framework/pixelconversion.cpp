@@ -0,0 +1,195 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "pixelconversion.h"
+#include "simd.h"
+
+#include <cmath>
+
+void PixelConversion::convertRow(const float* rgb, QRgb* target, unsigned int count)
+{
+    unsigned int n = 0;
+
+#ifdef GDV_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+
+    for(; n + 4 <= count; n += 4, rgb += 12)
+    {
+        // [r0 g0 b0 r1] [g1 b1 r2 g2] [b2 r3 g3 b3] -> getrennte Kanäle
+        __m128 a = _mm_loadu_ps(rgb);
+        __m128 b = _mm_loadu_ps(rgb + 4);
+        __m128 c = _mm_loadu_ps(rgb + 8);
+
+        __m128 t = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1,1,2,2));
+        __m128 red = _mm_shuffle_ps(a, t, _MM_SHUFFLE(2,0,3,0));
+
+        __m128 p = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0,0,1,1));
+        __m128 q = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2,2,3,3));
+        __m128 green = _mm_shuffle_ps(p, q, _MM_SHUFFLE(2,0,2,0));
+
+        p = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1,1,2,2));
+        q = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3,3,0,0));
+        __m128 blue = _mm_shuffle_ps(p, q, _MM_SHUFFLE(2,0,2,0));
+
+        __m128i r = _mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(red, zero), one), scale));
+        __m128i g = _mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(green, zero), one), scale));
+        __m128i bl = _mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(blue, zero), one), scale));
+
+        __m128i pixels = _mm_or_si128(_mm_or_si128(alpha, _mm_slli_epi32(r, 16)),
+                                      _mm_or_si128(_mm_slli_epi32(g, 8), bl));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target + n), pixels);
+    }
+#endif
+
+    for(; n < count; n++, rgb += 3)
+        target[n] = toRgb(rgb[0], rgb[1], rgb[2]);
+}
+
+void PixelConversion::fillRow(QRgb* target, QRgb value, unsigned int count)
+{
+    for(unsigned int n = 0; n < count; n++)
+        target[n] = value;
+}
+
+namespace
+{
+    // Lineare Werte 0.0..1.0 in 4096 Stufen -> 8 Bit sRGB
+    struct SRGBTable
+    {
+        unsigned char values[4096];
+
+        SRGBTable()
+        {
+            for(int n = 0; n < 4096; n++)
+            {
+                float linear = n / 4095.0f;
+                float encoded = linear <= 0.0031308f ? linear * 12.92f
+                                                     : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+                values[n] = static_cast<unsigned char>(qBound(0.0f, encoded, 1.0f) * 255.0f + 0.5f);
+            }
+        }
+    };
+
+    const unsigned char* srgbTable()
+    {
+        static const SRGBTable table;
+        return table.values;
+    }
+
+    inline float toneMap(float value, GdvCanvas::ToneMapping mode)
+    {
+        value = qMax(value, 0.0f);
+
+        switch(mode)
+        {
+        case GdvCanvas::ToneMapReinhard:
+            value = value / (1.0f + value);
+            break;
+        case GdvCanvas::ToneMapFilmic:
+            value = (value * (2.51f * value + 0.03f)) / (value * (2.43f * value + 0.59f) + 0.14f);
+            break;
+        default:
+            break;
+        }
+
+        return qMin(value, 1.0f);
+    }
+
+    inline int quantize(float value, const unsigned char* table)
+    {
+        if(table)
+            return table[static_cast<int>(value * 4095.0f + 0.5f)];
+
+        return static_cast<int>(value * 255.0f + 0.5f);
+    }
+
+#ifdef GDV_SSE2
+    inline __m128 toneMap(__m128 value, GdvCanvas::ToneMapping mode)
+    {
+        value = _mm_max_ps(value, _mm_setzero_ps());
+
+        switch(mode)
+        {
+        case GdvCanvas::ToneMapReinhard:
+            value = _mm_div_ps(value, _mm_add_ps(_mm_set1_ps(1.0f), value));
+            break;
+        case GdvCanvas::ToneMapFilmic:
+        {
+            __m128 numerator = _mm_mul_ps(value, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.51f), value), _mm_set1_ps(0.03f)));
+            __m128 denominator = _mm_add_ps(_mm_mul_ps(value, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.43f), value), _mm_set1_ps(0.59f))), _mm_set1_ps(0.14f));
+            value = _mm_div_ps(numerator, denominator);
+            break;
+        }
+        default:
+            break;
+        }
+
+        return _mm_min_ps(value, _mm_set1_ps(1.0f));
+    }
+#endif
+}
+
+void PixelConversion::toneMapRow(const float* rgba, QRgb* target, unsigned int count,
+                                 GdvCanvas::ToneMapping mode, float exposure, bool sRGB)
+{
+    const unsigned char* table = sRGB ? srgbTable() : 0;
+    unsigned int n = 0;
+
+#ifdef GDV_SSE2
+    const __m128 scaleExposure = _mm_set1_ps(exposure);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+
+    for(; n + 4 <= count; n += 4, rgba += 16)
+    {
+        __m128 red = _mm_loadu_ps(rgba);
+        __m128 green = _mm_loadu_ps(rgba + 4);
+        __m128 blue = _mm_loadu_ps(rgba + 8);
+        __m128 unused = _mm_loadu_ps(rgba + 12);
+        _MM_TRANSPOSE4_PS(red, green, blue, unused);
+
+        red = toneMap(_mm_mul_ps(red, scaleExposure), mode);
+        green = toneMap(_mm_mul_ps(green, scaleExposure), mode);
+        blue = toneMap(_mm_mul_ps(blue, scaleExposure), mode);
+
+        if(table)
+        {
+            const __m128 steps = _mm_set1_ps(4095.0f);
+            int index[12];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(index), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(red, steps), half)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(index + 4), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(green, steps), half)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(index + 8), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(blue, steps), half)));
+
+            for(int i = 0; i < 4; i++)
+                target[n + i] = qRgb(table[index[i]], table[index[4 + i]], table[index[8 + i]]);
+        }
+        else
+        {
+            const __m128 scale = _mm_set1_ps(255.0f);
+            __m128i r = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(red, scale), half));
+            __m128i g = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(green, scale), half));
+            __m128i b = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(blue, scale), half));
+
+            __m128i pixels = _mm_or_si128(_mm_or_si128(alpha, _mm_slli_epi32(r, 16)),
+                                          _mm_or_si128(_mm_slli_epi32(g, 8), b));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + n), pixels);
+        }
+    }
+#endif
+
+    for(; n < count; n++, rgba += 4)
+    {
+        target[n] = qRgb(quantize(toneMap(rgba[0] * exposure, mode), table),
+                         quantize(toneMap(rgba[1] * exposure, mode), table),
+                         quantize(toneMap(rgba[2] * exposure, mode), table));
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef PIXELCONVERSION_H
+#define PIXELCONVERSION_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QVector3D>
+#include <QImage>
+#include "interfaces/GdvCanvas.h"
+
+/**
+ * Hilfsfunktionen zur Umrechnung von Fließkommafarben (0.0 bis 1.0) in das
+ * 32-Bit Format des Back-Buffers. Die Zeilenvarianten rechnen (sofern
+ * verfügbar) jeweils vier Pixel gleichzeitig mit SSE2 um.
+ *
+ * Interne Funktionen, bitte nicht direkt einbinden und/oder verändern!
+ */
+namespace PixelConversion
+{
+    inline int toChannel(float value)
+    {
+        // Wie die SSE2-Variante: NaN wird zu 0
+        return static_cast<int>((value > 0.0f ? qMin(value, 1.0f) : 0.0f) * 255.0f);
+    }
+
+    inline QRgb toRgb(float r, float g, float b)
+    {
+        return qRgb(toChannel(r), toChannel(g), toChannel(b));
+    }
+
+    inline QRgb toRgb(const QVector3D& color)
+    {
+        return toRgb(color.x(), color.y(), color.z());
+    }
+
+    // Wandelt 'count' RGB-Tripel (3 floats je Pixel) in QRgb-Werte um
+    void convertRow(const float* rgb, QRgb* target, unsigned int count);
+
+    // Füllt 'count' Pixel mit einem einzelnen Wert
+    void fillRow(QRgb* target, QRgb value, unsigned int count);
+
+    // Wandelt 'count' lineare RGBA-Fließkommapixel (4 floats je Pixel) mit
+    // Belichtung, Tonemapping und optionaler sRGB-Kodierung in QRgb-Werte um
+    void toneMapRow(const float* rgba, QRgb* target, unsigned int count,
+                    GdvCanvas::ToneMapping mode, float exposure, bool sRGB);
+}
+
+#endif // PIXELCONVERSION_H
@@ -0,0 +1,118 @@
+#ifndef POOLEDBUFFER_H
+#define POOLEDBUFFER_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QtGlobal>
+#include <algorithm>
+#include <vector>
+
+/**
+ * @brief Die PooledBuffer Klasse
+ *
+ * Ein Puffer für Werte je Pixel (Tiefe, Akkumulation, ...), dessen Speicher
+ * bei Größenänderungen nicht jedes Mal neu angefordert wird. Reicht der
+ * vorhandene Speicher nicht aus, wird gleich das Anderthalbfache reserviert;
+ * wird der Puffer kleiner, bleibt der Speicher erhalten. Beim Aufziehen des
+ * Fensters wird so nur noch selten Speicher angefordert, beim Verkleinern gar
+ * nicht. Der Inhalt nach resize ist undefiniert, assign setzt alle Werte.
+ *
+ * Beispiel zur Verwendung in einer Abgabe:
+ *
+ * PooledBuffer<QVector3D> accumulation;
+ *
+ * void MyRenderer::sizeChanged(unsigned int width, unsigned int height)
+ * {
+ *     accumulation.resize(width, height);
+ *     accumulation.fill(QVector3D());
+ * }
+ *
+ * accumulation.line(y)[x] += color;
+ *
+ * Mit release wird der Speicher vollständig freigegeben (z.B. in deinitialize).
+ */
+template<class T>
+class PooledBuffer
+{
+public:
+    PooledBuffer() : count(0), w(0), h(0) {}
+
+    /**
+     * @brief resize Legt die Anzahl der Werte fest, der Inhalt ist danach undefiniert
+     * @return true, falls dafür neuer Speicher angefordert werden musste
+     */
+    bool resize(size_t size)
+    {
+        w = h = 0;
+        count = size;
+
+        if(size <= storage.size())
+            return false;
+
+        // Der bisherige Inhalt wird nicht übernommen, also auch nicht kopiert
+        std::vector<T> grown(qMax(size, storage.size() + storage.size() / 2));
+        storage.swap(grown);
+        return true;
+    }
+
+    /**
+     * @brief resize Legt Breite und Höhe fest (Zeile für Zeile ohne Lücken), der Inhalt ist danach undefiniert
+     * @return true, falls dafür neuer Speicher angefordert werden musste
+     */
+    bool resize(unsigned int width, unsigned int height)
+    {
+        const bool allocated = resize(static_cast<size_t>(width) * height);
+        w = width;
+        h = height;
+        return allocated;
+    }
+
+    /**
+     * @brief assign Wie resize(size), setzt anschließend alle Werte auf value
+     */
+    void assign(size_t size, const T& value)
+    {
+        resize(size);
+        fill(value);
+    }
+
+    void fill(const T& value) { std::fill(storage.begin(), storage.begin() + count, value); }
+
+    /**
+     * @brief release Gibt den Speicher frei, der Puffer ist danach leer
+     */
+    void release()
+    {
+        std::vector<T>().swap(storage);
+        count = 0;
+        w = h = 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return storage.size(); }
+
+    unsigned int width() const { return w; }
+    unsigned int height() const { return h; }
+
+    T* data() { return storage.data(); }
+    const T* data() const { return storage.data(); }
+
+    T& operator[](size_t index) { return storage[index]; }
+    const T& operator[](size_t index) const { return storage[index]; }
+
+    T* line(unsigned int y) { return storage.data() + static_cast<size_t>(y) * w; }
+    const T* line(unsigned int y) const { return storage.data() + static_cast<size_t>(y) * w; }
+
+private:
+    std::vector<T> storage;
+    size_t count;
+    unsigned int w, h;
+};
+
+#endif // POOLEDBUFFER_H
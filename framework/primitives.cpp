@@ -0,0 +1,556 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "primitives.h"
+#include "multisamplebuffer.h"
+#include "pixelconversion.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Liang-Barsky: Beschränkt die Strecke auf das Rechteck, false falls sie es nicht schneidet
+    bool clipSegment(float& x0, float& y0, float& x1, float& y1, float left, float top, float right, float bottom)
+    {
+        const float dx = x1 - x0;
+        const float dy = y1 - y0;
+        const float p[4] = { -dx, dx, -dy, dy };
+        const float q[4] = { x0 - left, right - x0, y0 - top, bottom - y0 };
+
+        float t0 = 0.0f, t1 = 1.0f;
+        for(int n = 0; n < 4; n++)
+        {
+            if(p[n] == 0.0f)
+            {
+                if(q[n] < 0.0f)
+                    return false;
+                continue;
+            }
+
+            const float t = q[n] / p[n];
+            if(p[n] < 0.0f)
+            {
+                if(t > t1)
+                    return false;
+                t0 = qMax(t0, t);
+            }
+            else
+            {
+                if(t < t0)
+                    return false;
+                t1 = qMin(t1, t);
+            }
+        }
+
+        const float startX = x0, startY = y0;
+        x0 = startX + t0 * dx;
+        y0 = startY + t0 * dy;
+        x1 = startX + t1 * dx;
+        y1 = startY + t1 * dy;
+
+        // Selbstvergleich verwirft NaN (auch aus unendlichen Koordinaten)
+        if(!(t0 <= t1) || x0 != x0 || y0 != y0 || x1 != x1 || y1 != y1)
+            return false;
+
+        // Rundungsfehler dürfen nicht aus dem Rechteck führen
+        x0 = qBound(left, x0, right);
+        y0 = qBound(top, y0, bottom);
+        x1 = qBound(left, x1, right);
+        y1 = qBound(top, y1, bottom);
+        return true;
+    }
+
+    inline float fraction(float value)
+    {
+        return value - std::floor(value);
+    }
+
+    bool segmentLess(const Primitives::Line& a, const Primitives::Line& b)
+    {
+        if(a.from.x() != b.from.x()) return a.from.x() < b.from.x();
+        if(a.from.y() != b.from.y()) return a.from.y() < b.from.y();
+        if(a.to.x() != b.to.x()) return a.to.x() < b.to.x();
+        return a.to.y() < b.to.y();
+    }
+
+    bool segmentEqual(const Primitives::Line& a, const Primitives::Line& b)
+    {
+        return a.from == b.from && a.to == b.to;
+    }
+}
+
+Primitives::Primitives() :
+    samples(0), sampleMask(0), clipLeft(0), clipTop(0), clipRight(0), clipBottom(0), rgb(0)
+{
+}
+
+void Primitives::drawLines(GdvCanvas& canvas, const QVector<Line>& lines, bool antialiased)
+{
+    if(lines.isEmpty() || !begin(canvas))
+        return;
+
+    for(int n = 0; n < lines.size(); n++)
+    {
+        const Line& l = lines[n];
+        setColor(l.color);
+
+        if(antialiased)
+            smoothLine(l.from.x(), l.from.y(), l.to.x(), l.to.y());
+        else
+            line(l.from.x(), l.from.y(), l.to.x(), l.to.y());
+    }
+
+    end(canvas);
+}
+
+void Primitives::drawTriangles(GdvCanvas& canvas, const QVector<Triangle>& triangles)
+{
+    if(triangles.isEmpty() || !begin(canvas))
+        return;
+
+    for(int n = 0; n < triangles.size(); n++)
+    {
+        setColor(triangles[n].color);
+        fill(triangles[n].points, 3, OddEven);
+    }
+
+    end(canvas);
+}
+
+void Primitives::drawPolygon(GdvCanvas& canvas, const QVector<QPointF>& points, const QVector3D& color, FillRule rule)
+{
+    if(points.size() < 3 || !begin(canvas))
+        return;
+
+    setColor(color);
+    fill(points.constData(), points.size(), rule);
+
+    end(canvas);
+}
+
+void Primitives::drawWireframe(GdvCanvas& canvas, const QVector<MeshLoader::Face>& faces, const QVector3D& color, bool antialiased)
+{
+    if(faces.isEmpty())
+        return;
+
+    // Jede Kante einheitlich orientieren, sortieren und doppelte entfernen
+    segments.clear();
+    segments.reserve(faces.size() * 3);
+
+    for(int n = 0; n < faces.size(); n++)
+    {
+        const MeshLoader::Face& face = faces[n];
+        for(int k = 0; k < 3; k++)
+        {
+            const MeshLoader::VertexInfo& a = face[k];
+            const MeshLoader::VertexInfo& b = face[(k + 1) % 3];
+
+            // NaN würde die Sortierung ungültig machen, unendliche Kanten werden ohnehin verworfen
+            if(!std::isfinite(a.x) || !std::isfinite(a.y) || !std::isfinite(b.x) || !std::isfinite(b.y))
+                continue;
+
+            Line segment(QPointF(a.x, a.y), QPointF(b.x, b.y), color);
+            if(segmentLess(Line(segment.to, segment.from, color), segment))
+                std::swap(segment.from, segment.to);
+
+            segments.push_back(segment);
+        }
+    }
+
+    std::sort(segments.begin(), segments.end(), segmentLess);
+    segments.erase(std::unique(segments.begin(), segments.end(), segmentEqual), segments.end());
+
+    if(!begin(canvas))
+        return;
+
+    setColor(color);
+    for(size_t n = 0; n < segments.size(); n++)
+    {
+        const Line& l = segments[n];
+        if(antialiased)
+            smoothLine(l.from.x(), l.from.y(), l.to.x(), l.to.y());
+        else
+            line(l.from.x(), l.from.y(), l.to.x(), l.to.y());
+    }
+
+    end(canvas);
+}
+
+bool Primitives::begin(GdvCanvas& canvas)
+{
+    const QRect clip = canvas.clipRect();
+    if(clip.isEmpty())
+        return false;
+
+    // Im Multisampling-Modus direkt in die Samples, ohne den Back-Buffer abzubilden
+    samples = canvas.multisampleBuffer();
+    QRect bounds;
+
+    if(samples)
+    {
+        bounds = clip.intersected(QRect(0, 0, samples->width(), samples->height()));
+        sampleMask = samples->fullMask();
+    }
+    else
+    {
+        mapping = canvas.mapBuffer();
+        if(!mapping.isValid())
+        {
+            canvas.unmapBuffer(QRect());
+            return false;
+        }
+
+        bounds = clip.intersected(QRect(0, 0, mapping.width, mapping.height));
+    }
+
+    clipLeft = bounds.left();
+    clipTop = bounds.top();
+    clipRight = bounds.right() + 1;
+    clipBottom = bounds.bottom() + 1;
+
+    modified.clear();
+    return true;
+}
+
+void Primitives::end(GdvCanvas& canvas)
+{
+    if(samples)
+    {
+        samples->markModified(modified.toRect());
+        samples = 0;
+        return;
+    }
+
+    canvas.unmapBuffer(modified.toRect());
+    mapping = GdvCanvas::BufferMapping();
+}
+
+void Primitives::setColor(const QVector3D& value)
+{
+    color = value;
+    rgb = PixelConversion::toRgb(value);
+}
+
+void Primitives::plot(int x, int y)
+{
+    if(samples)
+    {
+        samples->write(x, y, sampleMask, color);
+        return;
+    }
+
+    if(mapping.format == GdvCanvas::FormatRGB32)
+    {
+        mapping.rgbLine(y)[x] = rgb;
+        return;
+    }
+
+    float* pixel = mapping.floatLine(y) + 4 * x;
+    pixel[0] = color.x();
+    pixel[1] = color.y();
+    pixel[2] = color.z();
+    pixel[3] = 1.0f;
+}
+
+void Primitives::span(int x, int y, int length)
+{
+    if(samples)
+    {
+        samples->fillSpan(x, y, length, sampleMask, color);
+        return;
+    }
+
+    if(mapping.format == GdvCanvas::FormatRGB32)
+    {
+        PixelConversion::fillRow(mapping.rgbLine(y) + x, rgb, length);
+        return;
+    }
+
+    float* pixel = mapping.floatLine(y) + 4 * x;
+    for(int n = 0; n < length; n++, pixel += 4)
+    {
+        pixel[0] = color.x();
+        pixel[1] = color.y();
+        pixel[2] = color.z();
+        pixel[3] = 1.0f;
+    }
+}
+
+void Primitives::blend(int x, int y, float coverage)
+{
+    if(x < clipLeft || x >= clipRight || y < clipTop || y >= clipBottom || !(coverage > 0.0f))
+        return;
+
+    modified.add(x, y);
+
+    if(samples)
+    {
+        samples->blend(x, y, color, coverage);
+        return;
+    }
+
+    if(mapping.format == GdvCanvas::FormatRGB32)
+    {
+        QRgb& pixel = mapping.rgbLine(y)[x];
+        const float keep = 1.0f - coverage;
+        pixel = qRgb(qRed(pixel) * keep + qRed(rgb) * coverage + 0.5f,
+                     qGreen(pixel) * keep + qGreen(rgb) * coverage + 0.5f,
+                     qBlue(pixel) * keep + qBlue(rgb) * coverage + 0.5f);
+        return;
+    }
+
+    float* pixel = mapping.floatLine(y) + 4 * x;
+    pixel[0] += (color.x() - pixel[0]) * coverage;
+    pixel[1] += (color.y() - pixel[1]) * coverage;
+    pixel[2] += (color.z() - pixel[2]) * coverage;
+}
+
+void Primitives::line(float x0, float y0, float x1, float y1)
+{
+    if(!clipSegment(x0, y0, x1, y1, clipLeft, clipTop, clipRight, clipBottom))
+        return;
+
+    // Pixel, in denen die Endpunkte liegen. Ein Endpunkt genau auf dem
+    // rechten/unteren Rand gehört zum letzten Pixel davor.
+    const int startX = qBound(clipLeft, static_cast<int>(std::floor(x0)), clipRight - 1);
+    const int startY = qBound(clipTop, static_cast<int>(std::floor(y0)), clipBottom - 1);
+    const int endX = qBound(clipLeft, static_cast<int>(std::floor(x1)), clipRight - 1);
+    const int endY = qBound(clipTop, static_cast<int>(std::floor(y1)), clipBottom - 1);
+
+    modified.add(qMin(startX, endX), qMin(startY, endY), qAbs(endX - startX) + 1, qAbs(endY - startY) + 1);
+
+    // Bresenham; alle Pixel liegen innerhalb des Rechtecks der Endpunkte und
+    // damit innerhalb des Clip-Rechtecks
+    const int dx = qAbs(endX - startX);
+    const int dy = qAbs(endY - startY);
+    const int stepX = startX < endX ? 1 : -1;
+    const int stepY = startY < endY ? 1 : -1;
+
+    if(dx >= dy)
+    {
+        // Flache Linien: Pixel derselben Zeile als Span schreiben
+        int error = dx / 2;
+        int y = startY;
+        int runStart = startX;
+
+        for(int x = startX; ; x += stepX)
+        {
+            const bool last = x == endX;
+            error -= dy;
+
+            if(last || error < 0)
+            {
+                span(qMin(runStart, x), y, qAbs(x - runStart) + 1);
+                if(last)
+                    break;
+
+                y += stepY;
+                error += dx;
+                runStart = x + stepX;
+            }
+        }
+    }
+    else
+    {
+        int error = dy / 2;
+        int x = startX;
+
+        for(int y = startY; ; y += stepY)
+        {
+            plot(x, y);
+            if(y == endY)
+                break;
+
+            error -= dx;
+            if(error < 0)
+            {
+                x += stepX;
+                error += dy;
+            }
+        }
+    }
+}
+
+void Primitives::smoothLine(float x0, float y0, float x1, float y1)
+{
+    // Ein Pixel Rand, damit auch die anteilig überdeckten Nachbarn am Rand gezeichnet werden
+    if(!clipSegment(x0, y0, x1, y1, clipLeft - 1, clipTop - 1, clipRight + 1, clipBottom + 1))
+        return;
+
+    // Xiaolin Wu; Pixelmitten auf ganzzahlige Koordinaten verschieben
+    x0 -= 0.5f; y0 -= 0.5f;
+    x1 -= 0.5f; y1 -= 0.5f;
+
+    const bool steep = qAbs(y1 - y0) > qAbs(x1 - x0);
+    if(steep)
+    {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if(x0 > x1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    const float dx = x1 - x0;
+    const float gradient = dx > 0.0f ? (y1 - y0) / dx : 1.0f;
+
+    // Pixel (major, minor) mit der Überdeckung coverage mischen
+    auto plotPixel = [this, steep](int major, int minor, float coverage)
+    {
+        if(steep)
+            blend(minor, major, coverage);
+        else
+            blend(major, minor, coverage);
+    };
+
+    // Endpunkte: Überdeckung zusätzlich mit dem Anteil des Pixels in Laufrichtung gewichten
+    const float startMajor = std::floor(x0 + 0.5f);
+    const float startMinor = y0 + gradient * (startMajor - x0);
+    const float startGap = 1.0f - fraction(x0 + 0.5f);
+    const int firstX = static_cast<int>(startMajor);
+    const int firstY = static_cast<int>(std::floor(startMinor));
+    plotPixel(firstX, firstY, (1.0f - fraction(startMinor)) * startGap);
+    plotPixel(firstX, firstY + 1, fraction(startMinor) * startGap);
+
+    const float endMajor = std::floor(x1 + 0.5f);
+    const float endMinor = y1 + gradient * (endMajor - x1);
+    const float endGap = fraction(x1 + 0.5f);
+    const int lastX = static_cast<int>(endMajor);
+    const int lastY = static_cast<int>(std::floor(endMinor));
+
+    if(lastX != firstX)
+    {
+        plotPixel(lastX, lastY, (1.0f - fraction(endMinor)) * endGap);
+        plotPixel(lastX, lastY + 1, fraction(endMinor) * endGap);
+    }
+
+    float minor = startMinor + gradient;
+    for(int x = firstX + 1; x < lastX; x++, minor += gradient)
+    {
+        const int y = static_cast<int>(std::floor(minor));
+        const float f = minor - y;
+        plotPixel(x, y, 1.0f - f);
+        plotPixel(x, y + 1, f);
+    }
+}
+
+void Primitives::fill(const QPointF* points, int count, FillRule rule)
+{
+    if(!samples)
+    {
+        scanConvert(points, count, rule, 0.5, 0.5);
+        return;
+    }
+
+    // Jede Sample-Position einzeln abtasten und nur das jeweilige Sample schreiben
+    for(int s = 0; s < samples->sampleCount(); s++)
+    {
+        const QPointF position = samples->samplePosition(s);
+        sampleMask = 1u << s;
+        scanConvert(points, count, rule, position.x(), position.y());
+    }
+
+    sampleMask = samples->fullMask();
+}
+
+void Primitives::scanConvert(const QPointF* points, int count, FillRule rule, double sampleX, double sampleY)
+{
+    // Kantenliste aufbauen; abgetastet wird an (x + sampleX, y + sampleY),
+    // ohne Multisampling also in der Mitte jedes Pixels
+    edges.clear();
+
+    for(int n = 0; n < count; n++)
+    {
+        const QPointF& a = points[n];
+        const QPointF& b = points[(n + 1) % count];
+
+        const bool down = a.y() < b.y();
+        const QPointF& top = down ? a : b;
+        const QPointF& bottom = down ? b : a;
+
+        // Negiert, damit auch waagerechte Kanten und NaN verworfen werden
+        if(!(top.y() < bottom.y()))
+            continue;
+
+        const double upper = qBound<double>(clipTop, top.y(), clipBottom);
+        const double lower = qBound<double>(clipTop, bottom.y(), clipBottom);
+
+        Edge edge;
+        edge.firstY = static_cast<int>(std::ceil(upper - sampleY));
+        edge.lastY = qMin(static_cast<int>(std::ceil(lower - sampleY)) - 1, clipBottom - 1);
+        if(edge.firstY > edge.lastY)
+            continue;
+
+        edge.dxdy = (bottom.x() - top.x()) / (bottom.y() - top.y());
+        edge.x = top.x() + (edge.firstY + sampleY - top.y()) * edge.dxdy;
+        edge.winding = down ? 1 : -1;
+        edges.push_back(edge);
+    }
+
+    if(edges.empty())
+        return;
+
+    std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.firstY < b.firstY; });
+
+    int lastY = 0;
+    for(size_t n = 0; n < edges.size(); n++)
+        lastY = qMax(lastY, edges[n].lastY);
+
+    active.clear();
+    size_t next = 0;
+
+    for(int y = edges[0].firstY; y <= lastY; y++)
+    {
+        // Neue Kanten aufnehmen, abgelaufene entfernen
+        while(next < edges.size() && edges[next].firstY == y)
+            active.push_back(&edges[next++]);
+
+        active.erase(std::remove_if(active.begin(), active.end(), [y](const Edge* edge) { return edge->lastY < y; }),
+                     active.end());
+
+        if(active.empty())
+        {
+            if(next < edges.size())
+                y = edges[next].firstY - 1;
+            continue;
+        }
+
+        crossings.clear();
+        for(size_t n = 0; n < active.size(); n++)
+        {
+            crossings.push_back(std::make_pair(active[n]->x, active[n]->winding));
+            active[n]->x += active[n]->dxdy;
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        // Zwischen zwei Schnittpunkten liegen die Pixel, deren Abtastpunkt in [from, to) liegt
+        int winding = 0;
+        for(size_t n = 0; n + 1 < crossings.size(); n++)
+        {
+            winding += rule == OddEven ? 1 : crossings[n].second;
+            const bool inside = rule == OddEven ? (winding & 1) != 0 : winding != 0;
+            if(!inside)
+                continue;
+
+            const double from = qBound<double>(clipLeft, crossings[n].first, clipRight);
+            const double to = qBound<double>(clipLeft, crossings[n + 1].first, clipRight);
+            const int firstX = static_cast<int>(std::ceil(from - sampleX));
+            const int endX = qMin(static_cast<int>(std::ceil(to - sampleX)), clipRight);
+
+            if(firstX < endX)
+            {
+                span(firstX, y, endX - firstX);
+                modified.add(firstX, y, endX - firstX, 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,165 @@
+#ifndef PRIMITIVES_H
+#define PRIMITIVES_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include "interfaces/GdvCanvas.h"
+#include "meshloader.h"
+#include "dirtyrect.h"
+
+#include <QPointF>
+#include <QVector>
+#include <vector>
+
+class MultisampleBuffer;
+
+/**
+ * @brief Die Primitives Klasse
+ *
+ * Zeichnet Linien, Dreiecke und Polygone mit einer einheitlichen Farbe je
+ * Primitiv in eine Zeichenfläche. Alle Koordinaten sind Pixelkoordinaten,
+ * der Mittelpunkt des Pixels (x, y) liegt bei (x + 0.5, y + 0.5). Es werden
+ * immer ganze Listen übergeben, z.B.:
+ *
+ * QVector<Primitives::Line> lines;
+ * lines.append(Primitives::Line(QPointF(10, 10), QPointF(200, 50), QVector3D(1, 1, 1)));
+ * primitives.drawLines(canvas, lines);
+ *
+ * primitives.drawWireframe(canvas, screenFaces, QVector3D(0, 1, 0));
+ *
+ * Gezeichnet wird nur innerhalb des Clip-Rechtecks der Zeichenfläche (siehe
+ * GdvCanvas::setClipRect); Teile ausserhalb werden ohne Warnung verworfen.
+ * Primitive werden in der übergebenen Reihenfolge gezeichnet.
+ *
+ * Wichtig: Die Zwischenspeicher eines Aufrufs liegen in der Instanz, damit
+ * sie nicht bei jeder Liste neu angefordert werden. Jeder Thread braucht
+ * also seine eigene Instanz, in renderTile z.B. eine lokale.
+ *
+ * FÜR FORTGESCHRITTENE:
+ * Der Back-Buffer wird für jede Liste nur einmal abgebildet (siehe
+ * GdvCanvas::mapBuffer), Flächen werden zeilenweise als Spans gefüllt. Im
+ * Gegensatz zu einzelnen setPixel-Aufrufen fallen so keine virtuellen
+ * Aufrufe und Farbumrechnungen je Pixel an.
+ *
+ * Im Multisampling-Modus (siehe RendererBase::sampleCount) werden Flächen
+ * für jede Sample-Position einzeln abgetastet und nur die überdeckten
+ * Samples geschrieben, sodass Kanten beim flipBuffer geglättet erscheinen.
+ */
+class Primitives
+{
+public:
+    struct Line
+    {
+        QPointF from, to;
+        QVector3D color;
+
+        Line() {}
+        Line(const QPointF& from, const QPointF& to, const QVector3D& color) : from(from), to(to), color(color) {}
+    };
+
+    struct Triangle
+    {
+        QPointF points[3];
+        QVector3D color;
+
+        Triangle() {}
+        Triangle(const QPointF& a, const QPointF& b, const QPointF& c, const QVector3D& color) : color(color)
+        {
+            points[0] = a;
+            points[1] = b;
+            points[2] = c;
+        }
+    };
+
+    /**
+     * @brief Legt fest, welche Bereiche eines sich selbst schneidenden Polygons innen liegen
+     *
+     * OddEven: Ein Punkt liegt innen, wenn ein Strahl von ihm aus eine ungerade Anzahl Kanten schneidet
+     * NonZero: Ein Punkt liegt innen, wenn das Polygon ihn mindestens einmal umläuft
+     */
+    enum FillRule
+    {
+        OddEven,
+        NonZero
+    };
+
+    Primitives();
+
+    /**
+     * @brief drawLines Zeichnet Liniensegmente mit einer Breite von einem Pixel
+     * @param canvas Die Zeichenfläche
+     * @param lines Die zu zeichnenden Linien
+     * @param antialiased true: Kantenglättung, Pixel werden anteilig ihrer Überdeckung mit dem Hintergrund gemischt
+     */
+    void drawLines(GdvCanvas& canvas, const QVector<Line>& lines, bool antialiased = false);
+
+    /**
+     * @brief drawTriangles Füllt Dreiecke
+     *
+     * Pixel, deren Mittelpunkt im Dreieck liegt, werden gefüllt. Dreiecke mit
+     * gemeinsamen Kanten überlappen sich nicht und lassen keine Lücken.
+     */
+    void drawTriangles(GdvCanvas& canvas, const QVector<Triangle>& triangles);
+
+    /**
+     * @brief drawPolygon Füllt ein beliebiges (auch konkaves oder sich selbst schneidendes) Polygon
+     * @param canvas Die Zeichenfläche
+     * @param points Die Eckpunkte; der letzte wird automatisch mit dem ersten verbunden
+     * @param color Die Füllfarbe
+     * @param rule Die Regel für sich überlappende Bereiche
+     */
+    void drawPolygon(GdvCanvas& canvas, const QVector<QPointF>& points, const QVector3D& color, FillRule rule = OddEven);
+
+    /**
+     * @brief drawWireframe Zeichnet alle Kanten eines Meshs
+     * @param canvas Die Zeichenfläche
+     * @param faces Die Dreiecke, x und y der Vertices bereits in Bildschirmkoordinaten (z wird ignoriert)
+     * @param color Die Farbe der Kanten
+     * @param antialiased true: Kantenglättung wie bei drawLines
+     *
+     * Kanten, die sich mehrere Dreiecke teilen, werden nur einmal gezeichnet.
+     */
+    void drawWireframe(GdvCanvas& canvas, const QVector<MeshLoader::Face>& faces, const QVector3D& color, bool antialiased = false);
+
+private:
+    struct Edge
+    {
+        int firstY, lastY;  // Erste/letzte Zeile, deren Abtastpunkt die Kante schneidet
+        double x, dxdy;     // x auf Höhe des Abtastpunkts von firstY, Änderung je Zeile
+        int winding;        // +1 abwärts, -1 aufwärts
+    };
+
+    bool begin(GdvCanvas& canvas);
+    void end(GdvCanvas& canvas);
+
+    void setColor(const QVector3D& color);
+    void plot(int x, int y);
+    void span(int x, int y, int length);
+    void blend(int x, int y, float coverage);
+
+    void line(float x0, float y0, float x1, float y1);
+    void smoothLine(float x0, float y0, float x1, float y1);
+    void fill(const QPointF* points, int count, FillRule rule);
+    void scanConvert(const QPointF* points, int count, FillRule rule, double sampleX, double sampleY);
+
+    GdvCanvas::BufferMapping mapping;
+    MultisampleBuffer* samples;     // Nur im Multisampling-Modus, sonst 0
+    unsigned int sampleMask;        // Von plot und span geschriebene Samples
+    int clipLeft, clipTop, clipRight, clipBottom;   // right/bottom exklusiv
+    DirtyRect modified;
+
+    QVector3D color;
+    QRgb rgb;
+
+    std::vector<Edge> edges;
+    std::vector<Edge*> active;
+    std::vector<std::pair<double, int> > crossings;
+    std::vector<Line> segments;
+};
+
+#endif // PRIMITIVES_H
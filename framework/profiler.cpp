@@ -0,0 +1,334 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "profiler.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <chrono>
+#include <vector>
+
+// Zonen je Thread und Aufzeichnung (40 Byte je Zone), wird beim ersten Eintrag angelegt
+static const int ZonesPerThread = 1 << 16;
+
+struct Profiler::ThreadBuffer
+{
+    struct Zone
+    {
+        const char* name;
+        qint64 start, end;
+        qint64 bytes;
+        int allocations;
+    };
+
+    explicit ThreadBuffer(int id) :
+        id(id), inUse(true), session(0), count(0), dropped(0), zones(ZonesPerThread)
+    {
+    }
+
+    const int id;
+    QString name;                   // Nur unter Profiler::mutex
+    bool inUse;                     // Nur unter Profiler::mutex
+
+    // Schreibt nur der besitzende Thread. Mit session wird count veröffentlicht:
+    // Wer die aktuelle Aufzeichnung sieht, sieht auch das zurückgesetzte count.
+    std::atomic<unsigned> session;
+    std::atomic<int> count;
+    std::atomic<int> dropped;
+    std::vector<Zone> zones;
+};
+
+// Gibt den Puffer am Ende des Threads für den nächsten Thread frei
+struct ThreadState
+{
+    ThreadState() : buffer(0) {}
+
+    ~ThreadState()
+    {
+        if(buffer)
+            Profiler::instance().releaseBuffer(buffer);
+    }
+
+    Profiler::ThreadBuffer* buffer;
+    QString name;
+};
+
+static thread_local ThreadState threadState;
+
+std::atomic<bool> Profiler::recording(false);
+
+Profiler::Profiler() : session(0), sessionStart(0)
+{
+}
+
+Profiler::~Profiler()
+{
+    qDeleteAll(buffers);
+}
+
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::start()
+{
+    // Ein laufender Export liest die Zonen der bisherigen Aufzeichnung noch ohne mutex
+    QMutexLocker exportLock(&exportMutex);
+    QMutexLocker lock(&mutex);
+
+    // Die Threads setzen ihren Puffer beim nächsten Eintrag selbst zurück
+    sessionStart = now();
+    session.fetch_add(1, std::memory_order_release);
+    recording.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::stop()
+{
+    recording.store(false, std::memory_order_relaxed);
+}
+
+qint64 Profiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+AllocationTracker::Counters Profiler::enterZone()
+{
+    ThreadState& state = threadState;
+    if(!state.buffer)
+        state.buffer = instance().acquireBuffer();
+
+    return AllocationTracker::thread();
+}
+
+void Profiler::record(const char* name, qint64 start, qint64 end, const AllocationTracker::Counters& allocations)
+{
+    const AllocationTracker::Counters allocated = AllocationTracker::thread() - allocations;
+
+    Profiler& profiler = instance();
+
+    ThreadState& state = threadState;
+    if(!state.buffer)
+        state.buffer = profiler.acquireBuffer();
+
+    ThreadBuffer& buffer = *state.buffer;
+
+    const unsigned current = profiler.session.load(std::memory_order_acquire);
+    if(buffer.session.load(std::memory_order_relaxed) != current)
+    {
+        buffer.count.store(0, std::memory_order_relaxed);
+        buffer.dropped.store(0, std::memory_order_relaxed);
+        buffer.session.store(current, std::memory_order_release);
+    }
+
+    const int index = buffer.count.load(std::memory_order_relaxed);
+    if(index >= ZonesPerThread)
+    {
+        buffer.dropped.store(buffer.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    ThreadBuffer::Zone& zone = buffer.zones[index];
+    zone.name = name;
+    zone.start = start;
+    zone.end = end;
+    zone.allocations = static_cast<int>(allocated.allocations);
+    zone.bytes = allocated.bytes;
+
+    // Erst jetzt ist die Zone für exportChromeTrace sichtbar
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const QString& name)
+{
+    ThreadState& state = threadState;
+    state.name = name;
+
+    if(state.buffer)
+    {
+        Profiler& profiler = instance();
+        QMutexLocker lock(&profiler.mutex);
+        state.buffer->name = name;
+    }
+}
+
+Profiler::ThreadBuffer* Profiler::acquireBuffer()
+{
+    QMutexLocker lock(&mutex);
+
+    const unsigned current = session.load(std::memory_order_relaxed);
+    ThreadBuffer* buffer = 0;
+
+    // Puffer beendeter Threads wiederverwenden, sofern sie nichts zur laufenden Aufzeichnung beitragen
+    for(int n = 0; n < buffers.size() && !buffer; n++)
+    {
+        if(!buffers[n]->inUse && buffers[n]->session.load(std::memory_order_acquire) != current)
+            buffer = buffers[n];
+    }
+
+    if(!buffer)
+    {
+        buffer = new ThreadBuffer(buffers.size() + 1);
+        buffers.append(buffer);
+    }
+
+    buffer->inUse = true;
+    buffer->name = !threadState.name.isEmpty() ? threadState.name : QString("Thread %1").arg(buffer->id);
+    return buffer;
+}
+
+void Profiler::releaseBuffer(ThreadBuffer* buffer)
+{
+    QMutexLocker lock(&mutex);
+    buffer->inUse = false;
+}
+
+int Profiler::recordedZones()
+{
+    QMutexLocker lock(&mutex);
+
+    const unsigned current = session.load(std::memory_order_relaxed);
+    int zones = 0;
+    for(int n = 0; n < buffers.size(); n++)
+    {
+        if(buffers[n]->session.load(std::memory_order_acquire) == current)
+            zones += buffers[n]->count.load(std::memory_order_acquire);
+    }
+
+    return zones;
+}
+
+int Profiler::droppedZones()
+{
+    QMutexLocker lock(&mutex);
+
+    const unsigned current = session.load(std::memory_order_relaxed);
+    int zones = 0;
+    for(int n = 0; n < buffers.size(); n++)
+    {
+        if(buffers[n]->session.load(std::memory_order_acquire) == current)
+            zones += buffers[n]->dropped.load(std::memory_order_relaxed);
+    }
+
+    return zones;
+}
+
+static QString jsonString(const QString& text)
+{
+    QString escaped;
+    escaped.reserve(text.size() + 2);
+    escaped += '"';
+
+    for(int n = 0; n < text.size(); n++)
+    {
+        const QChar c = text.at(n);
+        if(c == '"' || c == '\\')
+            escaped += QString('\\') + c;
+        else if(c.unicode() < 0x20)
+            escaped += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+        else
+            escaped += c;
+    }
+
+    escaped += '"';
+    return escaped;
+}
+
+bool Profiler::exportChromeTrace(const QString& fileName)
+{
+    QMutexLocker exportLock(&exportMutex);
+    error.clear();
+
+    // Nur den Stand der Puffer unter mutex festhalten, damit Threads beim
+    // Schreiben der Datei weiter Puffer anlegen und benennen können. Die
+    // Zonen unterhalb von count ändern sich bis zum nächsten start nicht.
+    struct Snapshot
+    {
+        int id;
+        QString name;
+        int count;
+        const ThreadBuffer::Zone* zones;
+    };
+
+    QVector<Snapshot> threads;
+    qint64 origin;
+    {
+        QMutexLocker lock(&mutex);
+        origin = sessionStart;
+
+        const unsigned current = session.load(std::memory_order_relaxed);
+        for(int n = 0; n < buffers.size(); n++)
+        {
+            const ThreadBuffer& buffer = *buffers[n];
+            if(buffer.session.load(std::memory_order_acquire) != current)
+                continue;
+
+            // Neue Zonen des Threads dürfen danach hinzukommen, exportiert wird der Stand von jetzt
+            Snapshot snapshot = { buffer.id, buffer.name, buffer.count.load(std::memory_order_acquire), buffer.zones.data() };
+            threads.append(snapshot);
+        }
+    }
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        error = QString("Could not open '%1' for writing.").arg(fileName);
+        return false;
+    }
+
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    out.setRealNumberNotation(QTextStream::FixedNotation);
+    out.setRealNumberPrecision(3);
+
+    // Zeiten im Trace Event Format in Mikrosekunden seit start
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":"
+        << jsonString(QCoreApplication::applicationName()) << "}}";
+
+    const bool allocations = AllocationTracker::isAvailable();
+    for(int n = 0; n < threads.size(); n++)
+    {
+        const Snapshot& thread = threads[n];
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.id
+            << ",\"args\":{\"name\":" << jsonString(thread.name) << "}}";
+
+        for(int z = 0; z < thread.count; z++)
+        {
+            const ThreadBuffer::Zone& zone = thread.zones[z];
+            out << ",\n{\"name\":" << jsonString(QString::fromUtf8(zone.name))
+                << ",\"cat\":\"gdv\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.id
+                << ",\"ts\":" << (zone.start - origin) / 1000.0
+                << ",\"dur\":" << (zone.end - zone.start) / 1000.0;
+            if(allocations)
+                out << ",\"args\":{\"allocations\":" << zone.allocations << ",\"bytes\":" << zone.bytes << "}";
+            out << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    out.flush();
+
+    if(out.status() != QTextStream::Ok || file.error() != QFile::NoError)
+    {
+        error = QString("Could not write '%1'.").arg(fileName);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,150 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QString>
+#include <QMutex>
+#include <QVector>
+#include <atomic>
+#include "allocationtracker.h"
+
+/**
+ * @brief Die Profiler Klasse
+ *
+ * Zeichnet auf, wie lange die einzelnen Abschnitte (Zonen) eines Bildes
+ * dauern, z.B. render, clear, flip und present. Zonen werden mit
+ * GDV_PROFILE_ZONE markiert und dürfen beliebig verschachtelt werden; jeder
+ * Thread schreibt dabei ohne Sperren in seinen eigenen Puffer.
+ *
+ * Solange nicht aufgezeichnet wird, kostet eine Zone nur eine Abfrage von
+ * isRecording. Die Aufzeichnung kann mit exportChromeTrace im Trace Event
+ * Format gespeichert und in chrome://tracing oder ui.perfetto.dev
+ * betrachtet werden.
+ *
+ * Ist der Puffer eines Threads voll, werden dessen weitere Zonen verworfen
+ * (siehe droppedZones).
+ *
+ * Ist der AllocationTracker verfügbar, enthält jede Zone zusätzlich die
+ * Speicheranforderungen ihres Threads während der Zone.
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class Profiler
+{
+public:
+    static Profiler& instance();
+
+    /**
+     * @brief start Verwirft die bisherige Aufzeichnung und beginnt eine neue
+     */
+    void start();
+    void stop();
+
+    static bool isRecording() { return recording.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief exportChromeTrace Speichert die Zonen der letzten Aufzeichnung als JSON
+     * @return false, falls die Datei nicht geschrieben werden konnte (siehe errorString)
+     */
+    bool exportChromeTrace(const QString& fileName);
+    QString errorString() const { return error; }
+
+    int recordedZones();
+    int droppedZones();
+
+    /**
+     * @brief setThreadName Name des aufrufenden Threads in der Aufzeichnung
+     */
+    static void setThreadName(const QString& name);
+
+    /**
+     * @brief now Monotone Zeit in Nanosekunden
+     */
+    static qint64 now();
+
+    /**
+     * @brief enterZone Legt ggf. den Puffer des aufrufenden Threads an
+     * @return AllocationTracker::thread(), danach angefordert
+     *
+     * So zählt der Speicher für den Puffer nicht zu den umgebenden Zonen.
+     */
+    static AllocationTracker::Counters enterZone();
+
+    /**
+     * @brief record Trägt eine abgeschlossene Zone des aufrufenden Threads ein
+     * @param name Muss bis zum Export gültig bleiben, in der Regel ein Zeichenkettenliteral
+     * @param allocations Der Rückgabewert von enterZone
+     */
+    static void record(const char* name, qint64 start, qint64 end, const AllocationTracker::Counters& allocations);
+
+private:
+    struct ThreadBuffer;
+
+    Profiler();
+    ~Profiler();
+    Profiler(const Profiler&);
+    Profiler& operator=(const Profiler&);
+
+    ThreadBuffer* acquireBuffer();
+    void releaseBuffer(ThreadBuffer* buffer);
+
+    static std::atomic<bool> recording;
+    std::atomic<unsigned> session;
+    qint64 sessionStart;
+
+    QMutex mutex;
+    QMutex exportMutex;                 // Hält start zurück, solange exportChromeTrace die Zonen liest
+    QVector<ThreadBuffer*> buffers;
+    QString error;
+
+    friend struct ThreadState;
+};
+
+/**
+ * @brief Die ProfileZone Klasse
+ *
+ * Misst die Zeit von der Konstruktion bis zum Ende des Gültigkeitsbereichs.
+ * Statt direkt wird sie über GDV_PROFILE_ZONE verwendet.
+ */
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* name) : name(Profiler::isRecording() ? name : 0), start(0)
+    {
+        if(this->name)
+        {
+            allocations = Profiler::enterZone();
+            start = Profiler::now();
+        }
+    }
+
+    ~ProfileZone()
+    {
+        if(name)
+            Profiler::record(name, start, Profiler::now(), allocations);
+    }
+
+private:
+    ProfileZone(const ProfileZone&);
+    ProfileZone& operator=(const ProfileZone&);
+
+    const char* name;
+    qint64 start;
+    AllocationTracker::Counters allocations;
+};
+
+#define GDV_PROFILE_CONCAT_(a, b) a##b
+#define GDV_PROFILE_CONCAT(a, b) GDV_PROFILE_CONCAT_(a, b)
+
+/**
+ * GDV_PROFILE_ZONE("Name") misst den Rest des umgebenden Blocks als Zone "Name".
+ */
+#define GDV_PROFILE_ZONE(name) ProfileZone GDV_PROFILE_CONCAT(gdvProfileZone, __LINE__)(name)
+
+#endif // PROFILER_H
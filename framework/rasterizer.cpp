@@ -0,0 +1,482 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "rasterizer.h"
+#include "bufferaccess.h"
+#include "pixelconversion.h"
+#include "dirtyrect.h"
+#include "depthbuffer.h"
+#include "workerpool.h"
+#include "simd.h"
+
+#include <algorithm>
+
+namespace
+{
+    const int SubpixelBits = 4;
+    const int SubpixelScale = 1 << SubpixelBits;
+    const float GuardBand = 8192.0f;
+
+    // Kantenfunktionen werden zeilenweise auf diesen Bereich begrenzt. Über
+    // eine Kachel ändern sie sich um weniger als 2^28, das Vorzeichen bleibt
+    // also erhalten und die Werte passen in 32 Bit.
+    const long long EdgeLimit = 1LL << 30;
+
+    void attributes(const MeshLoader::VertexInfo& vertex, float* values)
+    {
+        values[0] = vertex.z;
+        values[1] = vertex.nx;
+        values[2] = vertex.ny;
+        values[3] = vertex.nz;
+        values[4] = vertex.u;
+        values[5] = vertex.v;
+        values[6] = vertex.r;
+        values[7] = vertex.g;
+        values[8] = vertex.b;
+    }
+
+    inline int clampEdge(long long value)
+    {
+        return static_cast<int>(qBound(-EdgeLimit, value, EdgeLimit));
+    }
+}
+
+Rasterizer::Rasterizer() :
+    tileSize(64), gridLeft(0), gridTop(0), tilesX(0), tilesY(0)
+{
+}
+
+void Rasterizer::drawTriangles(GdvCanvas& canvas, const QVector<MeshLoader::Face>& faces)
+{
+    draw(canvas, faces, 0);
+}
+
+void Rasterizer::drawTriangles(GdvCanvas& canvas, const QVector<MeshLoader::Face>& faces, const FragmentShader& shader)
+{
+    draw(canvas, faces, shader ? &shader : 0);
+}
+
+void Rasterizer::draw(GdvCanvas& canvas, const QVector<MeshLoader::Face>& faces, const FragmentShader* shader)
+{
+    region = canvas.clipRect();
+    if(region.isEmpty() || faces.isEmpty())
+        return;
+
+    // Im Multisampling-Modus direkt in die Samples, ohne den Back-Buffer abzubilden
+    MultisampleBuffer* samples = canvas.multisampleBuffer();
+    GdvCanvas::BufferMapping mapping;
+
+    if(!samples)
+    {
+        mapping = canvas.mapBuffer();
+        if(!mapping.isValid())
+        {
+            canvas.unmapBuffer(QRect());
+            return;
+        }
+    }
+
+    // 1. Dreiecke parallel vorbereiten
+    const int faceCount = faces.size();
+    const int chunkSize = 256;
+    setups.resize(faceCount);
+
+    WorkerPool::instance().run((faceCount + chunkSize - 1) / chunkSize, [&](int chunk)
+    {
+        const int last = qMin(faceCount, (chunk + 1) * chunkSize);
+        for(int n = chunk * chunkSize; n < last; n++)
+            setupTriangle(faces[n], setups[n]);
+    });
+
+    // 2. In Kacheln einsortieren, die Reihenfolge bleibt dabei erhalten. Die
+    // Kacheln liegen auf einem festen Raster, damit sich zwei Threads nie
+    // eine Kachel des Tiefenpuffers teilen.
+    gridLeft = region.left() - region.left() % tileSize;
+    gridTop = region.top() - region.top() % tileSize;
+    tilesX = (region.right() - gridLeft) / tileSize + 1;
+    tilesY = (region.bottom() - gridTop) / tileSize + 1;
+
+    bins.resize(tilesX * tilesY);
+    for(size_t n = 0; n < bins.size(); n++)
+        bins[n].clear();
+
+    DirtyRect modified;
+    for(int n = 0; n < faceCount; n++)
+    {
+        const Setup& setup = setups[n];
+        if(!setup.visible)
+            continue;
+
+        const int firstX = (setup.minX - gridLeft) / tileSize;
+        const int lastX = (setup.maxX - gridLeft) / tileSize;
+        const int firstY = (setup.minY - gridTop) / tileSize;
+        const int lastY = (setup.maxY - gridTop) / tileSize;
+
+        for(int ty = firstY; ty <= lastY; ty++)
+            for(int tx = firstX; tx <= lastX; tx++)
+                bins[ty * tilesX + tx].push_back(n);
+
+        modified.add(setup.minX, setup.minY, setup.maxX - setup.minX + 1, setup.maxY - setup.minY + 1);
+    }
+
+    // 3. Kacheln parallel zeichnen
+    DepthBuffer* depth = canvas.depthBuffer();
+    if(depth && (depth->width() != mapping.width || depth->height() != mapping.height))
+        depth = 0;
+
+    // Mit Multisampling übernimmt der z-Wert je Sample den Tiefentest
+    const bool sampleDepth = samples && canvas.depthBuffer() && samples->hasDepth();
+
+    WorkerPool::instance().run(tilesX * tilesY, [&](int index)
+    {
+        if(bins[index].empty())
+            return;
+
+        const QRect tile = QRect(gridLeft + (index % tilesX) * tileSize,
+                                 gridTop + (index / tilesX) * tileSize,
+                                 tileSize, tileSize).intersected(region);
+        if(samples)
+            rasterizeTileSamples(*samples, sampleDepth, tile, bins[index], shader);
+        else
+            rasterizeTile(mapping, depth, tile, bins[index], shader);
+    });
+
+    if(samples)
+        samples->markModified(modified.toRect());
+    else
+        canvas.unmapBuffer(modified.toRect());
+}
+
+void Rasterizer::setupTriangle(const MeshLoader::Face& face, Setup& setup) const
+{
+    setup.visible = false;
+
+    const MeshLoader::VertexInfo* vertex[3] = { &face[0], &face[1], &face[2] };
+    int fx[3], fy[3];
+
+    for(int n = 0; n < 3; n++)
+    {
+        // Negiert, damit auch NaN verworfen wird
+        if(!(vertex[n]->x > region.left() - GuardBand && vertex[n]->x < region.right() + GuardBand &&
+             vertex[n]->y > region.top() - GuardBand && vertex[n]->y < region.bottom() + GuardBand))
+            return;
+
+        fx[n] = qRound(vertex[n]->x * SubpixelScale);
+        fy[n] = qRound(vertex[n]->y * SubpixelScale);
+    }
+
+    long long area = static_cast<long long>(fx[1] - fx[0]) * (fy[2] - fy[0]) -
+                     static_cast<long long>(fy[1] - fy[0]) * (fx[2] - fx[0]);
+    if(area == 0)
+        return;
+
+    // Einheitlicher Umlaufsinn, damit innen alle Kantenfunktionen >= 0 sind
+    if(area < 0)
+    {
+        std::swap(vertex[1], vertex[2]);
+        std::swap(fx[1], fx[2]);
+        std::swap(fy[1], fy[2]);
+        area = -area;
+    }
+
+    // Umschließendes Rechteck, beschränkt auf den Zeichenbereich
+    setup.minX = qMax(std::min(std::min(fx[0], fx[1]), fx[2]) >> SubpixelBits, region.left());
+    setup.maxX = qMin(std::max(std::max(fx[0], fx[1]), fx[2]) >> SubpixelBits, region.right());
+    setup.minY = qMax(std::min(std::min(fy[0], fy[1]), fy[2]) >> SubpixelBits, region.top());
+    setup.maxY = qMin(std::max(std::max(fy[0], fy[1]), fy[2]) >> SubpixelBits, region.bottom());
+
+    if(setup.minX > setup.maxX || setup.minY > setup.maxY)
+        return;
+
+    for(int n = 0; n < 3; n++)
+    {
+        const int next = (n + 1) % 3;
+        setup.a[n] = fy[n] - fy[next];
+        setup.b[n] = fx[next] - fx[n];
+        setup.c[n] = -static_cast<long long>(setup.b[n]) * fy[n] - static_cast<long long>(setup.a[n]) * fx[n];
+
+        // Füllregel: Pixel genau auf einer Kante gehören nur einem der beiden
+        // angrenzenden Dreiecke (deren Kanten entgegengesetzt orientiert sind)
+        if(!(setup.a[n] > 0 || (setup.a[n] == 0 && setup.b[n] > 0)))
+            setup.c[n] -= 1;
+    }
+
+    // Ebenengleichungen f(x, y) = value + dx * (x - originX) + dy * (y - originY)
+    float values[3][AttributeCount];
+    for(int n = 0; n < 3; n++)
+        attributes(*vertex[n], values[n]);
+
+    const double x1 = (fx[1] - fx[0]) / static_cast<double>(SubpixelScale);
+    const double y1 = (fy[1] - fy[0]) / static_cast<double>(SubpixelScale);
+    const double x2 = (fx[2] - fx[0]) / static_cast<double>(SubpixelScale);
+    const double y2 = (fy[2] - fy[0]) / static_cast<double>(SubpixelScale);
+    const double invDet = 1.0 / (x1 * y2 - x2 * y1);
+
+    setup.nearestZ = qMin(qMin(vertex[0]->z, vertex[1]->z), vertex[2]->z);
+    setup.originX = fx[0] / static_cast<float>(SubpixelScale);
+    setup.originY = fy[0] / static_cast<float>(SubpixelScale);
+
+    for(int k = 0; k < AttributeCount; k++)
+    {
+        const double d1 = values[1][k] - values[0][k];
+        const double d2 = values[2][k] - values[0][k];
+        setup.value[k] = values[0][k];
+        setup.dx[k] = static_cast<float>((d1 * y2 - d2 * y1) * invDet);
+        setup.dy[k] = static_cast<float>((d2 * x1 - d1 * x2) * invDet);
+    }
+
+    setup.visible = true;
+}
+
+void Rasterizer::rasterizeTile(const GdvCanvas::BufferMapping& mapping, DepthBuffer* depth, const QRect& tile,
+                               const std::vector<int>& bin, const FragmentShader* shader) const
+{
+    MeshLoader::VertexInfo fragment;
+
+    for(size_t index = 0; index < bin.size(); index++)
+    {
+        const Setup& setup = setups[bin[index]];
+
+        const int firstX = qMax(setup.minX, tile.left());
+        const int lastX = qMin(setup.maxX, tile.right());
+        const int firstY = qMax(setup.minY, tile.top());
+        const int lastY = qMin(setup.maxY, tile.bottom());
+
+        // Ganz verdeckte Dreiecke ohne einen einzigen Pixeltest verwerfen
+        if(depth && depth->isOccluded(QRect(firstX, firstY, lastX - firstX + 1, lastY - firstY + 1), setup.nearestZ))
+            continue;
+
+        // Blöcke beginnen an durch 4 teilbaren x-Koordinaten, damit sie nie
+        // über den Rand der (an 64 Pixeln ausgerichteten) Kachel ragen
+        const int firstBlockX = firstX & ~3;
+
+#ifdef GDV_SSE2
+        __m128i laneOffset[3], blockStep[3];
+        for(int n = 0; n < 3; n++)
+        {
+            const int step = setup.a[n] * SubpixelScale;
+            laneOffset[n] = _mm_set_epi32(3 * step, 2 * step, step, 0);
+            blockStep[n] = _mm_set1_epi32(4 * step);
+        }
+#endif
+
+        for(int y = firstY; y <= lastY; y++)
+        {
+            // Kantenfunktionen in der Mitte des ersten Pixels der Zeile
+            const long long sampleX = static_cast<long long>(firstBlockX) * SubpixelScale + SubpixelScale / 2;
+            const long long sampleY = static_cast<long long>(y) * SubpixelScale + SubpixelScale / 2;
+
+            int edge[3];
+            for(int n = 0; n < 3; n++)
+                edge[n] = clampEdge(setup.a[n] * sampleX + setup.b[n] * sampleY + setup.c[n]);
+
+            const float rowY = y + 0.5f - setup.originY;
+
+#ifdef GDV_SSE2
+            __m128i e0 = _mm_add_epi32(_mm_set1_epi32(edge[0]), laneOffset[0]);
+            __m128i e1 = _mm_add_epi32(_mm_set1_epi32(edge[1]), laneOffset[1]);
+            __m128i e2 = _mm_add_epi32(_mm_set1_epi32(edge[2]), laneOffset[2]);
+#endif
+
+            for(int x = firstBlockX; x <= lastX; x += 4)
+            {
+                // Bit n gesetzt: Pixel x+n liegt im Dreieck
+                int mask;
+#ifdef GDV_SSE2
+                const __m128i outside = _mm_or_si128(_mm_or_si128(e0, e1), e2);
+                mask = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xf;
+
+                e0 = _mm_add_epi32(e0, blockStep[0]);
+                e1 = _mm_add_epi32(e1, blockStep[1]);
+                e2 = _mm_add_epi32(e2, blockStep[2]);
+#else
+                mask = 0;
+                for(int lane = 0; lane < 4; lane++)
+                {
+                    const int step = lane * SubpixelScale;
+                    if(((edge[0] + setup.a[0] * step) | (edge[1] + setup.a[1] * step) | (edge[2] + setup.a[2] * step)) >= 0)
+                        mask |= 1 << lane;
+                }
+
+                for(int n = 0; n < 3; n++)
+                    edge[n] += 4 * SubpixelScale * setup.a[n];
+#endif
+
+                if(x < firstX)
+                    mask &= ~((1 << (firstX - x)) - 1);
+                if(lastX - x < 3)
+                    mask &= (1 << (lastX - x + 1)) - 1;
+
+                if(!mask)
+                    continue;
+
+                const float blockX = x + 0.5f - setup.originX;
+
+                if(depth)
+                {
+                    // Grobe Prüfung gegen die 8x8-Kachel, dann vier Pixel auf einmal
+                    if(setup.nearestZ >= depth->maxDepthAt(x, y))
+                        continue;
+
+                    const float rowZ = setup.value[0] + setup.dy[0] * rowY;
+                    float z[4];
+                    for(int lane = 0; lane < 4; lane++)
+                        z[lane] = rowZ + setup.dx[0] * (blockX + lane);
+
+                    mask = depth->testAndWrite4(x, y, z, mask);
+                    if(!mask)
+                        continue;
+                }
+
+#ifdef GDV_SSE2
+                if(!shader && mask == 0xf && mapping.format == GdvCanvas::FormatRGB32)
+                {
+                    // Vier Pixel mit interpolierter Vertex-Farbe am Stück, in
+                    // derselben Rechenreihenfolge wie shade und PixelConversion::toRgb
+                    const __m128 offsetX = _mm_sub_ps(_mm_add_ps(_mm_set1_ps(static_cast<float>(x)), _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f)),
+                                                      _mm_set1_ps(setup.originX));
+                    const __m128 scale = _mm_set1_ps(255.0f);
+                    __m128i channel[3];
+
+                    for(int n = 0; n < 3; n++)
+                    {
+                        const int k = 6 + n;
+                        __m128 value = _mm_add_ps(_mm_add_ps(_mm_set1_ps(setup.value[k]), _mm_mul_ps(_mm_set1_ps(setup.dx[k]), offsetX)),
+                                                  _mm_set1_ps(setup.dy[k] * rowY));
+                        value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+                        channel[n] = _mm_cvttps_epi32(_mm_mul_ps(value, scale));
+                    }
+
+                    const __m128i pixels = _mm_or_si128(_mm_or_si128(_mm_set1_epi32(0xff000000), _mm_slli_epi32(channel[0], 16)),
+                                                        _mm_or_si128(_mm_slli_epi32(channel[1], 8), channel[2]));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(mapping.rgbLine(y) + x), pixels);
+                    continue;
+                }
+#endif
+
+                for(int lane = 0; lane < 4; lane++)
+                {
+                    if(!(mask & (1 << lane)))
+                        continue;
+
+                    // Wie im SSE-Zweig begrenzen, statt in qRgb überlaufen zu lassen
+                    const QVector3D color = shade(setup, x + lane, y, shader, fragment);
+                    if(mapping.format == GdvCanvas::FormatRGB32)
+                        mapping.rgbLine(y)[x + lane] = PixelConversion::toRgb(color);
+                    else
+                        BufferAccess::setPixel(mapping, x + lane, y, color);
+                }
+            }
+        }
+    }
+}
+
+void Rasterizer::rasterizeTileSamples(MultisampleBuffer& samples, bool depthTest, const QRect& tile,
+                                      const std::vector<int>& bin, const FragmentShader* shader) const
+{
+    MeshLoader::VertexInfo fragment;
+
+    // Sample-Positionen innerhalb des Pixels in 1/16 Pixeln
+    const int sampleCount = samples.sampleCount();
+    int sampleX[MultisampleBuffer::MaxSamples], sampleY[MultisampleBuffer::MaxSamples];
+    float depthX[MultisampleBuffer::MaxSamples], depthY[MultisampleBuffer::MaxSamples];
+    for(int s = 0; s < sampleCount; s++)
+    {
+        const QPointF position = samples.samplePosition(s);
+        sampleX[s] = qRound(position.x() * SubpixelScale);
+        sampleY[s] = qRound(position.y() * SubpixelScale);
+        depthX[s] = static_cast<float>(position.x());
+        depthY[s] = static_cast<float>(position.y());
+    }
+
+    for(size_t index = 0; index < bin.size(); index++)
+    {
+        const Setup& setup = setups[bin[index]];
+
+        const int firstX = qMax(setup.minX, tile.left());
+        const int lastX = qMin(setup.maxX, tile.right());
+        const int firstY = qMax(setup.minY, tile.top());
+        const int lastY = qMin(setup.maxY, tile.bottom());
+
+        for(int y = firstY; y <= lastY; y++)
+        {
+            // Kantenfunktionen an den Samples des ersten Pixels der Zeile
+            int edge[MultisampleBuffer::MaxSamples][3];
+            for(int s = 0; s < sampleCount; s++)
+            {
+                const long long positionX = static_cast<long long>(firstX) * SubpixelScale + sampleX[s];
+                const long long positionY = static_cast<long long>(y) * SubpixelScale + sampleY[s];
+                for(int n = 0; n < 3; n++)
+                    edge[s][n] = clampEdge(setup.a[n] * positionX + setup.b[n] * positionY + setup.c[n]);
+            }
+
+            for(int x = firstX; x <= lastX; x++)
+            {
+                // Bit s gesetzt: Sample s liegt im Dreieck
+                unsigned int mask = 0;
+                for(int s = 0; s < sampleCount; s++)
+                {
+                    if((edge[s][0] | edge[s][1] | edge[s][2]) >= 0)
+                        mask |= 1u << s;
+
+                    for(int n = 0; n < 3; n++)
+                        edge[s][n] += SubpixelScale * setup.a[n];
+                }
+
+                if(!mask)
+                    continue;
+
+                if(depthTest)
+                {
+                    for(int s = 0; s < sampleCount; s++)
+                    {
+                        if(!(mask & (1u << s)))
+                            continue;
+
+                        const float z = setup.value[0] + setup.dx[0] * (x + depthX[s] - setup.originX)
+                                                       + setup.dy[0] * (y + depthY[s] - setup.originY);
+                        if(!samples.testAndWriteDepth(x, y, s, z))
+                            mask &= ~(1u << s);
+                    }
+
+                    if(!mask)
+                        continue;
+                }
+
+                samples.write(x, y, mask, shade(setup, x, y, shader, fragment));
+            }
+        }
+    }
+}
+
+QVector3D Rasterizer::shade(const Setup& setup, int x, int y, const FragmentShader* shader, MeshLoader::VertexInfo& fragment) const
+{
+    // Attribute in der Pixelmitte
+    const float offsetX = x + 0.5f - setup.originX;
+    const float offsetY = y + 0.5f - setup.originY;
+    float value[AttributeCount];
+    for(int k = 0; k < AttributeCount; k++)
+        value[k] = setup.value[k] + setup.dx[k] * offsetX + setup.dy[k] * offsetY;
+
+    if(!shader)
+        return QVector3D(value[6], value[7], value[8]);
+
+    fragment.x = x + 0.5f;
+    fragment.y = y + 0.5f;
+    fragment.z = value[0];
+    fragment.nx = value[1];
+    fragment.ny = value[2];
+    fragment.nz = value[3];
+    fragment.u = value[4];
+    fragment.v = value[5];
+    fragment.r = value[6];
+    fragment.g = value[7];
+    fragment.b = value[8];
+    return (*shader)(fragment);
+}
@@ -0,0 +1,114 @@
+#ifndef RASTERIZER_H
+#define RASTERIZER_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include "interfaces/GdvCanvas.h"
+#include "meshloader.h"
+#include "depthbuffer.h"
+#include "multisamplebuffer.h"
+
+#include <QRect>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Die Rasterizer Klasse
+ *
+ * Zeichnet Dreiecke, deren Vertices bereits in Bildschirmkoordinaten
+ * vorliegen (x, y in Pixeln, z beliebig), in eine Zeichenfläche. Alle
+ * übrigen Werte des VertexInfo-Structs (z, Normale, UV, Farbe) werden
+ * linear über das Dreieck interpoliert.
+ *
+ * Ohne FragmentShader wird die interpolierte Vertex-Farbe gezeichnet.
+ * Mit FragmentShader wird dieser für jedes überdeckte Pixel mit den
+ * interpolierten Werten aufgerufen (x und y enthalten die Pixelmitte) und
+ * liefert die Farbe des Pixels.
+ *
+ * Beispiel zur Verwendung in render:
+ *
+ * QVector<MeshLoader::Face> screenFaces = ...; // eigene Projektion
+ * canvas.clearBuffer(QVector3D(0, 0, 0));
+ * rasterizer.drawTriangles(canvas, screenFaces);
+ * canvas.flipBuffer();
+ *
+ * FÜR FORTGESCHRITTENE:
+ * Die Dreiecke werden zunächst in Kacheln einsortiert ("sort-middle
+ * binning"), die Kacheln anschließend auf allen Prozessorkernen gezeichnet.
+ * Innerhalb einer Kachel bleibt die Reihenfolge der Dreiecke erhalten. Die
+ * Überdeckung wird mit Kantenfunktionen auf 1/16 Pixel genau in
+ * Festkommazahlen für jeweils vier Pixel gleichzeitig berechnet (SSE2);
+ * Kanten, die sich zwei Dreiecke teilen, werden genau einmal gezeichnet.
+ *
+ * Stellt die Zeichenfläche einen Tiefenpuffer bereit (siehe
+ * RendererBase::usesDepthBuffer), werden nur Pixel gezeichnet, deren
+ * interpoliertes z kleiner ist als der gespeicherte Wert. Verdeckte
+ * Dreiecke und Blöcke werden dabei anhand des größten z-Werts je 8x8 Pixel
+ * verworfen, bevor der FragmentShader aufgerufen wird.
+ *
+ * Im Multisampling-Modus (siehe RendererBase::sampleCount) wird die
+ * Überdeckung an jeder Sample-Position bestimmt. Der FragmentShader wird
+ * weiterhin nur einmal je Pixel (in der Pixelmitte) aufgerufen, seine
+ * Farbe aber nur in die überdeckten Samples geschrieben. Der Tiefentest
+ * erfolgt dann je Sample, sodass auch Kanten zwischen sich schneidenden
+ * Dreiecken geglättet werden.
+ *
+ * Wichtig: Der FragmentShader wird gleichzeitig aus mehreren Threads
+ * aufgerufen! Er darf Membervariablen nur lesen, aber nicht verändern.
+ * Dreiecke mit Vertices weiter als 8192 Pixel ausserhalb des Viewports
+ * werden nicht gezeichnet.
+ */
+class Rasterizer
+{
+public:
+    typedef std::function<QVector3D(const MeshLoader::VertexInfo& fragment)> FragmentShader;
+
+    Rasterizer();
+
+    void drawTriangles(GdvCanvas& canvas, const QVector<MeshLoader::Face>& faces);
+    void drawTriangles(GdvCanvas& canvas, const QVector<MeshLoader::Face>& faces, const FragmentShader& shader);
+
+private:
+    enum { AttributeCount = 9 };
+
+    // Vorberechnete Werte eines Dreiecks
+    struct Setup
+    {
+        bool visible;
+        int minX, minY, maxX, maxY;     // Umschließendes Rechteck in Pixeln (inklusiv)
+
+        // Kantenfunktionen E(x, y) = a*x + b*y + c in 1/16 Pixeln, inkl. Füllregel
+        int a[3], b[3];
+        long long c[3];
+
+        float nearestZ;                 // Kleinster z-Wert der drei Vertices
+
+        // Ebenengleichungen der Attribute relativ zum ersten Vertex
+        float originX, originY;
+        float value[AttributeCount], dx[AttributeCount], dy[AttributeCount];
+    };
+
+    void setupTriangle(const MeshLoader::Face& face, Setup& setup) const;
+    QVector3D shade(const Setup& setup, int x, int y, const FragmentShader* shader, MeshLoader::VertexInfo& fragment) const;
+    void rasterizeTile(const GdvCanvas::BufferMapping& mapping, DepthBuffer* depth, const QRect& tile,
+                       const std::vector<int>& bin, const FragmentShader* shader) const;
+    void rasterizeTileSamples(MultisampleBuffer& samples, bool depthTest, const QRect& tile,
+                              const std::vector<int>& bin, const FragmentShader* shader) const;
+
+    void draw(GdvCanvas& canvas, const QVector<MeshLoader::Face>& faces, const FragmentShader* shader);
+
+    int tileSize;
+    QRect region;
+    int gridLeft, gridTop;
+    int tilesX, tilesY;
+
+    std::vector<Setup> setups;
+    std::vector<std::vector<int> > bins;
+};
+
+#endif // RASTERIZER_H
@@ -0,0 +1,138 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "renderthread.h"
+#include "gdvcanvas2d.h"
+#include "tilerenderer.h"
+#include "performancemonitor.h"
+#include "framescheduler.h"
+#include "inputqueue.h"
+#include "profiler.h"
+#include "interfaces/RendererBase.h"
+
+#include <QMutexLocker>
+
+RenderThread::RenderThread(GdvCanvas2D& canvas, TileRenderer& tileRenderer, PerformanceMonitor& perfCount, FrameScheduler& scheduler, InputQueue& input) :
+    canvas(canvas), tileRenderer(tileRenderer), perfCount(perfCount), scheduler(scheduler), input(input),
+    lecture(0), rendering(false), stopRequested(false)
+{
+}
+
+RenderThread::~RenderThread()
+{
+    stopRendering();
+}
+
+void RenderThread::startRendering(RendererBase* lecture)
+{
+    stopRendering();
+
+    this->lecture = lecture;
+    stopRequested = false;
+
+    {
+        QMutexLocker lock(&taskMutex);
+        rendering = true;
+    }
+
+    canvas.setThreadedRendering(true);
+    scheduler.reset();
+    start();
+}
+
+void RenderThread::stopRendering()
+{
+    if(!isRendering())
+        return;
+
+    stopRequested = true;
+    scheduler.wakeUp();
+    wait();
+
+    {
+        QMutexLocker lock(&taskMutex);
+        rendering = false;
+    }
+
+    canvas.setThreadedRendering(false);
+
+    // Liegengebliebene Aufgaben im aufrufenden Thread nachholen
+    runPendingTasks();
+}
+
+bool RenderThread::isRendering()
+{
+    QMutexLocker lock(&taskMutex);
+    return rendering;
+}
+
+void RenderThread::post(const std::function<void()>& task)
+{
+    {
+        QMutexLocker lock(&taskMutex);
+        if(rendering)
+        {
+            pendingTasks.append(task);
+            return;
+        }
+    }
+
+    task();
+}
+
+void RenderThread::runPendingTasks()
+{
+    {
+        QMutexLocker lock(&taskMutex);
+        runningTasks.swap(pendingTasks);
+    }
+
+    for(int n = 0; n < runningTasks.size(); n++)
+        runningTasks[n]();
+
+    runningTasks.clear();
+}
+
+void RenderThread::run()
+{
+    Profiler::setThreadName("Render");
+
+    while(!stopRequested)
+    {
+        runPendingTasks();
+
+        scheduler.frameStarted();
+
+        {
+            GDV_PROFILE_ZONE("input");
+            input.take(inputBatch);
+            if(!inputBatch.isEmpty())
+                lecture->inputEvents(inputBatch);
+        }
+
+        perfCount.startFrame();
+        {
+            GDV_PROFILE_ZONE("render");
+            if(lecture->usesTiles())
+                tileRenderer.renderFrame(*lecture, canvas);
+            else
+                lecture->render(canvas);
+        }
+        perfCount.stopFrame();
+
+        if(canvas.adaptResolution(perfCount.lastFrameTime()))
+            lecture->sizeChanged(canvas.bufferSize().width(), canvas.bufferSize().height());
+
+        scheduler.frameQueued();
+        emit frameFinished();
+
+        GDV_PROFILE_ZONE("wait");
+        scheduler.waitForNextFrame(stopRequested);
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef RENDERTHREAD_H
+#define RENDERTHREAD_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <functional>
+#include <atomic>
+#include "interfaces/InputEvent.h"
+
+class RendererBase;
+class GdvCanvas2D;
+class TileRenderer;
+class PerformanceMonitor;
+class FrameScheduler;
+class InputQueue;
+
+/**
+ * @brief Die RenderThread Klasse
+ *
+ * Ruft für Abgaben, die usesRenderThread() unterstützen, fortlaufend render
+ * in einem eigenen Thread auf. Fertige Bilder werden über flipBuffer an
+ * GdvCanvas2D übergeben und mit frameFinished angekündigt. Wann das
+ * nächste Bild beginnt, bestimmt der FrameScheduler.
+ *
+ * Die gesammelten Eingaben erhält die Abgabe vor jedem Bild über
+ * RendererBase::inputEvents. Alle übrigen Aufrufe (GUI-Werte, Mesh/Textur, Größe)
+ * werden mit post übergeben und zwischen zwei Bildern im Render-Thread
+ * ausgeführt. Läuft der Thread nicht, führt post die Aufgabe sofort aus.
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class RenderThread : public QThread
+{
+    Q_OBJECT
+public:
+    RenderThread(GdvCanvas2D& canvas, TileRenderer& tileRenderer, PerformanceMonitor& perfCount, FrameScheduler& scheduler, InputQueue& input);
+    ~RenderThread();
+
+    void startRendering(RendererBase* lecture);
+    void stopRendering();
+    bool isRendering();
+
+    void post(const std::function<void()>& task);
+
+signals:
+    void frameFinished();
+
+protected:
+    virtual void run();
+
+private:
+    void runPendingTasks();
+
+    GdvCanvas2D& canvas;
+    TileRenderer& tileRenderer;
+    PerformanceMonitor& perfCount;
+    FrameScheduler& scheduler;
+    InputQueue& input;
+    QVector<InputEvent> inputBatch;
+
+    RendererBase* lecture;
+
+    QMutex taskMutex;
+    QVector<std::function<void()> > pendingTasks;
+    QVector<std::function<void()> > runningTasks;
+    bool rendering;
+    std::atomic<bool> stopRequested;
+};
+
+#endif // RENDERTHREAD_H
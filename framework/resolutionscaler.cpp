@@ -0,0 +1,79 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "resolutionscaler.h"
+
+#include <cmath>
+
+namespace
+{
+    const float minimalScale = 0.25f;
+    const float scaleSteps = 32.0f;     // Faktoren werden auf 1/32 gerundet
+    const int settleFrames = 6;         // Bilder nach einer Änderung, die nicht gewertet werden
+    const int averageFrames = 4;        // Bilder, über die vor einer Änderung gemittelt wird
+    const float maximalGrowth = 1.25f;  // Größte Vergrößerung je Schritt
+}
+
+ResolutionScaler::ResolutionScaler() :
+    targetTime(0.0f), currentScale(1.0f), averageTime(0.0f), framesSinceChange(0)
+{
+}
+
+void ResolutionScaler::setTargetFrameTime(float milliseconds)
+{
+    targetTime = qMax(milliseconds, 0.0f);
+    currentScale = 1.0f;
+    averageTime = 0.0f;
+    framesSinceChange = 0;
+}
+
+bool ResolutionScaler::addFrame(qint64 nanoseconds)
+{
+    if(!isEnabled())
+        return false;
+
+    // Das erste Bild nach einer Größenänderung ist meist langsamer (neuer
+    // Puffer, alles muss gelöscht werden) und wird daher nicht gewertet
+    framesSinceChange++;
+    if(framesSinceChange <= settleFrames - averageFrames)
+        return false;
+
+    const float time = nanoseconds * 1.0e-6f;
+    if(framesSinceChange == settleFrames - averageFrames + 1)
+        averageTime = time;
+    else
+        averageTime = 0.3f * time + 0.7f * averageTime;
+
+    if(framesSinceChange < settleFrames)
+        return false;
+
+    // Ziel ist etwas unterhalb der Zielzeit, damit kleine Schwankungen
+    // nicht sofort zur nächsten Änderung führen
+    float desired = currentScale;
+    if(averageTime > targetTime * 1.05f)
+        desired = currentScale * std::sqrt(targetTime * 0.9f / averageTime);
+    else if(averageTime < targetTime * 0.7f && currentScale < 1.0f)
+        desired = qMin(currentScale * std::sqrt(targetTime * 0.9f / averageTime), currentScale * maximalGrowth);
+
+    desired = qBound(minimalScale, std::round(desired * scaleSteps) / scaleSteps, 1.0f);
+    if(desired == currentScale)
+        return false;
+
+    currentScale = desired;
+    framesSinceChange = 0;
+    return true;
+}
+
+QSize ResolutionScaler::scaledSize(int width, int height) const
+{
+    if(currentScale >= 1.0f)
+        return QSize(width, height);
+
+    return QSize(qMax(1, qRound(width * currentScale)), qMax(1, qRound(height * currentScale)));
+}
@@ -0,0 +1,55 @@
+#ifndef RESOLUTIONSCALER_H
+#define RESOLUTIONSCALER_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QSize>
+#include <QtGlobal>
+
+/**
+ * @brief Die ResolutionScaler Klasse
+ *
+ * Regelt die interne Auflösung der Zeichenfläche anhand der gemessenen
+ * Zeit je Bild (siehe RendererBase::targetFrameRate). Die Zeit wächst etwa
+ * mit der Anzahl der Pixel, also mit dem Quadrat des Skalierungsfaktors;
+ * liegt das Mittel der letzten Bilder über der Zielzeit, wird der Faktor
+ * entsprechend verkleinert, liegt es deutlich darunter, schrittweise
+ * wieder vergrößert. Nach jeder Änderung werden einige Bilder abgewartet,
+ * damit das Ergebnis nicht zwischen zwei Größen hin- und herspringt.
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class ResolutionScaler
+{
+public:
+    ResolutionScaler();
+
+    /**
+     * @brief setTargetFrameTime Legt die Zielzeit je Bild fest und setzt den Faktor auf 1.0
+     * @param milliseconds 0.0 schaltet die Regelung ab
+     */
+    void setTargetFrameTime(float milliseconds);
+    bool isEnabled() const { return targetTime > 0.0f; }
+
+    /**
+     * @brief addFrame Übernimmt die Dauer eines Bildes
+     * @return true, falls sich der Skalierungsfaktor dadurch geändert hat
+     */
+    bool addFrame(qint64 nanoseconds);
+
+    float scale() const { return currentScale; }
+    QSize scaledSize(int width, int height) const;
+
+private:
+    float targetTime;       // ms
+    float currentScale;
+    float averageTime;      // ms, gleitender Mittelwert seit der letzten Änderung
+    int framesSinceChange;
+};
+
+#endif // RESOLUTIONSCALER_H
@@ -0,0 +1,250 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "seedfill.h"
+#include "bufferaccess.h"
+#include "pixelconversion.h"
+#include "workerpool.h"
+
+namespace
+{
+    const QRgb ColorMask = 0x00ffffff;
+}
+
+SeedFill::SeedFill() :
+    parallel(true),
+    clipLeft(0), clipTop(0), clipRight(0), clipBottom(0),
+    boundaryMode(false), referenceColor(0), fillColor(0), reach(0)
+{
+}
+
+void SeedFill::setParallel(bool enabled)
+{
+    parallel = enabled;
+}
+
+bool SeedFill::isParallel() const
+{
+    return parallel;
+}
+
+unsigned int SeedFill::floodFill(GdvCanvas& canvas, unsigned int x, unsigned int y, const QVector3D& color,
+                                 Connectivity connectivity)
+{
+    // Die Startfarbe wird erst nach dem Abbilden des Puffers gelesen
+    return fill(canvas, x, y, false, 0, color, connectivity);
+}
+
+unsigned int SeedFill::boundaryFill(GdvCanvas& canvas, unsigned int x, unsigned int y, const QVector3D& boundaryColor,
+                                    const QVector3D& color, Connectivity connectivity)
+{
+    return fill(canvas, x, y, true, PixelConversion::toRgb(boundaryColor) & ColorMask, color, connectivity);
+}
+
+unsigned int SeedFill::fill(GdvCanvas& canvas, unsigned int x, unsigned int y, bool boundary, QRgb reference,
+                            const QVector3D& value, Connectivity connectivity)
+{
+    const QRect clip = canvas.clipRect();
+    if(static_cast<int>(x) < clip.left() || static_cast<int>(x) > clip.right() ||
+       static_cast<int>(y) < clip.top() || static_cast<int>(y) > clip.bottom())
+        return 0;
+
+    mapping = canvas.mapBuffer();
+    if(!mapping.isValid())
+    {
+        canvas.unmapBuffer(QRect());
+        return 0;
+    }
+
+    const QRect bounds = clip.intersected(QRect(0, 0, mapping.width, mapping.height));
+    clipLeft = bounds.left();
+    clipTop = bounds.top();
+    clipRight = bounds.right() + 1;
+    clipBottom = bounds.bottom() + 1;
+
+    boundaryMode = boundary;
+    color = value;
+    fillColor = PixelConversion::toRgb(value) & ColorMask;
+    reach = connectivity == EightConnected ? 1 : 0;
+
+    if(!bounds.contains(x, y))
+    {
+        canvas.unmapBuffer(QRect());
+        return 0;
+    }
+
+    referenceColor = boundary ? reference : pixel(x, y);
+    if(!boundary)
+    {
+        // Bereich hat bereits die Füllfarbe
+        if(referenceColor == fillColor)
+        {
+            canvas.unmapBuffer(QRect());
+            return 0;
+        }
+    }
+
+    // Streifen vorbereiten, ohne Parallelisierung genügt einer
+    const int bandHeight = parallel ? static_cast<int>(BandHeight) : clipBottom - clipTop;
+    const int bandCount = (clipBottom - clipTop + bandHeight - 1) / bandHeight;
+
+    bands.resize(bandCount);
+    for(int n = 0; n < bandCount; n++)
+    {
+        Band& band = bands[n];
+        band.top = clipTop + n * bandHeight;
+        band.bottom = qMin(band.top + bandHeight, clipBottom);
+        band.pending.clear();
+        band.outgoing.clear();
+        band.modified.clear();
+        band.filled = 0;
+    }
+
+    const Span seed = { static_cast<int>(y), static_cast<int>(x), static_cast<int>(x) };
+    bands[(seed.y - clipTop) / bandHeight].pending.push_back(seed);
+
+    // In Runden füllen, bis kein Streifen mehr offene Abschnitte hat
+    for(;;)
+    {
+        active.clear();
+        for(int n = 0; n < bandCount; n++)
+        {
+            if(!bands[n].pending.empty())
+                active.push_back(n);
+        }
+
+        if(active.empty())
+            break;
+
+        if(active.size() == 1)
+        {
+            fillBand(bands[active[0]]);
+        }
+        else
+        {
+            WorkerPool::instance().run(static_cast<int>(active.size()), [this](int n)
+            {
+                fillBand(bands[active[n]]);
+            });
+        }
+
+        for(size_t n = 0; n < active.size(); n++)
+        {
+            std::vector<Span>& outgoing = bands[active[n]].outgoing;
+            for(size_t k = 0; k < outgoing.size(); k++)
+                bands[(outgoing[k].y - clipTop) / bandHeight].pending.push_back(outgoing[k]);
+            outgoing.clear();
+        }
+    }
+
+    unsigned int filled = 0;
+    DirtyRect modified;
+    for(int n = 0; n < bandCount; n++)
+    {
+        filled += bands[n].filled;
+        modified.add(bands[n].modified);
+    }
+
+    canvas.unmapBuffer(modified.toRect());
+    mapping = GdvCanvas::BufferMapping();
+    return filled;
+}
+
+QRgb SeedFill::pixel(int x, int y) const
+{
+    if(mapping.format == GdvCanvas::FormatRGB32)
+        return mapping.rgbLine(y)[x] & ColorMask;
+
+    const float* values = mapping.floatLine(y) + 4 * x;
+    return PixelConversion::toRgb(values[0], values[1], values[2]) & ColorMask;
+}
+
+bool SeedFill::inside(int x, int y) const
+{
+    const QRgb value = pixel(x, y);
+
+    if(boundaryMode)
+        return value != referenceColor && value != fillColor;
+
+    return value == referenceColor;
+}
+
+int SeedFill::scan(int y, int x, int end, int step, bool wanted) const
+{
+    // Für RGB32 ohne Umweg über inside(), da hier fast die gesamte Zeit vergeht
+    if(mapping.format == GdvCanvas::FormatRGB32)
+    {
+        const QRgb* line = mapping.rgbLine(y);
+
+        if(boundaryMode)
+        {
+            for(; x != end; x += step)
+            {
+                const QRgb value = line[x] & ColorMask;
+                if((value != referenceColor && value != fillColor) == wanted)
+                    break;
+            }
+        }
+        else
+        {
+            for(; x != end; x += step)
+            {
+                if(((line[x] & ColorMask) == referenceColor) == wanted)
+                    break;
+            }
+        }
+
+        return x;
+    }
+
+    for(; x != end; x += step)
+    {
+        if(inside(x, y) == wanted)
+            break;
+    }
+
+    return x;
+}
+
+void SeedFill::fillBand(Band& band)
+{
+    while(!band.pending.empty())
+    {
+        const Span span = band.pending.back();
+        band.pending.pop_back();
+
+        const int y = span.y;
+        int x = scan(y, span.left, span.right + 1, 1, true);
+
+        while(x <= span.right)
+        {
+            // Zusammenhängenden Abschnitt in beide Richtungen ausdehnen und füllen
+            const int left = scan(y, x, clipLeft - 1, -1, false) + 1;
+            const int right = scan(y, x, clipRight, 1, false) - 1;
+
+            const int length = right - left + 1;
+            BufferAccess::fillSpan(mapping, left, y, length, color);
+            band.modified.add(left, y, length, 1);
+            band.filled += length;
+
+            // Darüber und darunter liegende Pixel (bei EightConnected inkl.
+            // der diagonalen) später untersuchen
+            const Span above = { y - 1, qMax(left - reach, clipLeft), qMin(right + reach, clipRight - 1) };
+            const Span below = { y + 1, above.left, above.right };
+
+            if(above.y >= clipTop)
+                (above.y >= band.top ? band.pending : band.outgoing).push_back(above);
+            if(below.y < clipBottom)
+                (below.y < band.bottom ? band.pending : band.outgoing).push_back(below);
+
+            // right + 1 gehört bereits nicht mehr zum Bereich
+            x = right + 2 <= span.right ? scan(y, right + 2, span.right + 1, 1, true) : span.right + 1;
+        }
+    }
+}
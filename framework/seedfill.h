@@ -0,0 +1,127 @@
+#ifndef SEEDFILL_H
+#define SEEDFILL_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include "interfaces/GdvCanvas.h"
+#include "dirtyrect.h"
+
+#include <vector>
+
+/**
+ * @brief Die SeedFill Klasse
+ *
+ * Füllt zusammenhängende Bereiche des Back-Buffers ausgehend von einem
+ * Startpunkt (Saatfüllung). Es werden die Farben verwendet, die bereits im
+ * Back-Buffer stehen, z.B. zuvor gezeichnete Umrisse:
+ *
+ * canvas.clearBuffer(QVector3D(0, 0, 0));
+ * primitives.drawPolygon(...);
+ * seedFill.boundaryFill(canvas, x, y, QVector3D(1, 1, 1), QVector3D(0, 0, 1));
+ *
+ * floodFill füllt alle mit dem Startpunkt verbundenen Pixel, die dieselbe
+ * Farbe wie der Startpunkt haben (innendefiniert). boundaryFill füllt alle
+ * verbundenen Pixel bis zu einer Randfarbe (randdefiniert). Farben werden
+ * dabei mit 8 Bit je Kanal verglichen. Gefüllt wird nur innerhalb des
+ * Clip-Rechtecks der Zeichenfläche, im Kachelmodus also nur in der Kachel.
+ *
+ * Wichtig: Der Zustand eines Aufrufs liegt in der Instanz, jeder Thread
+ * braucht also seine eigene. In renderTile daher eine lokale Instanz
+ * verwenden, nicht eine Membervariable.
+ *
+ * FÜR FORTGESCHRITTENE:
+ * Statt rekursiv je Pixel arbeitet das Verfahren mit einem Stapel von
+ * Zeilenabschnitten (Spans), der Speicherbedarf wächst also nicht mit der
+ * Fläche, sondern mit der Anzahl offener Abschnitte. Mit setParallel wird
+ * der Bereich in Streifen von 64 Zeilen aufgeteilt, die gleichzeitig
+ * gefüllt werden; Abschnitte, die in einen anderen Streifen führen, werden
+ * nach jeder Runde an diesen weitergereicht.
+ */
+class SeedFill
+{
+public:
+    enum Connectivity
+    {
+        FourConnected,  // Nachbarn: links, rechts, oben, unten
+        EightConnected  // Zusätzlich die diagonalen Nachbarn
+    };
+
+    SeedFill();
+
+    void setParallel(bool enabled);
+    bool isParallel() const;
+
+    /**
+     * @brief floodFill Füllt den Bereich mit der Farbe des Startpunkts
+     * @param canvas Die Zeichenfläche
+     * @param x Die x-Koordinate des Startpunkts
+     * @param y Die y-Koordinate des Startpunkts
+     * @param color Die Füllfarbe
+     * @param connectivity Welche Nachbarn eines Pixels zum Bereich gehören
+     * @return Die Anzahl gefüllter Pixel
+     */
+    unsigned int floodFill(GdvCanvas& canvas, unsigned int x, unsigned int y, const QVector3D& color,
+                           Connectivity connectivity = FourConnected);
+
+    /**
+     * @brief boundaryFill Füllt den Bereich bis zur Randfarbe
+     * @param canvas Die Zeichenfläche
+     * @param x Die x-Koordinate des Startpunkts
+     * @param y Die y-Koordinate des Startpunkts
+     * @param boundaryColor Die Farbe des Rands, der nicht überschritten wird
+     * @param color Die Füllfarbe
+     * @param connectivity Welche Nachbarn eines Pixels zum Bereich gehören
+     * @return Die Anzahl gefüllter Pixel
+     */
+    unsigned int boundaryFill(GdvCanvas& canvas, unsigned int x, unsigned int y, const QVector3D& boundaryColor,
+                              const QVector3D& color, Connectivity connectivity = FourConnected);
+
+private:
+    enum { BandHeight = 64 };
+
+    // Ein noch zu untersuchender Abschnitt [left, right] der Zeile y
+    struct Span
+    {
+        int y, left, right;
+    };
+
+    // Ein Streifen von Zeilen, der nur von einem Thread gelesen und beschrieben wird
+    struct Band
+    {
+        int top, bottom;                // bottom exklusiv
+        std::vector<Span> pending;
+        std::vector<Span> outgoing;     // Abschnitte in anderen Streifen
+        DirtyRect modified;
+        unsigned int filled;
+    };
+
+    unsigned int fill(GdvCanvas& canvas, unsigned int x, unsigned int y, bool boundary, QRgb reference,
+                      const QVector3D& color, Connectivity connectivity);
+    void fillBand(Band& band);
+    QRgb pixel(int x, int y) const;
+    bool inside(int x, int y) const;
+
+    // Erste Position ab x in Richtung step (bis ausschließlich end), deren inside-Wert wanted ist, sonst end
+    int scan(int y, int x, int end, int step, bool wanted) const;
+
+    bool parallel;
+
+    // Zustand des laufenden Aufrufs
+    GdvCanvas::BufferMapping mapping;
+    int clipLeft, clipTop, clipRight, clipBottom;   // right/bottom exklusiv
+    bool boundaryMode;
+    QRgb referenceColor;                            // Startfarbe bzw. Randfarbe
+    QRgb fillColor;
+    QVector3D color;
+    int reach;                                      // 1 bei EightConnected, sonst 0
+
+    std::vector<Band> bands;
+    std::vector<int> active;
+};
+
+#endif // SEEDFILL_H
@@ -0,0 +1,22 @@
+#ifndef SIMD_H
+#define SIMD_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+/*
+ * Gemeinsame Erkennung der SIMD-Unterstützung für die Framework-internen
+ * Pixelroutinen. SSE2 ist auf allen x86-64 Systemen vorhanden, auf anderen
+ * Plattformen werden automatisch die skalaren Varianten verwendet.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GDV_SSE2
+#include <emmintrin.h>
+#endif
+
+#endif // SIMD_H
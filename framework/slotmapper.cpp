@@ -7,77 +7,111 @@
  **/
 
 #include "slotmapper.h"
+#include "profiler.h"
 #include <QColor>
 #include <QDebug>
 
-SlotMapper::SlotMapper(bool& mappedValue):
+SlotMapper::SlotMapper(bool& mappedValue, TaskDispatcher dispatcher):
     QObject(0),
     boolValue(&mappedValue), intValue(0), colorValue(0), stringValue(0),
-    lastBool(mappedValue)
+    lastBool(mappedValue),
+    dispatcher(dispatcher)
 {
 
 }
 
-SlotMapper::SlotMapper(int& mappedValue):
+SlotMapper::SlotMapper(int& mappedValue, TaskDispatcher dispatcher):
     QObject(0),
     boolValue(0), intValue(&mappedValue), colorValue(0), stringValue(0),
-    lastInt(mappedValue)
+    lastInt(mappedValue),
+    dispatcher(dispatcher)
 {
 
 }
 
-SlotMapper::SlotMapper(QVector3D &mappedValue):
+SlotMapper::SlotMapper(QVector3D &mappedValue, TaskDispatcher dispatcher):
     QObject(0),
     boolValue(0), intValue(0), colorValue(&mappedValue), stringValue(0),
-    lastColor(mappedValue)
+    lastColor(mappedValue),
+    dispatcher(dispatcher)
 {
 }
 
-SlotMapper::SlotMapper(QString& mappedValue):
+SlotMapper::SlotMapper(QString& mappedValue, TaskDispatcher dispatcher):
     QObject(0),
     boolValue(0), intValue(0), colorValue(0), stringValue(&mappedValue),
-    lastString(mappedValue)
+    lastString(mappedValue),
+    dispatcher(dispatcher)
 {
 
 }
 
+void SlotMapper::dispatch(const std::function<void()>& task)
+{
+    if(dispatcher)
+        dispatcher(task);
+    else
+        task();
+}
+
 void SlotMapper::mapBool(bool value)
 {
-    lastBool = value;
-    if(boolValue)
-        *boolValue = value;
+    dispatch([=]()
+    {
+        lastBool = value;
+        if(boolValue)
+            *boolValue = value;
+    });
 }
 
 void SlotMapper::mapInteger(int value)
 {
-    lastInt = value;
-    if(intValue)
-        *intValue = value;
+    dispatch([=]()
+    {
+        lastInt = value;
+        if(intValue)
+            *intValue = value;
+    });
 }
 
 void SlotMapper::mapColor(QColor value)
 {
-    lastColor = QVector3D(value.redF(), value.greenF(), value.blueF());
-    if(colorValue)
+    dispatch([=]()
     {
-        *colorValue = lastColor;
-        QString styleSheet("background-color:rgb(");
-        styleSheet += QString::number(int(lastColor.x()*255)) + ",";
-        styleSheet += QString::number(int(lastColor.y()*255)) + ",";
-        styleSheet += QString::number(int(lastColor.z()*255)) + ");";
-        emit styleSheetChanged(styleSheet);
-    }
+        lastColor = QVector3D(value.redF(), value.greenF(), value.blueF());
+        if(colorValue)
+        {
+            *colorValue = lastColor;
+            QString styleSheet("background-color:rgb(");
+            styleSheet += QString::number(int(lastColor.x()*255)) + ",";
+            styleSheet += QString::number(int(lastColor.y()*255)) + ",";
+            styleSheet += QString::number(int(lastColor.z()*255)) + ");";
+            emit styleSheetChanged(styleSheet);
+        }
+    });
 }
 
 void SlotMapper::mapString(QString value)
 {
-    lastString = value;
-    if(stringValue)
-        *stringValue = value;
+    dispatch([=]()
+    {
+        lastString = value;
+        if(stringValue)
+            *stringValue = value;
+    });
 }
 
 void SlotMapper::mapToWidget()
 {
+    // Die verknüpften Variablen dürfen nur dort gelesen werden, wo die
+    // Abgabe sie auch verändert - im Render-Thread-Modus also dort.
+    dispatch([this]() { syncToWidget(); });
+}
+
+void SlotMapper::syncToWidget()
+{
+    GDV_PROFILE_ZONE("gui mapping");
+
     if(boolValue && lastBool != *boolValue)
     {
         lastBool = *boolValue;
@@ -110,7 +144,8 @@ void SlotMapper::mapToWidget()
 
 
 
-ActionEventMapper::ActionEventMapper(std::function<void()>& event) :
+ActionEventMapper::ActionEventMapper(std::function<void()>& event, TaskDispatcher dispatcher) :
+    EventMapper(dispatcher),
     eventCall(event)
 {
 
@@ -119,10 +154,11 @@ ActionEventMapper::ActionEventMapper(std::function<void()>& event) :
 
 void ActionEventMapper::mapEvent()
 {
-  eventCall();
+  dispatch(eventCall);
 }
 
-SelectionEventMapper::SelectionEventMapper(std::function<void(int)>& event) :
+SelectionEventMapper::SelectionEventMapper(std::function<void(int)>& event, TaskDispatcher dispatcher) :
+    EventMapper(dispatcher),
     eventCall(event)
 {
 
@@ -131,5 +167,6 @@ SelectionEventMapper::SelectionEventMapper(std::function<void(int)>& event) :
 
 void SelectionEventMapper::mapEvent(int index)
 {
-  eventCall(index);
+  std::function<void(int)> call = eventCall;
+  dispatch([=]() { call(index); });
 }
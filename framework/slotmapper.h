@@ -14,6 +14,13 @@
 #include <QColor>
 #include <functional>
 
+/**
+ * Führt eine Änderung an der Abgabe aus. Im Render-Thread-Modus werden die
+ * Änderungen erst zwischen zwei Bildern im Render-Thread übernommen; ohne
+ * Dispatcher wird direkt geschrieben.
+ */
+typedef std::function<void(const std::function<void()>&)> TaskDispatcher;
+
 /**
  * @brief Die SlotMapper Klasse
  *
@@ -24,10 +31,10 @@ class SlotMapper : public QObject
 {
     Q_OBJECT
 public:
-    SlotMapper(bool& mappedValue);
-    SlotMapper(int& mappedValue);
-    SlotMapper(QVector3D& mappedValue);
-    SlotMapper(QString& mappedValue);
+    SlotMapper(bool& mappedValue, TaskDispatcher dispatcher = TaskDispatcher());
+    SlotMapper(int& mappedValue, TaskDispatcher dispatcher = TaskDispatcher());
+    SlotMapper(QVector3D& mappedValue, TaskDispatcher dispatcher = TaskDispatcher());
+    SlotMapper(QString& mappedValue, TaskDispatcher dispatcher = TaskDispatcher());
 
 public slots:
     void mapBool(bool value);
@@ -37,6 +44,10 @@ public slots:
 
     void mapToWidget();
 
+private:
+    void dispatch(const std::function<void()>& task);
+    void syncToWidget();
+
 signals:
     void boolChanged(bool);
     void intChanged(int);
@@ -54,22 +65,39 @@ private:
     bool lastBool;
     int lastInt;
     QVector3D lastColor;
-    QString lastString;    
+    QString lastString;
+
+    TaskDispatcher dispatcher;
 };
 
 class EventMapper : public QObject
 {
     Q_OBJECT
+public:
+    EventMapper(TaskDispatcher dispatcher = TaskDispatcher()) : dispatcher(dispatcher) {}
+
 public slots:
     virtual void mapEvent() {}
     virtual void mapEvent(int index) {Q_UNUSED(index);}
+
+protected:
+    void dispatch(const std::function<void()>& task)
+    {
+        if(dispatcher)
+            dispatcher(task);
+        else
+            task();
+    }
+
+private:
+    TaskDispatcher dispatcher;
 };
 
 class ActionEventMapper : public EventMapper
 {
     Q_OBJECT
 public:
-    ActionEventMapper(std::function<void()>& event);
+    ActionEventMapper(std::function<void()>& event, TaskDispatcher dispatcher = TaskDispatcher());
 
 public slots:
     virtual void mapEvent();
@@ -82,7 +110,7 @@ class SelectionEventMapper : public EventMapper
 {
     Q_OBJECT
 public:
-    SelectionEventMapper(std::function<void(int)>& event);
+    SelectionEventMapper(std::function<void(int)>& event, TaskDispatcher dispatcher = TaskDispatcher());
 
 public slots:
     virtual void mapEvent(int index);
@@ -0,0 +1,549 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "softwarecanvas.h"
+#include "pixelconversion.h"
+#include "bufferaccess.h"
+#include "workerpool.h"
+#include "framecapture.h"
+#include "profiler.h"
+
+SoftwareCanvas::SoftwareCanvas()
+{
+}
+
+SoftwareCanvas::~SoftwareCanvas()
+{
+}
+
+void SoftwareCanvas::setPixel(unsigned int x, unsigned int y, const QVector3D& color)
+{
+    if(x < clipLeft || x >= clipRight || y < clipTop || y >= clipBottom)
+    {
+        if(x >= back.width || y >= back.height)
+            outOfBounds.count(x, y);
+        return;
+    }
+
+    prepareBack();
+    if(samplesPerPixel > 1)
+        samples.write(x, y, samples.fullMask(), color);
+    else
+        BufferAccess::setPixel(back, x, y, color);
+    paintedRect.add(x, y);
+}
+
+void SoftwareCanvas::setPixelUnchecked(unsigned int x, unsigned int y, const QVector3D& color)
+{
+    Q_ASSERT(x < back.width && y < back.height);
+
+    prepareBack();
+    if(samplesPerPixel > 1)
+        samples.write(x, y, samples.fullMask(), color);
+    else
+        BufferAccess::setPixel(back, x, y, color);
+    paintedRect.add(x, y);
+}
+
+bool SoftwareCanvas::clipSpan(unsigned int& x, unsigned int y, unsigned int& length, unsigned int& skipped) const
+{
+    if(y < clipTop || y >= clipBottom || x >= clipRight || length == 0)
+        return false;
+
+    skipped = 0;
+    if(x < clipLeft)
+    {
+        skipped = clipLeft - x;
+        if(skipped >= length)
+            return false;
+
+        x = clipLeft;
+        length -= skipped;
+    }
+
+    length = qMin(length, clipRight - x);
+    return true;
+}
+
+void SoftwareCanvas::setSpan(unsigned int x, unsigned int y, unsigned int length, const QVector3D& color)
+{
+    unsigned int skipped;
+    if(!clipSpan(x, y, length, skipped))
+        return;
+
+    prepareBack();
+    if(samplesPerPixel > 1)
+        samples.fillSpan(x, y, length, samples.fullMask(), color);
+    else
+        BufferAccess::fillSpan(back, x, y, length, color);
+    paintedRect.add(x, y, length, 1);
+}
+
+void SoftwareCanvas::setRow(unsigned int x, unsigned int y, unsigned int length, const float* rgb)
+{
+    unsigned int skipped;
+    if(!clipSpan(x, y, length, skipped))
+        return;
+
+    prepareBack();
+    if(samplesPerPixel > 1)
+        samples.storeRow(x, y, length, rgb + 3 * skipped);
+    else
+        BufferAccess::storeRow(back, x, y, length, rgb + 3 * skipped);
+    paintedRect.add(x, y, length, 1);
+}
+
+void SoftwareCanvas::setRow(unsigned int x, unsigned int y, unsigned int length, const QRgb* pixels)
+{
+    unsigned int skipped;
+    if(!clipSpan(x, y, length, skipped))
+        return;
+
+    prepareBack();
+    if(samplesPerPixel > 1)
+        samples.storeRow(x, y, length, pixels + skipped);
+    else
+        BufferAccess::storeRow(back, x, y, length, pixels + skipped);
+    paintedRect.add(x, y, length, 1);
+}
+
+void SoftwareCanvas::fillRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const QVector3D& color)
+{
+    if(y >= clipBottom)
+        return;
+
+    // y + height kann überlaufen
+    const unsigned int firstRow = qMax(y, clipTop);
+    const unsigned int lastRow = y + qMin(height, clipBottom - y);
+
+    if(firstRow >= lastRow)
+        return;
+
+    unsigned int skipped;
+    if(!clipSpan(x, firstRow, width, skipped))
+        return;
+
+    prepareBack();
+    if(samplesPerPixel > 1)
+    {
+        for(unsigned int row = firstRow; row < lastRow; row++)
+            samples.fillSpan(x, row, width, samples.fullMask(), color);
+    }
+    else
+    {
+        for(unsigned int row = firstRow; row < lastRow; row++)
+            BufferAccess::fillSpan(back, x, row, width, color);
+    }
+
+    paintedRect.add(x, firstRow, width, lastRow - firstRow);
+}
+
+void SoftwareCanvas::setClipRect(const QRect& rect)
+{
+    requestedClip = rect;
+    updateClip();
+}
+
+QRect SoftwareCanvas::clipRect()
+{
+    if(clipLeft >= clipRight || clipTop >= clipBottom)
+        return QRect();
+
+    return QRect(clipLeft, clipTop, clipRight - clipLeft, clipBottom - clipTop);
+}
+
+void SoftwareCanvas::updateClip()
+{
+    QRect clip(0, 0, back.width, back.height);
+    if(!requestedClip.isNull())
+        clip = clip.intersected(requestedClip);
+
+    if(clip.isEmpty())
+    {
+        clipLeft = clipTop = clipRight = clipBottom = 0;
+        return;
+    }
+
+    clipLeft = clip.left();
+    clipTop = clip.top();
+    clipRight = clip.right() + 1;
+    clipBottom = clip.bottom() + 1;
+}
+
+QVector3D SoftwareCanvas::getPixel(unsigned int x, unsigned int y)
+{
+    if(x >= back.width || y >= back.height)
+        return QVector3D();
+
+    prepareBack();
+
+    // Im Multisampling-Modus gilt Sample 0 als Farbe des Pixels
+    return BufferAccess::getPixel(samplesPerPixel > 1 ? samples.plane(0) : back, x, y);
+}
+
+void SoftwareCanvas::getRow(unsigned int x, unsigned int y, unsigned int length, QRgb* pixels)
+{
+    if(y >= back.height || x >= back.width)
+        return;
+
+    length = qMin(length, back.width - x);
+    prepareBack();
+
+    BufferAccess::loadRow(samplesPerPixel > 1 ? samples.plane(0) : back, x, y, length, pixels);
+}
+
+GdvCanvas::BufferMapping SoftwareCanvas::mapBuffer()
+{
+    prepareBack();
+    mapped = true;
+    return samplesPerPixel > 1 ? samples.plane(0) : back;
+}
+
+void SoftwareCanvas::unmapBuffer()
+{
+    unmapBuffer(QRect(0, 0, back.width, back.height));
+}
+
+void SoftwareCanvas::unmapBuffer(const QRect& modified)
+{
+    const QRect area = modified.intersected(QRect(0, 0, back.width, back.height));
+
+    // Direkt geschriebene Pixel haben keine Überdeckung, gelten also für alle Samples
+    if(samplesPerPixel > 1)
+        samples.broadcast(area);
+
+    paintedRect.add(area);
+    mapped = false;
+}
+
+void SoftwareCanvas::clearBuffer(const QVector3D &clearColor)
+{
+    GDV_PROFILE_ZONE("clear");
+
+    // Direkt geschriebene Samples gehören ebenfalls zum bemalten Bereich
+    if(samplesPerPixel > 1)
+        paintedRect.add(samples.takeModified());
+
+    if(clipLeft != 0 || clipTop != 0 || clipRight != back.width || clipBottom != back.height)
+    {
+        // Nur das Clip-Rechteck löschen. Der Rest des Puffers behält seinen
+        // Inhalt, ein späteres clearBuffer muss also wieder alles löschen.
+        fillRect(clipLeft, clipTop, clipRight - clipLeft, clipBottom - clipTop, clearColor);
+        clearValid = false;
+
+        if(depthEnabled)
+            depth.clear(clipRect());
+        if(samples.hasDepth())
+            samples.clearDepth(clipRect());
+        return;
+    }
+
+    if(depthEnabled)
+        depth.clear();
+    if(samples.hasDepth())
+        samples.clearDepth(QRect(0, 0, back.width, back.height));
+
+    // Ist der Rest des Puffers noch von einem clear mit derselben Farbe
+    // übrig, muss nur der seitdem bemalte Bereich gelöscht werden
+    DirtyRect area;
+    if(clearValid && clearColor == lastClearColor)
+    {
+        area = contentRect;
+        area.add(paintedRect);
+    }
+    else
+        area.add(0, 0, back.width, back.height);
+
+    // Veraltete Bereiche eines getauschten Back-Buffers werden mitgelöscht,
+    // statt sie vorher aus dem Front-Buffer zu kopieren
+    DirtyRect cleared = area;
+    if(backStale)
+    {
+        cleared.add(swapChain.staleArea());
+        swapChain.markCurrent();
+        backStale = false;
+    }
+
+    if(samplesPerPixel > 1)
+    {
+        samples.clear(area.toRect(), clearColor);
+    }
+    else if(!cleared.isEmpty())
+    {
+        if(cleared.left == 0 && cleared.right == back.width && !hdrEnabled)
+        {
+            // Ganze Zeilen liegen in einem QImage direkt hintereinander
+            PixelConversion::fillRow(back.rgbLine(cleared.top), PixelConversion::toRgb(clearColor),
+                                     (cleared.bottom - cleared.top) * back.stride / sizeof(QRgb));
+        }
+        else
+        {
+            for(unsigned int row = cleared.top; row < cleared.bottom; row++)
+                BufferAccess::fillSpan(back, cleared.left, row, cleared.right - cleared.left, clearColor);
+        }
+    }
+
+    changedRect.add(area);
+    contentRect.clear();
+    paintedRect.clear();
+    clearValid = true;
+    lastClearColor = clearColor;
+}
+
+DepthBuffer* SoftwareCanvas::depthBuffer()
+{
+    return depthEnabled ? &depth : 0;
+}
+
+MultisampleBuffer* SoftwareCanvas::multisampleBuffer()
+{
+    return samplesPerPixel > 1 ? &samples : 0;
+}
+
+void SoftwareCanvas::setToneMapping(ToneMapping mode, float exposure, bool sRGB)
+{
+    if(mode == toneMapping && exposure == this->exposure && sRGB == this->sRGB)
+        return;
+
+    this->toneMapping = mode;
+    this->exposure = exposure;
+    this->sRGB = sRGB;
+    toneMappingChanged = true;
+}
+
+void SoftwareCanvas::flipBuffer()
+{
+    GDV_PROFILE_ZONE("flip");
+
+    outOfBounds.endFrame();
+
+    if(mapped)
+        unmapBuffer();
+
+    // Von Primitives, Rasterizer usw. direkt geschriebene Samples
+    if(samplesPerPixel > 1)
+        paintedRect.add(samples.takeModified());
+
+    changedRect.add(paintedRect);
+    contentRect.add(paintedRect);
+    paintedRect.clear();
+
+    if(hdrEnabled && toneMappingChanged)
+        changedRect.add(0, 0, back.width, back.height);
+
+    QRect changed = changedRect.toRect();
+    changedRect.clear();
+    toneMappingChanged = false;
+    externalFrame = QImage();
+
+    // Unverändert: Der Front-Buffer bleibt, es wird nichts getauscht
+    if(changed.isEmpty())
+    {
+        presentBuffer(changed);
+        if(capture)
+            capture->submit(swapChain.frontBuffer());
+        return;
+    }
+
+    if(samplesPerPixel > 1 || hdrEnabled)
+    {
+        GDV_PROFILE_ZONE("resolve");
+
+        // Das Bild wird aus Samples bzw. hdrBuffer berechnet, veraltete Bereiche
+        // des Back-Buffers werden dabei gleich mitberechnet
+        QRect area = changed.united(swapChain.staleArea());
+
+        // Samples zu Pixeln zusammenfassen; der Tent-Filter verändert dabei auch die Nachbarn
+        if(samplesPerPixel > 1)
+        {
+            const QRect resolved = samples.resolve(back, area);
+            if(samples.resolveFilter() == MultisampleBuffer::ResolveTent)
+                changed = changed.adjusted(-1, -1, 1, 1).intersected(resolved);
+            area = resolved;
+        }
+
+        if(hdrEnabled)
+            resolveHDR(area);
+
+        swapChain.markCurrent();
+    }
+    else
+        prepareBack();
+
+    swapChain.present(changed);
+
+    // Der neue Back-Buffer hat dieselbe Größe, nur der Speicher wechselt
+    if(!hdrEnabled)
+        back.bits = swapChain.backBuffer().bits();
+    backStale = samplesPerPixel == 1 && !hdrEnabled && !swapChain.staleArea().isEmpty();
+
+    presentBuffer(changed);
+
+    if(capture)
+        capture->submit(swapChain.frontBuffer());
+}
+
+void SoftwareCanvas::flipBuffer(const QImage& buffer)
+{
+    outOfBounds.endFrame();
+
+    presentImage(buffer);
+
+    if(capture)
+        capture->submit(buffer);
+}
+
+void SoftwareCanvas::resolveHDR(const QRect& area)
+{
+    QImage& image = swapChain.backBuffer();
+    uchar* target = image.bits();
+    const int stride = image.bytesPerLine();
+
+    const int bandHeight = 16;
+    const int bands = (area.height() + bandHeight - 1) / bandHeight;
+
+    WorkerPool::instance().run(bands, [&](int band)
+    {
+        const int firstRow = area.top() + band * bandHeight;
+        const int lastRow = qMin(firstRow + bandHeight, area.bottom() + 1);
+        for(int row = firstRow; row < lastRow; row++)
+        {
+            PixelConversion::toneMapRow(back.floatLine(row) + 4 * area.x(),
+                                        reinterpret_cast<QRgb*>(target + row * stride) + area.x(),
+                                        area.width(), toneMapping, exposure, sRGB);
+        }
+    });
+}
+
+void SoftwareCanvas::repairBack()
+{
+    swapChain.repairBack();
+    backStale = false;
+}
+
+void SoftwareCanvas::refreshMapping()
+{
+    back = BufferMapping();
+
+    // Der Inhalt eines neuen Puffers ist unbekannt
+    contentRect.clear();
+    paintedRect.clear();
+    changedRect.clear();
+    clearValid = false;
+
+    // Der gesamte Puffer gilt als neu bemalt, Veraltetes muss nicht mehr nachgeholt werden
+    swapChain.markCurrent();
+    backStale = false;
+
+    QImage& image = swapChain.backBuffer();
+    if(!image.isNull())
+    {
+        back.width = image.width();
+        back.height = image.height();
+        paintedRect.add(0, 0, back.width, back.height);
+
+        if(hdrEnabled)
+        {
+            back.bits = reinterpret_cast<uchar*>(hdrBuffer.data());
+            back.stride = back.width * 4 * sizeof(float);
+            back.format = FormatRGBA32F;
+        }
+        else
+        {
+            back.bits = image.bits();
+            back.stride = image.bytesPerLine();
+            back.format = FormatRGB32;
+        }
+    }
+
+    // Das Clip-Rechteck bleibt erhalten, wird aber auf die neue Größe beschränkt
+    updateClip();
+
+    if(depthEnabled)
+        depth.resize(back.width, back.height);
+
+    if(samplesPerPixel > 1)
+        samples.resize(back.width, back.height, samplesPerPixel, back.format, depthEnabled);
+    else
+        samples = MultisampleBuffer();
+}
+
+void SoftwareCanvas::resizeBuffer(int width, int height)
+{
+    swapChain.resize(width, height);
+
+    if(hdrEnabled)
+        hdrBuffer.assign(static_cast<size_t>(qMax(width, 0)) * qMax(height, 0) * 4, 0.0f);
+
+    refreshMapping();
+}
+
+void SoftwareCanvas::setHDREnabled(bool enabled)
+{
+    if(enabled == hdrEnabled)
+        return;
+
+    hdrEnabled = enabled;
+
+    if(hdrEnabled)
+        hdrBuffer.assign(static_cast<size_t>(bufferSize().width()) * bufferSize().height() * 4, 0.0f);
+    else
+        hdrBuffer.release();
+
+    refreshMapping();
+}
+
+void SoftwareCanvas::setDepthBufferEnabled(bool enabled)
+{
+    if(enabled == depthEnabled)
+        return;
+
+    depthEnabled = enabled;
+
+    if(depthEnabled)
+        depth.resize(back.width, back.height);
+    else
+        depth = DepthBuffer();
+
+    // Im Multisampling-Modus zusätzlich ein z-Wert je Sample
+    if(samplesPerPixel > 1)
+        refreshMapping();
+}
+
+void SoftwareCanvas::setSampleCount(int count)
+{
+    // Unterstützt werden 1, 2, 4 und 8 Samples je Pixel
+    count = count >= 8 ? 8 : count >= 4 ? 4 : count >= 2 ? 2 : 1;
+    if(count == samplesPerPixel)
+        return;
+
+    samplesPerPixel = count;
+    refreshMapping();
+}
+
+void SoftwareCanvas::setFrameCapture(FrameCapture* capture)
+{
+    this->capture = capture;
+}
+
+QImage SoftwareCanvas::frame() const
+{
+    // Der Front-Buffer liegt im Speicher der SwapChain und wird wiederverwendet
+    return externalFrame.isNull() ? swapChain.frontBuffer().copy() : externalFrame;
+}
+
+void SoftwareCanvas::presentBuffer(const QRect& changed)
+{
+    Q_UNUSED(changed);
+}
+
+void SoftwareCanvas::presentImage(const QImage& image)
+{
+    externalFrame = image;
+}
@@ -0,0 +1,148 @@
+#ifndef SOFTWARECANVAS_H
+#define SOFTWARECANVAS_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "interfaces/GdvCanvas.h"
+#include "dirtyrect.h"
+#include "outofboundscounter.h"
+#include "depthbuffer.h"
+#include "multisamplebuffer.h"
+#include "swapchain.h"
+#include "pooledbuffer.h"
+
+#include <QImage>
+
+class FrameCapture;
+
+/**
+ * @brief Die SoftwareCanvas Klasse
+ *
+ * Implementiert das GdvCanvas-Interface vollständig im Speicher: Back-Buffer
+ * (wahlweise HDR) in einer SwapChain, Clip-Rechteck, Tiefenpuffer, Multisampling und die
+ * Verwaltung der veränderten Bereiche. Die Klasse benötigt weder ein Fenster
+ * noch ein Display; was beim flipBuffer mit dem fertigen Bild geschieht,
+ * legen abgeleitete Klassen mit presentBuffer bzw. presentImage fest
+ * (GdvCanvas2D zeigt es an, der Headless-Runner wertet es nur aus).
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class SoftwareCanvas : public GdvCanvas
+{
+public:
+    SoftwareCanvas();
+    virtual ~SoftwareCanvas();
+
+    virtual void setPixel(unsigned int x, unsigned int y, const QVector3D& color);
+    virtual void setPixelUnchecked(unsigned int x, unsigned int y, const QVector3D& color);
+    virtual void setSpan(unsigned int x, unsigned int y, unsigned int length, const QVector3D& color);
+    virtual void setRow(unsigned int x, unsigned int y, unsigned int length, const float* rgb);
+    virtual void setRow(unsigned int x, unsigned int y, unsigned int length, const QRgb* pixels);
+    virtual void fillRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const QVector3D& color);
+    virtual void setClipRect(const QRect& rect);
+    virtual QRect clipRect();
+    virtual QVector3D getPixel(unsigned int x, unsigned int y);
+    virtual void getRow(unsigned int x, unsigned int y, unsigned int length, QRgb* pixels);
+    virtual BufferMapping mapBuffer();
+    virtual void unmapBuffer();
+    virtual void unmapBuffer(const QRect& modified);
+    virtual void clearBuffer(const QVector3D& clearColor);
+    virtual DepthBuffer* depthBuffer();
+    virtual MultisampleBuffer* multisampleBuffer();
+    virtual void setToneMapping(ToneMapping mode, float exposure = 1.0f, bool sRGB = false);
+    virtual void flipBuffer();
+    virtual void flipBuffer(const QImage& buffer);
+
+    void resizeBuffer(int width, int height);
+    QSize bufferSize() const { return swapChain.size(); }
+    void setHDREnabled(bool enabled);
+    void setDepthBufferEnabled(bool enabled);
+    void setSampleCount(int count);
+
+    /**
+     * @brief setFrameCapture Übergibt ab jetzt jedes fertige Bild an capture (0: keine Aufnahme)
+     */
+    void setFrameCapture(FrameCapture* capture);
+
+    /**
+     * @brief frame Eine Kopie des zuletzt mit flipBuffer fertiggestellten Bildes (RGB32)
+     */
+    QImage frame() const;
+
+protected:
+    /**
+     * @brief presentBuffer Wird am Ende von flipBuffer() aufgerufen
+     * @param changed Der Bereich, in dem sich der neue Front-Buffer vom vorherigen unterscheidet
+     */
+    virtual void presentBuffer(const QRect& changed);
+
+    /**
+     * @brief presentImage Wird von flipBuffer(const QImage&) mit dem übergebenen Bild aufgerufen
+     */
+    virtual void presentImage(const QImage& image);
+
+    // Die Bildpuffer; im HDR- bzw. Multisampling-Modus wird der Back-Buffer
+    // erst beim flipBuffer berechnet
+    SwapChain swapChain;
+
+private:
+    bool clipSpan(unsigned int& x, unsigned int y, unsigned int& length, unsigned int& skipped) const;
+    void updateClip();
+    void refreshMapping();
+    void resolveHDR(const QRect& area);
+
+    // Vor jedem Zugriff auf den Back-Buffer: ältere Bereiche nachholen
+    void prepareBack() { if(backStale) repairBack(); }
+    void repairBack();
+
+    // Zuletzt mit flipBuffer(const QImage&) übergebenes Bild
+    QImage externalFrame;
+    FrameCapture* capture = 0;
+
+    // Der Back-Buffer, in den alle Zeichenoperationen schreiben: entweder
+    // swapChain.backBuffer() selbst oder (im HDR-Modus) hdrBuffer
+    BufferMapping back;
+
+    // Nach dem Tausch der Puffer ist swapChain.staleArea() noch nicht aufgeholt.
+    // Nur ohne HDR und Multisampling, sonst wird das Bild beim flipBuffer neu berechnet.
+    bool backStale = false;
+    PooledBuffer<float> hdrBuffer;
+
+    // Clip-Rechteck, bereits auf den Back-Buffer beschränkt (right/bottom exklusiv)
+    QRect requestedClip;
+    unsigned int clipLeft = 0, clipTop = 0, clipRight = 0, clipBottom = 0;
+    OutOfBoundsCounter outOfBounds;
+
+    DepthBuffer depth;
+    bool depthEnabled = false;
+
+    // Im Multisampling-Modus schreiben alle Zeichenoperationen in samples,
+    // back enthält dann das beim flipBuffer zusammengefasste Bild
+    MultisampleBuffer samples;
+    int samplesPerPixel = 1;
+
+    // Bemalte Bereiche seit dem letzten flipBuffer bzw. clearBuffer (painted)
+    // und aus vorherigen Bildern seit dem letzten clearBuffer (content).
+    // changed sammelt alles, was beim flipBuffer neu dargestellt werden muss.
+    DirtyRect paintedRect;
+    DirtyRect contentRect;
+    DirtyRect changedRect;
+    QVector3D lastClearColor;
+    bool clearValid = false;
+    bool mapped = false;
+
+    bool hdrEnabled = false;
+
+    ToneMapping toneMapping = ToneMapClamp;
+    float exposure = 1.0f;
+    bool sRGB = false;
+    bool toneMappingChanged = false;
+};
+
+#endif // SOFTWARECANVAS_H
@@ -0,0 +1,114 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "swapchain.h"
+
+#include <QMutexLocker>
+#include <cstring>
+
+SwapChain::SwapChain(int count) :
+    storage(qMax(count, 2)), buffers(qMax(count, 2)), stale(qMax(count, 2)),
+    back(0), front(1), displayed(-1)
+{
+}
+
+void SwapChain::resize(int width, int height)
+{
+    QMutexLocker lock(&mutex);
+
+    const size_t pixels = static_cast<size_t>(qMax(width, 0)) * qMax(height, 0);
+
+    for(int n = 0; n < buffers.size(); n++)
+    {
+        // Der Speicher des dargestellten Bildes darf nicht verschwinden, solange es gezeichnet wird
+        while(n == displayed && storage[n].capacity() < pixels)
+            released.wait(&mutex);
+
+        storage[n].resize(pixels);
+        buffers[n] = pixels > 0 ? QImage(reinterpret_cast<uchar*>(storage[n].data()), width, height,
+                                         width * sizeof(QRgb), QImage::Format_RGB32) : QImage();
+        stale[n] = QRect();
+    }
+
+    // In ein gerade dargestelltes Bild wird auch jetzt nicht gezeichnet
+    back = displayed == 0 ? 1 : 0;
+    front = (back + 1) % buffers.size();
+    if(front == displayed && buffers.size() > 2)
+        front = (front + 1) % buffers.size();
+
+    // Bis zum ersten present wird der Front-Buffer schwarz dargestellt
+    buffers[front].fill(0xff000000);
+}
+
+void SwapChain::repairBack()
+{
+    const QRect area = stale[back].intersected(QRect(QPoint(0, 0), buffers[back].size()));
+    stale[back] = QRect();
+
+    if(area.isEmpty())
+        return;
+
+    const QImage& source = buffers[front];
+    QImage& target = buffers[back];
+    const size_t offset = area.x() * sizeof(QRgb);
+    const size_t bytes = area.width() * sizeof(QRgb);
+
+    for(int row = area.top(); row <= area.bottom(); row++)
+        memcpy(target.scanLine(row) + offset, source.constScanLine(row) + offset, bytes);
+}
+
+void SwapChain::present(const QRect& changed)
+{
+    QMutexLocker lock(&mutex);
+
+    // Alle anderen Puffer weichen nun zusätzlich in changed vom Front-Buffer ab
+    for(int n = 0; n < buffers.size(); n++)
+    {
+        if(n != back)
+            stale[n] = stale[n].united(changed);
+    }
+
+    stale[back] = QRect();
+    front = back;
+
+    // Als neuen Back-Buffer den Puffer wählen, der am wenigsten nachgeholt
+    // werden muss - in der Regel das vorherige Bild
+    int best = -1;
+    for(int n = 0; n < buffers.size(); n++)
+    {
+        if(n == front || n == displayed)
+            continue;
+
+        if(best < 0 || stale[n].width() * stale[n].height() < stale[best].width() * stale[best].height())
+            best = n;
+    }
+
+    // Nur mit zwei Puffern möglich: Das Zeichnen koppelt das dargestellte Bild dann ab
+    if(best < 0)
+        best = displayed;
+
+    back = best;
+}
+
+QImage SwapChain::acquireFront()
+{
+    QMutexLocker lock(&mutex);
+    displayed = front;
+    return buffers[front];
+}
+
+void SwapChain::releaseFront(QImage& image)
+{
+    // Erst die Kopie freigeben, sonst würde das nächste Zeichnen den Puffer abkoppeln
+    image = QImage();
+
+    QMutexLocker lock(&mutex);
+    displayed = -1;
+    released.wakeAll();
+}
@@ -0,0 +1,99 @@
+#ifndef SWAPCHAIN_H
+#define SWAPCHAIN_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QImage>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include "pooledbuffer.h"
+
+/**
+ * @brief Die SwapChain Klasse
+ *
+ * Verwaltet die Bildpuffer (RGB32) der Zeichenfläche. Gezeichnet wird in den
+ * Back-Buffer; present macht ihn zum Front-Buffer und wählt einen der übrigen
+ * Puffer als neuen Back-Buffer. Dabei wird weder Speicher angefordert noch
+ * kopiert, es wechseln nur die Rollen.
+ *
+ * Die Bilder liegen in PooledBuffern: Bei einer Größenänderung wird nur
+ * dann Speicher angefordert, wenn er nicht ausreicht.
+ *
+ * Der neue Back-Buffer enthält allerdings ein älteres Bild. Für jeden Puffer
+ * wird daher der Bereich mitgeführt, in dem er vom Front-Buffer abweicht
+ * (staleArea). Wer den vorherigen Inhalt weiterverwenden will, gleicht ihn mit
+ * repairBack an; wer ihn ohnehin überschreibt (z.B. clearBuffer), spart sich
+ * die Kopie.
+ *
+ * Die Darstellung kann in einem anderen Thread erfolgen: Solange ein Bild mit
+ * acquireFront angefordert ist, wird es nicht als Back-Buffer gewählt. Mit
+ * drei Puffern steht dann trotzdem immer einer zum Zeichnen bereit, ohne dass
+ * auf die Darstellung gewartet werden muss.
+ *
+ * Alle Methoden außer acquireFront und releaseFront dürfen nur im zeichnenden
+ * Thread aufgerufen werden.
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class SwapChain
+{
+public:
+    explicit SwapChain(int count = 3);
+
+    /**
+     * @brief resize Legt alle Puffer in der neuen Größe an, der Inhalt ist danach undefiniert
+     *
+     * Muss der Speicher des gerade dargestellten Bildes wachsen, wird auf
+     * dessen releaseFront gewartet.
+     */
+    void resize(int width, int height);
+    QSize size() const { return buffers[back].size(); }
+
+    QImage& backBuffer() { return buffers[back]; }
+    const QImage& frontBuffer() const { return buffers[front]; }
+
+    /**
+     * @brief staleArea Der Bereich, in dem der Back-Buffer nicht dem Front-Buffer entspricht
+     */
+    QRect staleArea() const { return stale[back]; }
+
+    /**
+     * @brief repairBack Kopiert staleArea aus dem Front-Buffer in den Back-Buffer
+     */
+    void repairBack();
+
+    /**
+     * @brief markCurrent Der Back-Buffer wurde anderweitig (z.B. durch Löschen) angeglichen
+     */
+    void markCurrent() { stale[back] = QRect(); }
+
+    /**
+     * @brief present Macht den Back-Buffer zum Front-Buffer
+     * @param changed Der Bereich, in dem sich das neue vom vorherigen Bild unterscheidet
+     */
+    void present(const QRect& changed);
+
+    /**
+     * @brief acquireFront Liefert das aktuelle Bild zur Darstellung, ohne es zu kopieren
+     *
+     * Bis zum zugehörigen releaseFront wird dieser Puffer nicht zum Zeichnen verwendet.
+     */
+    QImage acquireFront();
+    void releaseFront(QImage& image);
+
+private:
+    QMutex mutex;
+    QWaitCondition released;
+    QVector<PooledBuffer<QRgb> > storage;
+    QVector<QImage> buffers;     // Ansichten auf storage in der aktuellen Größe
+    QVector<QRect> stale;
+    int back, front;
+    int displayed;      // Mit acquireFront angefordert, -1: keiner
+};
+
+#endif // SWAPCHAIN_H
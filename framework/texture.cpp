@@ -0,0 +1,356 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "texture.h"
+#include "simd.h"
+
+#include <cmath>
+
+namespace
+{
+    // Bits von x auf die geraden Bitpositionen verteilt (y entsprechend um eins verschoben)
+    const unsigned char MortonTable[8] = { 0, 1, 4, 5, 16, 17, 20, 21 };
+
+    inline int texelIndex(int x, int y, int blocksX)
+    {
+        return ((((y >> 3) * blocksX) + (x >> 3)) << 6) | MortonTable[x & 7] | (MortonTable[y & 7] << 1);
+    }
+
+    inline int wrapIndex(int index, int size, Texture::WrapMode mode)
+    {
+        if(mode == Texture::ClampToEdge)
+            return qBound(0, index, size - 1);
+
+        // Auch für Indizes weit außerhalb (z.B. aus sehr großen Koordinaten)
+        return ((index % size) + size) % size;
+    }
+
+    // Ganzzahliger Anteil und Gewicht der Texelkoordinate für eine einzelne Koordinate t
+    inline void texelCoordinate(float t, int size, Texture::WrapMode mode, bool bilinear, int& index, float& weight)
+    {
+        // NaN und Unendlich werden zu 0; ab 2^23 hat t keine Nachkommastellen mehr
+        if(mode == Texture::Repeat)
+            t = std::fabs(t) < 8388608.0f ? t - std::floor(t) : 0.0f;
+        else
+            t = t == t ? qBound(-1.0f, t, 2.0f) : 0.0f;
+
+        t = t * size - (bilinear ? 0.5f : 0.0f);
+        const float floorT = std::floor(t);
+        index = static_cast<int>(floorT);
+        weight = t - floorT;
+    }
+
+    inline int average(QRgb a, QRgb b, QRgb c, QRgb d, int shift)
+    {
+        return ((((a >> shift) & 0xff) + ((b >> shift) & 0xff) + ((c >> shift) & 0xff) + ((d >> shift) & 0xff) + 2) / 4) << shift;
+    }
+}
+
+QRgb Texture::Level::texel(int x, int y) const
+{
+    return texels[texelIndex(x, y, blocksX)];
+}
+
+Texture::Texture() :
+    wrap(Repeat)
+{
+}
+
+Texture::Texture(const QImage& image, bool mipmaps) :
+    wrap(Repeat)
+{
+    if(image.isNull())
+        return;
+
+    const QImage source = image.convertToFormat(QImage::Format_RGB32);
+
+    levels.push_back(Level());
+    buildLevel(levels[0], source.width(), source.height());
+
+    for(int y = 0; y < source.height(); y++)
+    {
+        const QRgb* line = reinterpret_cast<const QRgb*>(source.constScanLine(y));
+        for(int x = 0; x < source.width(); x++)
+            levels[0].texels[texelIndex(x, y, levels[0].blocksX)] = line[x];
+    }
+
+    // Mipmaps: jede Stufe ist das 2x2-Mittel der vorherigen
+    while(mipmaps && (levels.back().width > 1 || levels.back().height > 1))
+    {
+        Level next;
+        const Level& previous = levels.back();
+        buildLevel(next, qMax(1, previous.width / 2), qMax(1, previous.height / 2));
+
+        for(int y = 0; y < next.height; y++)
+        {
+            const int y0 = qMin(2 * y, previous.height - 1);
+            const int y1 = qMin(2 * y + 1, previous.height - 1);
+
+            for(int x = 0; x < next.width; x++)
+            {
+                const int x0 = qMin(2 * x, previous.width - 1);
+                const int x1 = qMin(2 * x + 1, previous.width - 1);
+
+                const QRgb a = previous.texel(x0, y0), b = previous.texel(x1, y0);
+                const QRgb c = previous.texel(x0, y1), d = previous.texel(x1, y1);
+
+                next.texels[texelIndex(x, y, next.blocksX)] =
+                        0xff000000 | average(a, b, c, d, 16) | average(a, b, c, d, 8) | average(a, b, c, d, 0);
+            }
+        }
+
+        levels.push_back(next);
+    }
+}
+
+void Texture::buildLevel(Level& level, int width, int height)
+{
+    level.width = width;
+    level.height = height;
+    level.blocksX = (width + 7) / 8;
+    level.texels.assign(static_cast<size_t>(level.blocksX) * ((height + 7) / 8) * 64, 0);
+}
+
+bool Texture::isNull() const
+{
+    return levels.empty();
+}
+
+int Texture::width(int level) const
+{
+    return level >= 0 && level < levelCount() ? levels[level].width : 0;
+}
+
+int Texture::height(int level) const
+{
+    return level >= 0 && level < levelCount() ? levels[level].height : 0;
+}
+
+int Texture::levelCount() const
+{
+    return static_cast<int>(levels.size());
+}
+
+void Texture::setWrapMode(WrapMode mode)
+{
+    wrap = mode;
+}
+
+Texture::WrapMode Texture::wrapMode() const
+{
+    return wrap;
+}
+
+QVector3D Texture::sample(float u, float v, Filter filter, float lod) const
+{
+    if(levels.empty())
+        return QVector3D();
+
+    // Wie sample4, aber nur für eine Koordinate
+    lod = qBound(0.0f, lod, static_cast<float>(levelCount() - 1));
+    float bgra[4];
+
+    if(filter != Trilinear || lod == std::floor(lod))
+    {
+        const int level = filter == Trilinear ? static_cast<int>(lod) : qRound(lod);
+        sampleLevel(levels[level], u, v, filter != Nearest, bgra);
+    }
+    else
+    {
+        const int level = static_cast<int>(lod);
+        const float t = lod - level;
+        float upper[4];
+
+        sampleLevel(levels[level], u, v, true, bgra);
+        sampleLevel(levels[level + 1], u, v, true, upper);
+
+        for(int n = 0; n < 3; n++)
+            bgra[n] += (upper[n] - bgra[n]) * t;
+    }
+
+    return QVector3D(bgra[2], bgra[1], bgra[0]);
+}
+
+void Texture::sample4(const float* u, const float* v, float* rgb, Filter filter, float lod) const
+{
+    if(levels.empty())
+    {
+        for(int n = 0; n < 12; n++)
+            rgb[n] = 0.0f;
+        return;
+    }
+
+    const int lastLevel = levelCount() - 1;
+    lod = qBound(0.0f, lod, static_cast<float>(lastLevel));
+
+    // Je Koordinate b, g, r, a (Reihenfolge der Bytes eines QRgb)
+    float bgra[16];
+
+    if(filter != Trilinear || lod == std::floor(lod))
+    {
+        const int level = filter == Trilinear ? static_cast<int>(lod) : qRound(lod);
+        sampleLevel4(levels[level], u, v, filter != Nearest, bgra);
+    }
+    else
+    {
+        const int level = static_cast<int>(lod);
+        const float t = lod - level;
+        float upper[16];
+
+        sampleLevel4(levels[level], u, v, true, bgra);
+        sampleLevel4(levels[level + 1], u, v, true, upper);
+
+        for(int n = 0; n < 16; n++)
+            bgra[n] += (upper[n] - bgra[n]) * t;
+    }
+
+    for(int n = 0; n < 4; n++)
+    {
+        rgb[3 * n + 0] = bgra[4 * n + 2];
+        rgb[3 * n + 1] = bgra[4 * n + 1];
+        rgb[3 * n + 2] = bgra[4 * n + 0];
+    }
+}
+
+float Texture::levelOfDetail(float dudx, float dvdx, float dudy, float dvdy) const
+{
+    if(levels.empty())
+        return 0.0f;
+
+    const float w = levels[0].width;
+    const float h = levels[0].height;
+
+    const float footprintX = (dudx * w) * (dudx * w) + (dvdx * h) * (dvdx * h);
+    const float footprintY = (dudy * w) * (dudy * w) + (dvdy * h) * (dvdy * h);
+    const float footprint = qMax(footprintX, footprintY);
+
+    // log2(sqrt(f)) = 0.5 * log2(f)
+    return footprint > 1.0f ? 0.5f * std::log2(footprint) : 0.0f;
+}
+
+void Texture::sampleLevel4(const Level& level, const float* u, const float* v, bool bilinear, float* bgra) const
+{
+    int ix[4], iy[4];
+    float fx[4], fy[4];
+
+    // Texelkoordinaten: ganzzahliger Anteil und Gewicht für bilineare Filterung
+#ifdef GDV_SSE2
+    __m128 x = _mm_loadu_ps(u);
+    __m128 y = _mm_loadu_ps(v);
+
+    // NaN und Unendlich werden zu 0 (siehe texelCoordinate)
+    x = _mm_and_ps(x, _mm_cmpord_ps(x, x));
+    y = _mm_and_ps(y, _mm_cmpord_ps(y, y));
+
+    if(wrap == Repeat)
+    {
+        // Ab 2^23 gibt es keine Nachkommastellen mehr, außerdem versagt dort die Umwandlung in int
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        const __m128 limit = _mm_set1_ps(8388608.0f);
+        x = _mm_and_ps(x, _mm_cmplt_ps(_mm_and_ps(x, absMask), limit));
+        y = _mm_and_ps(y, _mm_cmplt_ps(_mm_and_ps(y, absMask), limit));
+
+        // u - floor(u), für negative Werte korrigiert
+        __m128 tx = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+        __m128 ty = _mm_cvtepi32_ps(_mm_cvttps_epi32(y));
+        tx = _mm_sub_ps(tx, _mm_and_ps(_mm_cmpgt_ps(tx, x), _mm_set1_ps(1.0f)));
+        ty = _mm_sub_ps(ty, _mm_and_ps(_mm_cmpgt_ps(ty, y), _mm_set1_ps(1.0f)));
+        x = _mm_sub_ps(x, tx);
+        y = _mm_sub_ps(y, ty);
+    }
+    else
+    {
+        x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-1.0f)), _mm_set1_ps(2.0f));
+        y = _mm_min_ps(_mm_max_ps(y, _mm_set1_ps(-1.0f)), _mm_set1_ps(2.0f));
+    }
+
+    const __m128 offset = _mm_set1_ps(bilinear ? 0.5f : 0.0f);
+    x = _mm_sub_ps(_mm_mul_ps(x, _mm_set1_ps(static_cast<float>(level.width))), offset);
+    y = _mm_sub_ps(_mm_mul_ps(y, _mm_set1_ps(static_cast<float>(level.height))), offset);
+
+    // floor, wie oben
+    __m128 floorX = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    __m128 floorY = _mm_cvtepi32_ps(_mm_cvttps_epi32(y));
+    floorX = _mm_sub_ps(floorX, _mm_and_ps(_mm_cmpgt_ps(floorX, x), _mm_set1_ps(1.0f)));
+    floorY = _mm_sub_ps(floorY, _mm_and_ps(_mm_cmpgt_ps(floorY, y), _mm_set1_ps(1.0f)));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ix), _mm_cvttps_epi32(floorX));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(iy), _mm_cvttps_epi32(floorY));
+    _mm_storeu_ps(fx, _mm_sub_ps(x, floorX));
+    _mm_storeu_ps(fy, _mm_sub_ps(y, floorY));
+#else
+    for(int n = 0; n < 4; n++)
+    {
+        texelCoordinate(u[n], level.width, wrap, bilinear, ix[n], fx[n]);
+        texelCoordinate(v[n], level.height, wrap, bilinear, iy[n], fy[n]);
+    }
+#endif
+
+    for(int n = 0; n < 4; n++)
+        filterTexels(level, ix[n], iy[n], fx[n], fy[n], bilinear, bgra + 4 * n);
+}
+
+void Texture::sampleLevel(const Level& level, float u, float v, bool bilinear, float* bgra) const
+{
+    int ix, iy;
+    float fx, fy;
+
+    texelCoordinate(u, level.width, wrap, bilinear, ix, fx);
+    texelCoordinate(v, level.height, wrap, bilinear, iy, fy);
+    filterTexels(level, ix, iy, fx, fy, bilinear, bgra);
+}
+
+void Texture::filterTexels(const Level& level, int ix, int iy, float fx, float fy, bool bilinear, float* bgra) const
+{
+    const float scale = 1.0f / 255.0f;
+
+    const int x0 = wrapIndex(ix, level.width, wrap);
+    const int y0 = wrapIndex(iy, level.height, wrap);
+
+    if(!bilinear)
+    {
+        const QRgb texel = level.texel(x0, y0);
+        bgra[0] = qBlue(texel) * scale;
+        bgra[1] = qGreen(texel) * scale;
+        bgra[2] = qRed(texel) * scale;
+        bgra[3] = 1.0f;
+        return;
+    }
+
+    const int x1 = wrapIndex(ix + 1, level.width, wrap);
+    const int y1 = wrapIndex(iy + 1, level.height, wrap);
+
+    const QRgb texels[4] = { level.texel(x0, y0), level.texel(x1, y0), level.texel(x0, y1), level.texel(x1, y1) };
+    const float weights[4] = { (1.0f - fx) * (1.0f - fy), fx * (1.0f - fy),
+                               (1.0f - fx) * fy, fx * fy };
+
+#ifdef GDV_SSE2
+    // Alle vier Kanäle eines Texels gleichzeitig gewichten
+    const __m128i zero = _mm_setzero_si128();
+    __m128 sum = _mm_setzero_ps();
+    for(int t = 0; t < 4; t++)
+    {
+        const __m128i bytes = _mm_cvtsi32_si128(static_cast<int>(texels[t]));
+        const __m128i channels = _mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero);
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(channels), _mm_set1_ps(weights[t] * scale)));
+    }
+    _mm_storeu_ps(bgra, sum);
+#else
+    float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for(int t = 0; t < 4; t++)
+    {
+        sum[0] += qBlue(texels[t]) * weights[t];
+        sum[1] += qGreen(texels[t]) * weights[t];
+        sum[2] += qRed(texels[t]) * weights[t];
+        sum[3] += qAlpha(texels[t]) * weights[t];
+    }
+    for(int c = 0; c < 4; c++)
+        bgra[c] = sum[c] * scale;
+#endif
+}
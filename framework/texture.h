@@ -0,0 +1,110 @@
+#ifndef TEXTURE_H
+#define TEXTURE_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QImage>
+#include <QVector3D>
+#include <vector>
+
+/**
+ * @brief Die Texture Klasse
+ *
+ * Eine Textur für das Zeichnen ohne OpenGL. Wird aus dem QImage erzeugt,
+ * das RendererBase::textureChanged übergeben wird, und bietet deutlich
+ * schnellere Zugriffe als QImage::pixel():
+ *
+ * void MyLecture::textureChanged(QImage image)
+ * {
+ *     texture = Texture(image);
+ * }
+ *
+ * QVector3D color = texture.sample(u, v, Texture::Bilinear);
+ *
+ * Texturkoordinaten liegen im Bereich 0.0 bis 1.0, (0, 0) ist die linke
+ * obere Ecke des Bildes. Ausserhalb davon wird die Textur wiederholt
+ * (Repeat) oder der Rand verlängert (ClampToEdge).
+ *
+ * FÜR FORTGESCHRITTENE:
+ * Die Texel liegen nicht zeilenweise, sondern in Blöcken von 8x8 Texeln
+ * in Z-Reihenfolge (Morton-Code) im Speicher. Benachbarte Texel liegen so
+ * auch bei gedrehten Dreiecken meist in derselben Cache-Line. Zusätzlich
+ * wird eine Mipmap-Pyramide berechnet: lod = 0 ist die volle Auflösung,
+ * jede weitere Stufe halbiert Breite und Höhe. sample4 wertet vier
+ * Koordinaten auf einmal aus (SSE2).
+ *
+ * Alle sample-Methoden dürfen gleichzeitig aus mehreren Threads (z.B. in
+ * renderTile oder einem Rasterizer::FragmentShader) aufgerufen werden.
+ */
+class Texture
+{
+public:
+    enum Filter
+    {
+        Nearest,    // Nächstgelegener Texel der Mipmap-Stufe round(lod)
+        Bilinear,   // Gewichtetes Mittel der vier nächsten Texel der Stufe round(lod)
+        Trilinear   // Bilinear in den beiden Stufen um lod, dazwischen linear gemischt
+    };
+
+    enum WrapMode
+    {
+        Repeat,
+        ClampToEdge
+    };
+
+    Texture();
+    explicit Texture(const QImage& image, bool mipmaps = true);
+
+    bool isNull() const;
+    int width(int level = 0) const;
+    int height(int level = 0) const;
+    int levelCount() const;
+
+    void setWrapMode(WrapMode mode);
+    WrapMode wrapMode() const;
+
+    QVector3D sample(float u, float v, Filter filter = Bilinear, float lod = 0.0f) const;
+
+    /**
+     * @brief sample4 Wertet vier Texturkoordinaten auf einmal aus
+     * @param u Vier u-Koordinaten
+     * @param v Vier v-Koordinaten
+     * @param rgb Ziel für 12 Werte (r, g, b, r, g, b, ...), z.B. direkt für GdvCanvas::setRow
+     * @param filter Das Filterverfahren
+     * @param lod Die Mipmap-Stufe für alle vier Koordinaten (siehe levelOfDetail)
+     */
+    void sample4(const float* u, const float* v, float* rgb, Filter filter = Bilinear, float lod = 0.0f) const;
+
+    /**
+     * @brief levelOfDetail Berechnet die passende Mipmap-Stufe aus den Ableitungen der Texturkoordinaten
+     * @return log2 der Anzahl Texel, die ein Pixel in die stärker verkleinerte Richtung überdeckt
+     *
+     * dudx/dvdx: Änderung von u/v je Pixel nach rechts, dudy/dvdy: je Pixel nach unten.
+     */
+    float levelOfDetail(float dudx, float dvdx, float dudy, float dvdy) const;
+
+private:
+    struct Level
+    {
+        int width, height;
+        int blocksX;                // Anzahl 8x8-Blöcke je Blockzeile
+        std::vector<QRgb> texels;   // Blockweise, innerhalb eines Blocks in Morton-Reihenfolge
+
+        QRgb texel(int x, int y) const;
+    };
+
+    void buildLevel(Level& level, int width, int height);
+    void sampleLevel4(const Level& level, const float* u, const float* v, bool bilinear, float* bgra) const;
+    void sampleLevel(const Level& level, float u, float v, bool bilinear, float* bgra) const;
+    void filterTexels(const Level& level, int ix, int iy, float fx, float fy, bool bilinear, float* bgra) const;
+
+    std::vector<Level> levels;
+    WrapMode wrap;
+};
+
+#endif // TEXTURE_H
@@ -0,0 +1,300 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "tilerenderer.h"
+#include "workerpool.h"
+#include "bufferaccess.h"
+#include "depthbuffer.h"
+#include "profiler.h"
+#include "interfaces/RendererBase.h"
+
+TileCanvas::TileCanvas(const BufferMapping& mapping, DepthBuffer* depth, const QRect& tile, const QRect& clip, TileState& state) :
+    mapping(mapping), depth(depth), state(state)
+{
+    this->tile = tile.intersected(QRect(0, 0, mapping.width, mapping.height));
+    setClipRect(clip);
+}
+
+bool TileCanvas::clipSpan(unsigned int& x, unsigned int y, unsigned int& length, unsigned int& skipped) const
+{
+    if(y < top || y >= bottom || x >= right || length == 0)
+        return false;
+
+    skipped = 0;
+    if(x < left)
+    {
+        skipped = left - x;
+        if(skipped >= length)
+            return false;
+
+        x = left;
+        length -= skipped;
+    }
+
+    length = qMin(length, right - x);
+    return true;
+}
+
+void TileCanvas::setPixel(unsigned int x, unsigned int y, const QVector3D& color)
+{
+    if(x < left || x >= right || y < top || y >= bottom)
+    {
+        // Pixel anderer Kacheln werden stillschweigend verworfen
+        if(x >= mapping.width || y >= mapping.height)
+            state.outOfBounds.count(x, y);
+        return;
+    }
+
+    BufferAccess::setPixel(mapping, x, y, color);
+    state.content.add(x, y);
+}
+
+void TileCanvas::setPixelUnchecked(unsigned int x, unsigned int y, const QVector3D& color)
+{
+    Q_ASSERT(x < mapping.width && y < mapping.height);
+
+    BufferAccess::setPixel(mapping, x, y, color);
+    state.content.add(x, y);
+}
+
+void TileCanvas::setSpan(unsigned int x, unsigned int y, unsigned int length, const QVector3D& color)
+{
+    unsigned int skipped;
+    if(!clipSpan(x, y, length, skipped))
+        return;
+
+    BufferAccess::fillSpan(mapping, x, y, length, color);
+    state.content.add(x, y, length, 1);
+}
+
+void TileCanvas::setRow(unsigned int x, unsigned int y, unsigned int length, const float* rgb)
+{
+    unsigned int skipped;
+    if(!clipSpan(x, y, length, skipped))
+        return;
+
+    BufferAccess::storeRow(mapping, x, y, length, rgb + 3 * skipped);
+    state.content.add(x, y, length, 1);
+}
+
+void TileCanvas::setRow(unsigned int x, unsigned int y, unsigned int length, const QRgb* pixels)
+{
+    unsigned int skipped;
+    if(!clipSpan(x, y, length, skipped))
+        return;
+
+    BufferAccess::storeRow(mapping, x, y, length, pixels + skipped);
+    state.content.add(x, y, length, 1);
+}
+
+void TileCanvas::fillRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const QVector3D& color)
+{
+    if(y >= bottom)
+        return;
+
+    // y + height kann überlaufen, siehe SoftwareCanvas::fillRect
+    unsigned int firstRow = qMax(y, top);
+    unsigned int lastRow = y + qMin(height, bottom - y);
+
+    if(firstRow >= lastRow)
+        return;
+
+    unsigned int skipped;
+    if(!clipSpan(x, firstRow, width, skipped))
+        return;
+
+    for(unsigned int row = firstRow; row < lastRow; row++)
+        BufferAccess::fillSpan(mapping, x, row, width, color);
+
+    state.content.add(x, firstRow, width, lastRow - firstRow);
+}
+
+void TileCanvas::setClipRect(const QRect& rect)
+{
+    const QRect clip = rect.isNull() ? tile : tile.intersected(rect);
+
+    if(clip.isEmpty())
+    {
+        left = top = right = bottom = 0;
+        return;
+    }
+
+    left = clip.left();
+    top = clip.top();
+    right = clip.right() + 1;
+    bottom = clip.bottom() + 1;
+}
+
+QRect TileCanvas::clipRect()
+{
+    if(left >= right || top >= bottom)
+        return QRect();
+
+    return QRect(left, top, right - left, bottom - top);
+}
+
+QVector3D TileCanvas::getPixel(unsigned int x, unsigned int y)
+{
+    if(x >= mapping.width || y >= mapping.height)
+        return QVector3D();
+
+    return BufferAccess::getPixel(mapping, x, y);
+}
+
+void TileCanvas::getRow(unsigned int x, unsigned int y, unsigned int length, QRgb* pixels)
+{
+    if(y >= mapping.height || x >= mapping.width)
+        return;
+
+    length = qMin(length, mapping.width - x);
+    BufferAccess::loadRow(mapping, x, y, length, pixels);
+}
+
+GdvCanvas::BufferMapping TileCanvas::mapBuffer()
+{
+    return mapping;
+}
+
+void TileCanvas::unmapBuffer()
+{
+    state.content.add(tile);
+}
+
+void TileCanvas::unmapBuffer(const QRect& modified)
+{
+    state.content.add(modified.intersected(tile));
+}
+
+void TileCanvas::clearBuffer(const QVector3D& clearColor)
+{
+    if(depth)
+        depth->clear(clipRect());
+
+    if(clipRect() != tile)
+    {
+        // Siehe GdvCanvas2D::clearBuffer
+        fillRect(left, top, right - left, bottom - top, clearColor);
+        state.clearValid = false;
+        return;
+    }
+
+    DirtyRect area;
+    if(state.clearValid && clearColor == state.clearColor)
+        area = state.content;
+    else
+        area.add(tile);
+
+    for(unsigned int row = area.top; row < area.bottom; row++)
+        BufferAccess::fillSpan(mapping, area.left, row, area.right - area.left, clearColor);
+
+    state.changed.add(area);
+    state.content.clear();
+    state.clearValid = true;
+    state.clearColor = clearColor;
+}
+
+DepthBuffer* TileCanvas::depthBuffer()
+{
+    return depth;
+}
+
+MultisampleBuffer* TileCanvas::multisampleBuffer()
+{
+    // Im Kachelmodus wird kein Multisampling unterstützt
+    return 0;
+}
+
+void TileCanvas::setToneMapping(ToneMapping mode, float exposure, bool sRGB)
+{
+    // Gilt für das gesamte Bild und muss daher in beginFrame gesetzt werden
+    Q_UNUSED(mode); Q_UNUSED(exposure); Q_UNUSED(sRGB);
+}
+
+void TileCanvas::flipBuffer()
+{
+    // Wird nach dem Zeichnen aller Kacheln vom TileRenderer übernommen
+}
+
+void TileCanvas::flipBuffer(const QImage& buffer)
+{
+    Q_UNUSED(buffer);
+}
+
+
+
+TileRenderer::TileRenderer(int tileSize) :
+    tileSize(tileSize), tiledWidth(0), tiledHeight(0), tiledBits(0), tiledFormat(GdvCanvas::FormatRGB32)
+{
+}
+
+void TileRenderer::invalidate()
+{
+    tiledWidth = tiledHeight = 0;
+}
+
+void TileRenderer::renderFrame(RendererBase& renderer, GdvCanvas& canvas)
+{
+    {
+        GDV_PROFILE_ZONE("begin frame");
+        renderer.beginFrame(canvas);
+    }
+
+    const GdvCanvas::BufferMapping mapping = canvas.mapBuffer();
+
+    DirtyRect modified;
+    const QRect clip = canvas.clipRect();
+    DepthBuffer* depth = canvas.depthBuffer();
+
+    if(mapping.isValid())
+    {
+        if(mapping.width != tiledWidth || mapping.height != tiledHeight ||
+           mapping.bits != tiledBits || mapping.format != tiledFormat)
+        {
+            tiles.clear();
+            for(unsigned int y = 0; y < mapping.height; y += tileSize)
+            {
+                for(unsigned int x = 0; x < mapping.width; x += tileSize)
+                {
+                    tiles.append(QRect(x, y,
+                                       qMin<unsigned int>(tileSize, mapping.width - x),
+                                       qMin<unsigned int>(tileSize, mapping.height - y)));
+                }
+            }
+
+            // Der Inhalt ist unbekannt, beim ersten clearBuffer wird alles gelöscht
+            states.fill(TileState(), tiles.size());
+
+            tiledWidth = mapping.width;
+            tiledHeight = mapping.height;
+            tiledBits = mapping.bits;
+            tiledFormat = mapping.format;
+        }
+
+        TileState* tileStates = states.data();
+        WorkerPool::instance().run(tiles.size(), [&](int index)
+        {
+            GDV_PROFILE_ZONE("tile");
+            TileCanvas tileCanvas(mapping, depth, tiles[index], clip, tileStates[index]);
+            renderer.renderTile(tileCanvas, tiles[index]);
+        });
+
+        for(int n = 0; n < states.size(); n++)
+        {
+            modified.add(states[n].changed);
+            modified.add(states[n].content);
+            states[n].changed.clear();
+            outOfBounds.merge(states[n].outOfBounds);
+        }
+    }
+
+    outOfBounds.endFrame();
+
+    canvas.unmapBuffer(modified.toRect());
+    canvas.flipBuffer();
+}
@@ -0,0 +1,116 @@
+#ifndef TILERENDERER_H
+#define TILERENDERER_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include "interfaces/GdvCanvas.h"
+#include "dirtyrect.h"
+#include "outofboundscounter.h"
+#include <QRect>
+#include <QVector>
+
+class RendererBase;
+
+/**
+ * @brief Die TileState Struktur
+ *
+ * Was der TileRenderer von Bild zu Bild über eine Kachel weiß: Welcher
+ * Bereich seit dem letzten clearBuffer bemalt wurde (nur dieser muss beim
+ * nächsten clearBuffer mit derselben Farbe gelöscht werden) und welcher
+ * Bereich sich im aktuellen Bild verändert hat.
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+struct TileState
+{
+    DirtyRect content;
+    DirtyRect changed;
+    QVector3D clearColor;
+    bool clearValid = false;
+    OutOfBoundsCounter outOfBounds;
+};
+
+/**
+ * @brief Die TileCanvas Klasse
+ *
+ * Die Zeichenfläche, die renderTile übergeben wird. Schreibt direkt in den
+ * abgebildeten Back-Buffer, beschränkt auf die jeweilige Kachel. Da sich die
+ * Kacheln nicht überlappen, können mehrere TileCanvas-Instanzen gleichzeitig
+ * aus verschiedenen Threads verwendet werden.
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class TileCanvas : public GdvCanvas
+{
+public:
+    TileCanvas(const BufferMapping& mapping, DepthBuffer* depth, const QRect& tile, const QRect& clip, TileState& state);
+
+    virtual void setPixel(unsigned int x, unsigned int y, const QVector3D& color);
+    virtual void setPixelUnchecked(unsigned int x, unsigned int y, const QVector3D& color);
+    virtual void setSpan(unsigned int x, unsigned int y, unsigned int length, const QVector3D& color);
+    virtual void setRow(unsigned int x, unsigned int y, unsigned int length, const float* rgb);
+    virtual void setRow(unsigned int x, unsigned int y, unsigned int length, const QRgb* pixels);
+    virtual void fillRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const QVector3D& color);
+    virtual void setClipRect(const QRect& rect);
+    virtual QRect clipRect();
+    virtual QVector3D getPixel(unsigned int x, unsigned int y);
+    virtual void getRow(unsigned int x, unsigned int y, unsigned int length, QRgb* pixels);
+    virtual BufferMapping mapBuffer();
+    virtual void unmapBuffer();
+    virtual void unmapBuffer(const QRect& modified);
+    virtual void clearBuffer(const QVector3D& clearColor);
+    virtual DepthBuffer* depthBuffer();
+    virtual MultisampleBuffer* multisampleBuffer();
+    virtual void setToneMapping(ToneMapping mode, float exposure = 1.0f, bool sRGB = false);
+    virtual void flipBuffer();
+    virtual void flipBuffer(const QImage& buffer);
+
+private:
+    bool clipSpan(unsigned int& x, unsigned int y, unsigned int& length, unsigned int& skipped) const;
+
+    BufferMapping mapping;
+    DepthBuffer* depth;
+    TileState& state;
+    QRect tile;
+    unsigned int left, top, right, bottom; // Clip-Rechteck, right/bottom exklusiv
+};
+
+/**
+ * @brief Die TileRenderer Klasse
+ *
+ * Zeichnet ein Bild einer Abgabe, die usesTiles() unterstützt: Der Viewport
+ * wird in Kacheln zerlegt, die auf alle Prozessorkerne verteilt mit
+ * renderTile gezeichnet werden. Anschließend wird flipBuffer aufgerufen.
+ *
+ * Für jede Kachel wird der bemalte Bereich mitgeführt, sodass clearBuffer
+ * nur löscht, was im letzten Bild bemalt wurde, und der Zeichenfläche nur
+ * die tatsächlich veränderten Bereiche gemeldet werden.
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class TileRenderer
+{
+public:
+    explicit TileRenderer(int tileSize = 64);
+
+    void renderFrame(RendererBase& renderer, GdvCanvas& canvas);
+    void invalidate();
+
+private:
+    int tileSize;
+    QVector<QRect> tiles;
+    QVector<TileState> states;
+    OutOfBoundsCounter outOfBounds;
+
+    // Ändert sich eines davon, ist der Inhalt des Back-Buffers unbekannt
+    unsigned int tiledWidth, tiledHeight;
+    const unsigned char* tiledBits;
+    GdvCanvas::PixelFormat tiledFormat;
+};
+
+#endif // TILERENDERER_H
@@ -0,0 +1,181 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "workerpool.h"
+#include "profiler.h"
+#include <QThread>
+
+static thread_local bool insideWorkerPool = false;
+
+static inline unsigned long long packRange(unsigned int begin, unsigned int end)
+{
+    return (static_cast<unsigned long long>(begin) << 32) | end;
+}
+
+WorkerPool::WorkerPool(int threadCount) :
+    generation(0), busyWorkers(0), stopping(false), currentJob(0)
+{
+    if(threadCount <= 0)
+        threadCount = qMax(1, QThread::idealThreadCount());
+
+    participants = threadCount;
+    ranges = new JobRange[participants];
+    for(int n = 0; n < participants; n++)
+        ranges[n].range = 0;
+
+    // Teilnehmer 0 ist der aufrufende Thread
+    for(int n = 1; n < participants; n++)
+        threads.push_back(std::thread(&WorkerPool::workerLoop, this, n));
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+
+    for(size_t n = 0; n < threads.size(); n++)
+        threads[n].join();
+
+    delete[] ranges;
+}
+
+WorkerPool& WorkerPool::instance()
+{
+    static WorkerPool pool;
+    return pool;
+}
+
+int WorkerPool::threadCount() const
+{
+    return participants;
+}
+
+void WorkerPool::run(int jobCount, const std::function<void(int)>& job)
+{
+    if(jobCount <= 0)
+        return;
+
+    if(insideWorkerPool || participants == 1 || jobCount == 1)
+    {
+        for(int n = 0; n < jobCount; n++)
+            job(n);
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(runMutex);
+
+    // Aufgaben gleichmäßig in zusammenhängende Bereiche aufteilen
+    for(int n = 0; n < participants; n++)
+    {
+        unsigned int begin = static_cast<unsigned int>(static_cast<long long>(jobCount) * n / participants);
+        unsigned int end = static_cast<unsigned int>(static_cast<long long>(jobCount) * (n + 1) / participants);
+        ranges[n].range.store(packRange(begin, end), std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        currentJob = &job;
+        busyWorkers = participants - 1;
+        generation++;
+    }
+    wakeWorkers.notify_all();
+
+    insideWorkerPool = true;
+    process(0);
+    insideWorkerPool = false;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    wakeCaller.wait(lock, [this]() { return busyWorkers == 0; });
+    currentJob = 0;
+}
+
+void WorkerPool::workerLoop(int index)
+{
+    insideWorkerPool = true;
+    Profiler::setThreadName(QString("Worker %1").arg(index));
+    unsigned long seenGeneration = 0;
+
+    for(;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeWorkers.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+
+            if(stopping)
+                return;
+
+            seenGeneration = generation;
+        }
+
+        process(index);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if(--busyWorkers == 0)
+            wakeCaller.notify_one();
+    }
+}
+
+void WorkerPool::process(int index)
+{
+    const std::function<void(int)>& job = *currentJob;
+    int next;
+
+    while(popJob(index, next) || stealJob(index, next))
+        job(next);
+}
+
+bool WorkerPool::popJob(int index, int& job)
+{
+    std::atomic<unsigned long long>& range = ranges[index].range;
+    unsigned long long current = range.load();
+
+    for(;;)
+    {
+        unsigned int begin = static_cast<unsigned int>(current >> 32);
+        unsigned int end = static_cast<unsigned int>(current);
+
+        if(begin >= end)
+            return false;
+
+        if(range.compare_exchange_weak(current, packRange(begin + 1, end)))
+        {
+            job = static_cast<int>(begin);
+            return true;
+        }
+    }
+}
+
+bool WorkerPool::stealJob(int index, int& job)
+{
+    for(int offset = 1; offset < participants; offset++)
+    {
+        std::atomic<unsigned long long>& range = ranges[(index + offset) % participants].range;
+        unsigned long long current = range.load();
+
+        for(;;)
+        {
+            unsigned int begin = static_cast<unsigned int>(current >> 32);
+            unsigned int end = static_cast<unsigned int>(current);
+
+            if(begin >= end)
+                break;
+
+            if(range.compare_exchange_weak(current, packRange(begin, end - 1)))
+            {
+                job = static_cast<int>(end - 1);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
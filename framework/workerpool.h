@@ -0,0 +1,75 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/**
+ * @brief Die WorkerPool Klasse
+ *
+ * Verteilt eine Anzahl unabhängiger Aufgaben (z.B. Bildkacheln) auf alle
+ * Prozessorkerne. Jeder Thread erhält zunächst einen zusammenhängenden
+ * Bereich von Aufgaben; ist dieser abgearbeitet, werden Aufgaben vom Ende
+ * der Bereiche anderer Threads übernommen ("work stealing").
+ *
+ * run() kehrt erst zurück, wenn alle Aufgaben erledigt sind. Der aufrufende
+ * Thread arbeitet dabei mit. Aufrufe von run() aus einer laufenden Aufgabe
+ * heraus werden seriell abgearbeitet.
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class WorkerPool
+{
+public:
+    explicit WorkerPool(int threadCount = 0);
+    ~WorkerPool();
+
+    static WorkerPool& instance();
+
+    void run(int jobCount, const std::function<void(int)>& job);
+
+    int threadCount() const;
+
+private:
+    WorkerPool(const WorkerPool&);
+    WorkerPool& operator=(const WorkerPool&);
+
+    void workerLoop(int index);
+    void process(int index);
+    bool popJob(int index, int& job);
+    bool stealJob(int index, int& job);
+
+    // Je Teilnehmer ein Bereich [begin, end), gepackt in einen 64-Bit Wert
+    struct JobRange
+    {
+        std::atomic<unsigned long long> range;
+        char padding[64 - sizeof(std::atomic<unsigned long long>)];
+    };
+
+    std::vector<std::thread> threads;
+    JobRange* ranges;
+    int participants;
+
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable wakeCaller;
+    unsigned long generation;
+    int busyWorkers;
+    bool stopping;
+
+    const std::function<void(int)>* currentJob;
+    std::mutex runMutex;
+};
+
+#endif // WORKERPOOL_H
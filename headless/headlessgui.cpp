@@ -0,0 +1,160 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "headlessgui.h"
+#include "interfaces/RendererBase.h"
+
+#include <QDebug>
+
+HeadlessGui::HeadlessGui() :
+    defaultIndex(0)
+{
+}
+
+HeadlessGui::~HeadlessGui()
+{
+    foreach(RendererBase* r, allLectures)
+    {
+        delete r;
+    }
+}
+
+void HeadlessGui::addCheckBox(QString label, bool defaultValue, bool& mappedValue)
+{
+    mappedValue = defaultValue;
+
+    if(overrides.contains(label))
+    {
+        const QString value = overrides.value(label).toLower();
+        mappedValue = value == "true" || value == "1" || value == "on";
+        usedOverrides.append(label);
+    }
+}
+
+void HeadlessGui::addColorSelector(QString label, QVector3D defaultValue, QVector3D& mappedValue)
+{
+    mappedValue = defaultValue;
+
+    if(overrides.contains(label))
+    {
+        const QStringList parts = overrides.value(label).split(',');
+        if(parts.size() == 3)
+            mappedValue = QVector3D(parts[0].toFloat(), parts[1].toFloat(), parts[2].toFloat());
+        else
+            qWarning() << "Color" << label << "expects r,g,b - keeping default value.";
+        usedOverrides.append(label);
+    }
+}
+
+void HeadlessGui::addSlider(QString label, int minimalValue, int maximalValue, int defaultValue, int& mappedValue)
+{
+    mappedValue = defaultValue;
+
+    if(overrides.contains(label))
+    {
+        mappedValue = qBound(minimalValue, overrides.value(label).toInt(), maximalValue);
+        usedOverrides.append(label);
+    }
+}
+
+void HeadlessGui::addLabel(QString defaultValue, QString& mappedValue, QString styleSheet)
+{
+    Q_UNUSED(styleSheet);
+    mappedValue = defaultValue;
+}
+
+void HeadlessGui::addLabel(QString value, QString styleSheet)
+{
+    Q_UNUSED(value);
+    Q_UNUSED(styleSheet);
+}
+
+void HeadlessGui::addButton(QString label, std::function<void()> fun)
+{
+    buttons.insert(label, fun);
+}
+
+void HeadlessGui::addDropdownList(QString entries, unsigned int defaultIndex, std::function<void(int)> fun)
+{
+    // Wie im Hauptprogramm wird die Voreinstellung nicht gemeldet
+    Q_UNUSED(defaultIndex);
+
+    // Ohne Beschriftung dient die Liste der Einträge als Name, z.B. "TestA;TestB;TestC=TestB"
+    if(overrides.contains(entries))
+    {
+        const QStringList entryList = entries.split(';');
+        const QString value = overrides.value(entries);
+
+        bool isNumber = false;
+        int index = value.toInt(&isNumber);
+        if(!isNumber)
+            index = entryList.indexOf(value);
+
+        if(index >= 0 && index < entryList.size())
+            selections.append([fun, index]() { fun(index); });
+        else
+            qWarning() << "Dropdown list" << entries << "has no entry" << value << "- keeping default value.";
+        usedOverrides.append(entries);
+    }
+}
+
+void HeadlessGui::addSeparator()
+{
+}
+
+void HeadlessGui::clearElements()
+{
+    buttons.clear();
+    selections.clear();
+}
+
+void HeadlessGui::addLecture(QString identifier, RendererBase* renderer)
+{
+    allLectures.append(renderer);
+    names.append(identifier);
+}
+
+void HeadlessGui::setDefaultIndices(unsigned int lecture, unsigned int mesh, unsigned int texture)
+{
+    Q_UNUSED(mesh);
+    Q_UNUSED(texture);
+    defaultIndex = lecture;
+}
+
+void HeadlessGui::setOverride(const QString& label, const QString& value)
+{
+    overrides.insert(label, value);
+}
+
+bool HeadlessGui::press(const QString& label)
+{
+    if(!buttons.contains(label))
+        return false;
+
+    buttons.value(label)();
+    return true;
+}
+
+void HeadlessGui::applySelections()
+{
+    for(int n = 0; n < selections.size(); n++)
+        selections[n]();
+    selections.clear();
+}
+
+QStringList HeadlessGui::unusedOverrides() const
+{
+    QStringList unused;
+    foreach(const QString& label, overrides.keys())
+    {
+        if(!usedOverrides.contains(label))
+            unused.append(label);
+    }
+    return unused;
+}
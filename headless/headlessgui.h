@@ -0,0 +1,94 @@
+#ifndef HEADLESSGUI_H
+#define HEADLESSGUI_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "interfaces/GdvGui.h"
+
+#include <QMap>
+#include <QVector>
+#include <QStringList>
+
+/**
+ * @brief Die HeadlessGui Klasse
+ *
+ * GdvGui-Implementierung ohne Fenster für den Headless-Runner. Die
+ * verknüpften Variablen erhalten ihren voreingestellten Wert, es sei denn,
+ * für die Beschriftung wurde mit setOverride ein anderer Wert vorgegeben.
+ * Für eine Auswahlliste wird deren Methode erst mit applySelections
+ * aufgerufen. Buttons können mit press ausgelöst werden. Alle übrigen
+ * Elemente werden ignoriert. Die eingetragenen Abgaben gehören der HeadlessGui.
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class HeadlessGui : public GdvGui
+{
+public:
+    HeadlessGui();
+    ~HeadlessGui();
+
+    virtual void addCheckBox(QString label, bool defaultValue, bool& mappedValue);
+    virtual void addColorSelector(QString label, QVector3D defaultValue, QVector3D& mappedValue);
+    virtual void addSlider(QString label, int minimalValue, int maximalValue, int defaultValue, int& mappedValue);
+    virtual void addLabel(QString defaultValue, QString& mappedValue, QString styleSheet = "font-weight:bold;");
+    virtual void addLabel(QString value, QString styleSheet = "font-weight:bold;");
+
+    virtual void addButton(QString label, std::function<void()> fun);
+    virtual void addDropdownList(QString entries, unsigned int defaultIndex, std::function<void(int)> fun);
+
+    virtual void addSeparator();
+    virtual void clearElements();
+
+    virtual void addLecture(QString identifier, RendererBase* renderer);
+    virtual void setDefaultIndices(unsigned int lecture, unsigned int mesh, unsigned int texture);
+
+    /**
+     * @brief setOverride Gibt den Wert eines Elements vor, bevor die Abgabe es anlegt
+     * @param label Die Beschriftung des Elements (Checkbox, Slider oder Farbauswahl),
+     *              bei Auswahllisten die Einträge wie bei addDropdownList ("A;B;C")
+     * @param value "true"/"false" bzw. eine Zahl bzw. "r,g,b" im Bereich 0.0..1.0,
+     *              bei Auswahllisten der Eintrag oder dessen Index
+     */
+    void setOverride(const QString& label, const QString& value);
+
+    /**
+     * @brief press Löst den Button mit der Beschriftung label aus
+     * @return false, falls die Abgabe keinen solchen Button angelegt hat
+     */
+    bool press(const QString& label);
+
+    /**
+     * @brief applySelections Ruft für jede Auswahlliste mit Vorgabe deren Methode mit dem vorgegebenen Eintrag auf
+     *
+     * Wie im Hauptprogramm erst, nachdem die Abgabe initialisiert wurde.
+     */
+    void applySelections();
+
+    /**
+     * @brief unusedOverrides Vorgaben, zu denen die Abgabe kein Element angelegt hat
+     */
+    QStringList unusedOverrides() const;
+
+    const QVector<RendererBase*>& lectures() const { return allLectures; }
+    const QStringList& lectureNames() const { return names; }
+    unsigned int defaultLecture() const { return defaultIndex; }
+
+private:
+    QVector<RendererBase*> allLectures;
+    QStringList names;
+    unsigned int defaultIndex;
+
+    QMap<QString, QString> overrides;
+    QStringList usedOverrides;
+
+    QMap<QString, std::function<void()> > buttons;
+    QVector<std::function<void()> > selections;
+};
+
+#endif // HEADLESSGUI_H
@@ -0,0 +1,309 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "headlessrunner.h"
+#include "headlessgui.h"
+#include "framework/meshloader.h"
+#include "framework/profiler.h"
+#include "interfaces/RendererBase.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+
+HeadlessRunner::HeadlessRunner(HeadlessGui& gui) :
+    gui(gui), width(0), height(0), faceCount(0), setupTime(0),
+    capturedFrames(0), droppedFrames(0), tracedZones(0), droppedZones(0)
+{
+}
+
+bool HeadlessRunner::run(const HeadlessSettings& settings)
+{
+    error.clear();
+    times.clear();
+    allocations.clear();
+    callSites.clear();
+    capturedFrames = droppedFrames = 0;
+    tracedZones = droppedZones = 0;
+
+    RendererBase* lecture = findLecture(settings.lecture);
+    if(!lecture)
+        return false;
+
+    if(lecture->usesOpenGL())
+    {
+        error = QString("Lecture '%1' uses OpenGL, which is not supported without a display.").arg(lectureName);
+        return false;
+    }
+
+    if(settings.width <= 0 || settings.height <= 0 || settings.frames <= 0)
+    {
+        error = "Size and number of frames must be positive.";
+        return false;
+    }
+
+    // Mesh und Textur wie im Hauptprogramm laden
+    QString meshFile = settings.meshFile;
+    if(meshFile.isEmpty())
+        meshFile = firstFile("meshes/", QStringList() << "*.ply" << "*.PLY");
+
+    QString textureFile = settings.textureFile;
+    if(textureFile.isEmpty())
+        textureFile = firstFile("textures/", QStringList() << "*.png" << "*.jpg" << "*.jpeg" << "*.bmp");
+
+    if(meshFile.isEmpty() || textureFile.isEmpty())
+    {
+        error = "No mesh/texture specified and none found in meshes/ and textures/.";
+        return false;
+    }
+
+    MeshLoader mesh(meshFile);
+    mesh.parseFile();
+    if(!mesh.isValid())
+    {
+        error = QString("Could not load mesh '%1'.").arg(meshFile);
+        return false;
+    }
+
+    QImage texture(textureFile);
+    if(texture.isNull())
+    {
+        error = QString("Could not load texture '%1'.").arg(textureFile);
+        return false;
+    }
+    texture = texture.convertToFormat(QImage::Format_RGB32);
+
+    meshName = QFileInfo(meshFile).completeBaseName();
+    textureName = QFileInfo(textureFile).completeBaseName();
+    faceCount = mesh.faces().size();
+    width = settings.width;
+    height = settings.height;
+
+    // Siehe MainWindow::activateLecture
+    QElapsedTimer timer;
+    timer.start();
+
+    canvas.setHDREnabled(lecture->usesHDR());
+    canvas.setToneMapping(GdvCanvas::ToneMapClamp);
+    canvas.setClipRect(QRect());
+    canvas.setDepthBufferEnabled(lecture->usesDepthBuffer());
+    canvas.setSampleCount(!lecture->usesTiles() ? lecture->sampleCount() : 1);
+    canvas.resizeBuffer(width, height);
+    tileRenderer.invalidate();
+
+    lecture->setupGUI(gui);
+    lecture->initialize();
+    lecture->sizeChanged(width, height);
+    lecture->meshChanged(mesh.faces());
+    lecture->textureChanged(texture);
+    gui.applySelections();
+
+    foreach(const QString& button, settings.buttons)
+    {
+        if(!gui.press(button))
+            qWarning() << "Lecture has no button" << button << "- ignored.";
+    }
+
+    foreach(const QString& label, gui.unusedOverrides())
+        qWarning() << "Lecture has no element" << label << "- value ignored.";
+
+    setupTime = timer.nsecsElapsed();
+
+    // Aufgezeichnet werden nur die gemessenen Bilder
+    if(!settings.captureFile.isEmpty() && !capture.start(settings.captureFile))
+    {
+        error = capture.errorString();
+        gui.clearElements();
+        lecture->deinitialize();
+        return false;
+    }
+
+    const bool captureCallSites = settings.allocationSites > 0 && AllocationTracker::canCaptureCallSites();
+    if(settings.allocationSites > 0 && !captureCallSites)
+        qWarning() << "Allocation call sites need CONFIG+=gdv_alloc_tracking and glibc - ignored.";
+
+    // Im Voraus reserviert, damit das Messen selbst keinen Speicher anfordert
+    const int totalFrames = qMax(settings.warmupFrames, 0) + settings.frames;
+    times.reserve(settings.frames);
+    allocations.reserve(settings.frames);
+
+    for(int frame = 0; frame < totalFrames; frame++)
+    {
+        if(frame == totalFrames - settings.frames && !settings.captureFile.isEmpty())
+            canvas.setFrameCapture(&capture);
+
+        if(frame == totalFrames - settings.frames && !settings.traceFile.isEmpty())
+            Profiler::instance().start();
+
+        if(frame == totalFrames - settings.frames && captureCallSites)
+            AllocationTracker::setCallSiteCapture(true);
+
+        const AllocationTracker::Counters allocatedBefore = AllocationTracker::total();
+        timer.restart();
+        {
+            GDV_PROFILE_ZONE("render");
+            if(lecture->usesTiles())
+                tileRenderer.renderFrame(*lecture, canvas);
+            else
+                lecture->render(canvas);
+        }
+        const qint64 elapsed = timer.nsecsElapsed();
+        const AllocationTracker::Counters allocated = AllocationTracker::total() - allocatedBefore;
+
+        if(frame >= totalFrames - settings.frames)
+        {
+            times.append(elapsed);
+            allocations.append(allocated);
+        }
+    }
+
+    if(captureCallSites)
+    {
+        AllocationTracker::setCallSiteCapture(false);
+        callSites = AllocationTracker::topCallSites(settings.allocationSites);
+    }
+
+    if(!settings.captureFile.isEmpty())
+    {
+        canvas.setFrameCapture(0);
+        capture.stop();
+        capturedFrames = capture.capturedFrames();
+        droppedFrames = capture.droppedFrames();
+        if(!capture.errorString().isEmpty())
+            error = capture.errorString();
+    }
+
+    if(!settings.traceFile.isEmpty())
+    {
+        Profiler& profiler = Profiler::instance();
+        profiler.stop();
+        tracedZones = profiler.recordedZones();
+        droppedZones = profiler.droppedZones();
+        if(!profiler.exportChromeTrace(settings.traceFile))
+            error = profiler.errorString();
+    }
+
+    if(!settings.outputFile.isEmpty() && !canvas.frame().save(settings.outputFile))
+        error = QString("Could not save the last frame to '%1'.").arg(settings.outputFile);
+
+    gui.clearElements();
+    lecture->deinitialize();
+
+    return error.isEmpty();
+}
+
+void HeadlessRunner::printReport(QTextStream& out) const
+{
+    if(times.isEmpty())
+        return;
+
+    QVector<qint64> sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+
+    qint64 total = 0;
+    foreach(qint64 t, times)
+        total += t;
+
+    // Perzentil als nächstgelegener Rang
+    auto percentile = [&](double p)
+    {
+        const int rank = qBound(0, static_cast<int>(p / 100.0 * sorted.size() + 0.5) - 1, sorted.size() - 1);
+        return sorted[rank] / 1.0e6;
+    };
+
+    const double average = total / 1.0e6 / times.size();
+
+    out << "lecture: " << lectureName << "\n";
+    out << "mesh: " << meshName << " (" << faceCount << " faces)\n";
+    out << "texture: " << textureName << "\n";
+    out << "size: " << width << "x" << height << "\n";
+    out << "frames: " << times.size() << "\n";
+    out << "setup_ms: " << setupTime / 1.0e6 << "\n";
+    out << "total_ms: " << total / 1.0e6 << "\n";
+    out << "min_ms: " << sorted.first() / 1.0e6 << "\n";
+    out << "average_ms: " << average << "\n";
+    out << "median_ms: " << percentile(50.0) << "\n";
+    out << "p95_ms: " << percentile(95.0) << "\n";
+    out << "p99_ms: " << percentile(99.0) << "\n";
+    out << "max_ms: " << sorted.last() / 1.0e6 << "\n";
+    out << "fps: " << (average > 0.0 ? 1000.0 / average : 0.0) << "\n";
+    if(capturedFrames + droppedFrames > 0)
+    {
+        out << "captured_frames: " << capturedFrames << "\n";
+        out << "dropped_frames: " << droppedFrames << "\n";
+    }
+    if(AllocationTracker::isAvailable())
+    {
+        qint64 allocationCount = 0, freeCount = 0, bytes = 0, maxAllocations = 0;
+        int allocatingFrames = 0;
+        foreach(const AllocationTracker::Counters& frame, allocations)
+        {
+            allocationCount += frame.allocations;
+            freeCount += frame.frees;
+            bytes += frame.bytes;
+            maxAllocations = qMax(maxAllocations, frame.allocations);
+            if(frame.allocations > 0)
+                allocatingFrames++;
+        }
+
+        out << "allocations_per_frame: " << allocationCount / static_cast<double>(allocations.size()) << "\n";
+        out << "frees_per_frame: " << freeCount / static_cast<double>(allocations.size()) << "\n";
+        out << "allocated_bytes_per_frame: " << bytes / static_cast<double>(allocations.size()) << "\n";
+        out << "max_allocations: " << maxAllocations << "\n";
+        out << "frames_with_allocations: " << allocatingFrames << "\n";
+    }
+    for(int n = 0; n < callSites.size(); n++)
+    {
+        out << "allocation_site_" << n + 1 << ": " << callSites[n].allocations << " allocations, "
+            << callSites[n].bytes << " bytes\n";
+        foreach(const QString& frame, callSites[n].frames)
+            out << "    " << frame << "\n";
+    }
+    if(tracedZones + droppedZones > 0)
+    {
+        out << "trace_zones: " << tracedZones << "\n";
+        out << "dropped_zones: " << droppedZones << "\n";
+    }
+    out.flush();
+}
+
+RendererBase* HeadlessRunner::findLecture(const QString& lecture)
+{
+    const QStringList& names = gui.lectureNames();
+
+    int index = gui.defaultLecture();
+    if(!lecture.isEmpty())
+    {
+        bool isNumber = false;
+        index = lecture.toInt(&isNumber);
+        if(!isNumber)
+            index = names.indexOf(lecture);
+    }
+
+    if(index < 0 || index >= names.size())
+    {
+        error = QString("Unknown lecture '%1'. Available: %2").arg(lecture, names.join(", "));
+        return 0;
+    }
+
+    lectureName = names.at(index);
+    return gui.lectures().at(index);
+}
+
+QString HeadlessRunner::firstFile(const QString& directory, const QStringList& nameFilters)
+{
+    QDir searchDir(directory);
+    searchDir.setNameFilters(nameFilters);
+    const QStringList files = searchDir.entryList(QDir::Files | QDir::NoDotAndDotDot | QDir::Readable, QDir::Name | QDir::IgnoreCase);
+
+    return files.isEmpty() ? QString() : directory + files.first();
+}
@@ -0,0 +1,111 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+
+#include "framework/softwarecanvas.h"
+#include "framework/tilerenderer.h"
+#include "framework/framecapture.h"
+#include "framework/allocationtracker.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QTextStream>
+
+class HeadlessGui;
+class RendererBase;
+
+/**
+ * @brief Die HeadlessSettings Struktur
+ *
+ * Was der HeadlessRunner zeichnen soll. Leere Dateinamen wählen wie im
+ * Hauptprogramm das erste Mesh aus meshes/ bzw. die erste Textur aus
+ * textures/.
+ */
+struct HeadlessSettings
+{
+    QString lecture;            // Name oder Index, leer: die mit setDefaultIndices gewählte Abgabe
+    QString meshFile;
+    QString textureFile;
+    int width = 800;
+    int height = 600;
+    int frames = 100;
+    int warmupFrames = 5;       // Werden gezeichnet, aber nicht gemessen
+    QStringList buttons;        // Werden vor dem ersten Bild ausgelöst
+    QString outputFile;         // Falls gesetzt, wird das letzte Bild gespeichert
+    QString captureFile;        // Falls gesetzt, werden alle Bilder aufgezeichnet (siehe FrameCapture)
+    QString traceFile;          // Falls gesetzt, werden die Zonen der gemessenen Bilder gespeichert (siehe Profiler)
+    int allocationSites = 0;    // Aufrufstellen mit den meisten Speicheranforderungen im Bericht (siehe AllocationTracker)
+};
+
+/**
+ * @brief Die HeadlessRunner Klasse
+ *
+ * Zeichnet eine Abgabe ohne Fenster und ohne Display in eine SoftwareCanvas
+ * und misst dabei die Zeit jedes einzelnen Bildes. Die Abgabe wird genauso
+ * vorbereitet wie im Hauptprogramm (HDR, Tiefenpuffer, Multisampling,
+ * Kacheln, setupGUI, initialize, sizeChanged, meshChanged, textureChanged),
+ * so lassen sich Performance-Messungen z.B. auf einem Server automatisieren.
+ * Abgaben mit usesOpenGL() werden nicht unterstützt.
+ *
+ * Interne Klasse, bitte nicht direkt einbinden und/oder verändern!
+ */
+class HeadlessRunner
+{
+public:
+    explicit HeadlessRunner(HeadlessGui& gui);
+
+    /**
+     * @brief run Bereitet die Abgabe vor, zeichnet alle Bilder und gibt sie wieder frei
+     * @return false bei einem Fehler, siehe errorString
+     */
+    bool run(const HeadlessSettings& settings);
+
+    QString errorString() const { return error; }
+
+    /**
+     * @brief frameTimes Die Dauer der gemessenen Bilder in Nanosekunden
+     */
+    const QVector<qint64>& frameTimes() const { return times; }
+
+    /**
+     * @brief frameAllocations Die Speicheranforderungen der gemessenen Bilder, falls AllocationTracker::isAvailable
+     */
+    const QVector<AllocationTracker::Counters>& frameAllocations() const { return allocations; }
+
+    /**
+     * @brief printReport Gibt die Messergebnisse zeilenweise als "Name: Wert" aus
+     */
+    void printReport(QTextStream& out) const;
+
+private:
+    RendererBase* findLecture(const QString& lecture);
+    static QString firstFile(const QString& directory, const QStringList& nameFilters);
+
+    HeadlessGui& gui;
+    SoftwareCanvas canvas;
+    TileRenderer tileRenderer;
+    FrameCapture capture;
+
+    QString error;
+    QString lectureName;
+    QString meshName;
+    QString textureName;
+    int width, height;
+    int faceCount;
+    qint64 setupTime;
+    int capturedFrames, droppedFrames;
+    int tracedZones, droppedZones;
+    QVector<qint64> times;
+    QVector<AllocationTracker::Counters> allocations;
+    QVector<AllocationTracker::CallSite> callSites;
+};
+
+#endif // HEADLESSRUNNER_H
@@ -0,0 +1,146 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+
+#include "headlessgui.h"
+#include "headlessrunner.h"
+#include "lectures.h"
+#include "framework/profiler.h"
+
+static void printUsage(QTextStream& out)
+{
+    out << "Usage: GDV-Headless [options]\n"
+           "\n"
+           "Renders a lecture without a window and reports the frame times.\n"
+           "\n"
+           "  --list                   List all lectures and exit\n"
+           "  --lecture <name|index>   Lecture to render (default: as in the GUI)\n"
+           "  --mesh <file>            PLY mesh (default: first file in meshes/)\n"
+           "  --texture <file>         Texture image (default: first file in textures/)\n"
+           "  --size <width>x<height>  Resolution (default: 800x600)\n"
+           "  --frames <n>             Number of measured frames (default: 100)\n"
+           "  --warmup <n>             Frames rendered before measuring (default: 5)\n"
+           "  --set <label>=<value>    Value of a check box, slider or color (r,g,b);\n"
+           "                           for a dropdown list use its entries as label\n"
+           "                           (\"A;B;C=B\") and an entry or index as value\n"
+           "  --press <label>          Click a button before the first frame\n"
+           "  --output <file>          Save the last frame as an image\n"
+           "  --capture <file>         Record the measured frames (.png/.ppm sequence\n"
+           "                           or .y4m video), frames are dropped if the disk\n"
+           "                           cannot keep up\n"
+           "  --trace <file>           Save the profiler zones of the measured frames\n"
+           "                           as JSON (chrome://tracing, ui.perfetto.dev)\n"
+           "  --alloc-sites <n>        Report the n call sites with the most heap\n"
+           "                           allocations (needs CONFIG+=gdv_alloc_tracking)\n";
+    out.flush();
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationName("GDV-Headless");
+    a.setApplicationVersion("r2");
+    a.setOrganizationName("Leibniz Universität Hannover - Welfenlab");
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    Profiler::setThreadName("Main");
+
+    HeadlessGui gui;
+    registerLectures(gui);
+
+    HeadlessSettings settings;
+    bool listOnly = false;
+
+    const QStringList args = a.arguments();
+    for(int n = 1; n < args.size(); n++)
+    {
+        const QString& arg = args.at(n);
+        const bool hasValue = n + 1 < args.size();
+        bool valid = true;
+
+        if(arg == "--help" || arg == "-h")
+        {
+            printUsage(out);
+            return 0;
+        }
+        else if(arg == "--list")
+            listOnly = true;
+        else if(arg == "--lecture" && hasValue)
+            settings.lecture = args.at(++n);
+        else if(arg == "--mesh" && hasValue)
+            settings.meshFile = args.at(++n);
+        else if(arg == "--texture" && hasValue)
+            settings.textureFile = args.at(++n);
+        else if(arg == "--size" && hasValue)
+        {
+            const QStringList size = args.at(++n).split('x');
+            valid = size.size() == 2;
+            if(valid)
+            {
+                settings.width = size[0].toInt();
+                settings.height = size[1].toInt();
+            }
+        }
+        else if(arg == "--frames" && hasValue)
+            settings.frames = args.at(++n).toInt(&valid);
+        else if(arg == "--warmup" && hasValue)
+            settings.warmupFrames = args.at(++n).toInt(&valid);
+        else if(arg == "--set" && hasValue)
+        {
+            const QString assignment = args.at(++n);
+            const int split = assignment.indexOf('=');
+            valid = split > 0;
+            if(valid)
+                gui.setOverride(assignment.left(split), assignment.mid(split + 1));
+        }
+        else if(arg == "--press" && hasValue)
+            settings.buttons.append(args.at(++n));
+        else if(arg == "--output" && hasValue)
+            settings.outputFile = args.at(++n);
+        else if(arg == "--capture" && hasValue)
+            settings.captureFile = args.at(++n);
+        else if(arg == "--trace" && hasValue)
+            settings.traceFile = args.at(++n);
+        else if(arg == "--alloc-sites" && hasValue)
+            settings.allocationSites = args.at(++n).toInt(&valid);
+        else
+            valid = false;
+
+        if(!valid)
+        {
+            err << "Invalid argument: " << arg << "\n\n";
+            err.flush();
+            printUsage(err);
+            return 1;
+        }
+    }
+
+    if(listOnly)
+    {
+        for(int n = 0; n < gui.lectureNames().size(); n++)
+            out << n << ": " << gui.lectureNames().at(n) << "\n";
+        return 0;
+    }
+
+    HeadlessRunner runner(gui);
+    const bool success = runner.run(settings);
+    runner.printReport(out);
+
+    if(!success)
+    {
+        err << "Error: " << runner.errorString() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
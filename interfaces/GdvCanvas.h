@@ -9,6 +9,11 @@
  **/
 
 #include <QVector3D>
+#include <QImage>
+#include <QRect>
+
+class DepthBuffer;
+class MultisampleBuffer;
 
 /**
  * @brief Die GdvCanvas Klasse
@@ -25,25 +30,280 @@
 class GdvCanvas
 {
 public:
+    /**
+     * @brief Die möglichen Pixelformate eines direkt abgebildeten Back-Buffers
+     *
+     * FormatRGB32: Ein QRgb (32 Bit, 0xffRRGGBB) je Pixel
+     * FormatRGBA32F: Vier floats (r, g, b, a) je Pixel, lineare Farbwerte ohne Begrenzung (HDR)
+     */
+    enum PixelFormat
+    {
+        FormatRGB32,
+        FormatRGBA32F
+    };
+
+    /**
+     * @brief Die Verfahren zur Umrechnung eines HDR-Back-Buffers in darstellbare Farben
+     *
+     * ToneMapClamp: Werte werden auf 0.0 bis 1.0 begrenzt
+     * ToneMapReinhard: c / (1 + c), erhält Details in hellen Bereichen
+     * ToneMapFilmic: Filmische Kurve (ACES-Näherung) mit kräftigerem Kontrast
+     */
+    enum ToneMapping
+    {
+        ToneMapClamp,
+        ToneMapReinhard,
+        ToneMapFilmic
+    };
+
+    /**
+     * @brief Die BufferMapping Struktur beschreibt den Speicher des Back-Buffers
+     *
+     * Wird von mapBuffer zurückgegeben. Die Zeilen des Puffers liegen nicht
+     * zwingend direkt hintereinander im Speicher: Zeile y beginnt bei
+     * bits + y * stride.
+     */
+    struct BufferMapping
+    {
+        unsigned char* bits;    // Zeiger auf das linke obere Pixel, 0 falls ungültig
+        unsigned int width;     // Breite in Pixeln
+        unsigned int height;    // Höhe in Pixeln
+        unsigned int stride;    // Abstand zweier Zeilen in Bytes
+        PixelFormat format;     // Format eines einzelnen Pixels
+
+        BufferMapping() : bits(0), width(0), height(0), stride(0), format(FormatRGB32) {}
+
+        bool isValid() const { return bits != 0; }
+
+        QRgb* rgbLine(unsigned int y) const
+        {
+            Q_ASSERT(format == FormatRGB32 && y < height);
+            return reinterpret_cast<QRgb*>(bits + y * stride);
+        }
+
+        float* floatLine(unsigned int y) const
+        {
+            Q_ASSERT(format == FormatRGBA32F && y < height);
+            return reinterpret_cast<float*>(bits + y * stride);
+        }
+    };
+
+    /**
+     * @brief Die ScopedMapping Klasse bildet den Back-Buffer für die Dauer eines Blocks ab
+     *
+     * Beispiel:
+     * {
+     *     GdvCanvas::ScopedMapping mapping(canvas);
+     *     for(unsigned int y = 0; y < mapping->height; y++)
+     *     {
+     *         QRgb* line = mapping->rgbLine(y);
+     *         ...
+     *     }
+     * } // <- hier wird unmapBuffer automatisch aufgerufen
+     */
+    class ScopedMapping
+    {
+    public:
+        explicit ScopedMapping(GdvCanvas& canvas) : canvas(canvas), mapping(canvas.mapBuffer()) {}
+        ~ScopedMapping() { canvas.unmapBuffer(); }
+
+        const BufferMapping& operator*() const { return mapping; }
+        const BufferMapping* operator->() const { return &mapping; }
+
+    private:
+        ScopedMapping(const ScopedMapping&);
+        ScopedMapping& operator=(const ScopedMapping&);
+
+        GdvCanvas& canvas;
+        BufferMapping mapping;
+    };
+
     /**
      * @brief setPixel Ändert die Farbe eines Pixels im Back-Buffer
      * @param x Die x-Koordinate des zu ändernden Pixels
      * @param y Die y-Koordinate des zu ändernden Pixels
      * @param color Die Farbe des Pixels in RGB-Darstellung, jeweils im Bereich 0.0 bis 1.0
      *
-     * Es ist unbedingt zu vermeiden, ausserhalb des aktuellen Viewports zu zeichnen.
-     * Zwar werden derartige Fehler abgefangen, die Ausführungsgeschwindigkeit wird
-     * jedoch drastisch (!) verlangsamt. Wird bei der Farbwahl der Bereich 0.0 bis 1.0
-     * verlassen, so ist die resultierende Farbe undefiniert.
+     * Pixel ausserhalb des Clip-Rechtecks (siehe setClipRect) werden verworfen.
+     * Pixel ausserhalb des aktuellen Viewports deuten auf einen Fehler hin: Sie
+     * werden gezählt und höchstens einmal pro Sekunde als Warnung ausgegeben.
+     * Wird bei der Farbwahl der Bereich 0.0 bis 1.0 verlassen, so ist die
+     * resultierende Farbe undefiniert - ausser die Abgabe verwendet einen
+     * HDR-Back-Buffer (siehe RendererBase::usesHDR).
      */
     virtual void setPixel(unsigned int x, unsigned int y, const QVector3D& color) = 0;
 
+    /**
+     * @brief setPixelUnchecked Ändert die Farbe eines Pixels ohne jede Prüfung der Koordinaten
+     * @param x Die x-Koordinate des zu ändernden Pixels
+     * @param y Die y-Koordinate des zu ändernden Pixels
+     * @param color Die Farbe des Pixels in RGB-Darstellung, jeweils im Bereich 0.0 bis 1.0
+     *
+     * FÜR FORTGESCHRITTENE:
+     * Für Abgaben, die selbst sicherstellen, dass nur innerhalb des
+     * Clip-Rechtecks (bzw. im Kachelmodus innerhalb der Kachel) gezeichnet
+     * wird, z.B. weil Dreiecke vorher geclippt wurden. Schreibzugriffe
+     * ausserhalb des Viewports führen zu Abstürzen!
+     */
+    virtual void setPixelUnchecked(unsigned int x, unsigned int y, const QVector3D& color) = 0;
+
+    /**
+     * @brief setSpan Setzt eine horizontale Folge von Pixeln auf eine einheitliche Farbe
+     * @param x Die x-Koordinate des ersten Pixels
+     * @param y Die y-Koordinate der Zeile
+     * @param length Die Anzahl der zu setzenden Pixel
+     * @param color Die Farbe der Pixel in RGB-Darstellung, jeweils im Bereich 0.0 bis 1.0
+     *
+     * Im Gegensatz zu setPixel wird die Farbe nur einmal umgerechnet und die
+     * Grenzen des Viewports nur einmal geprüft. Teile der Zeile ausserhalb
+     * des Viewports werden abgeschnitten, Farbwerte auf 0.0 bis 1.0 begrenzt.
+     */
+    virtual void setSpan(unsigned int x, unsigned int y, unsigned int length, const QVector3D& color) = 0;
+
+    /**
+     * @brief setRow Übernimmt eine Folge von Pixeln aus einem Fließkomma-Array
+     * @param x Die x-Koordinate des ersten Pixels
+     * @param y Die y-Koordinate der Zeile
+     * @param length Die Anzahl der zu setzenden Pixel
+     * @param rgb Ein Array mit 3*length Werten (r, g, b, r, g, b, ...), jeweils im Bereich 0.0 bis 1.0
+     *
+     * Die Umrechnung erfolgt für die gesamte Zeile am Stück. Ein Array aus
+     * QVector3D-Werten kann z.B. mit reinterpret_cast<const float*> übergeben
+     * werden.
+     */
+    virtual void setRow(unsigned int x, unsigned int y, unsigned int length, const float* rgb) = 0;
+
+    /**
+     * @brief setRow Übernimmt eine Folge bereits umgerechneter Pixel
+     * @param x Die x-Koordinate des ersten Pixels
+     * @param y Die y-Koordinate der Zeile
+     * @param length Die Anzahl der zu setzenden Pixel
+     * @param pixels Ein Array mit length Werten im QRgb-Format (z.B. erzeugt mit qRgb(r, g, b))
+     */
+    virtual void setRow(unsigned int x, unsigned int y, unsigned int length, const QRgb* pixels) = 0;
+
+    /**
+     * @brief fillRect Füllt ein Rechteck im Back-Buffer mit einer Farbe
+     * @param x Die x-Koordinate der linken oberen Ecke
+     * @param y Die y-Koordinate der linken oberen Ecke
+     * @param width Die Breite des Rechtecks
+     * @param height Die Höhe des Rechtecks
+     * @param color Die Farbe in RGB-Darstellung, jeweils im Bereich 0.0 bis 1.0
+     */
+    virtual void fillRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const QVector3D& color) = 0;
+
+    /**
+     * @brief setClipRect Beschränkt alle folgenden Zeichenoperationen auf ein Rechteck (Scissor)
+     * @param rect Der Bereich, in dem gezeichnet werden darf. Ein leeres QRect() hebt die Beschränkung auf.
+     *
+     * Pixel ausserhalb des Rechtecks werden ohne Warnung verworfen, auch von
+     * clearBuffer. Das Rechteck wird immer zusätzlich auf den Viewport (im
+     * Kachelmodus auf die Kachel) beschränkt und bleibt bis zum nächsten
+     * Aufruf erhalten. Im Kachelmodus gilt ein in beginFrame gesetztes
+     * Rechteck für alle Kacheln.
+     */
+    virtual void setClipRect(const QRect& rect) = 0;
+
+    /**
+     * @brief clipRect Liefert den Bereich, in dem momentan gezeichnet werden kann
+     * @return Das Clip-Rechteck, bereits auf den Viewport bzw. die Kachel beschränkt
+     */
+    virtual QRect clipRect() = 0;
+
+    /**
+     * @brief getPixel Liest die Farbe eines Pixels aus dem Back-Buffer
+     * @param x Die x-Koordinate des Pixels
+     * @param y Die y-Koordinate des Pixels
+     * @return Die Farbe in RGB-Darstellung, jeweils im Bereich 0.0 bis 1.0. Ausserhalb des Viewports schwarz.
+     */
+    virtual QVector3D getPixel(unsigned int x, unsigned int y) = 0;
+
+    /**
+     * @brief getRow Liest eine Folge von Pixeln aus dem Back-Buffer
+     * @param x Die x-Koordinate des ersten Pixels
+     * @param y Die y-Koordinate der Zeile
+     * @param length Die Anzahl der zu lesenden Pixel
+     * @param pixels Ziel-Array für length Werte im QRgb-Format
+     *
+     * Pixel ausserhalb des Viewports werden nicht gelesen; die entsprechenden
+     * Einträge in pixels bleiben unverändert.
+     */
+    virtual void getRow(unsigned int x, unsigned int y, unsigned int length, QRgb* pixels) = 0;
+
+    /**
+     * @brief mapBuffer Ermöglicht den direkten Zugriff auf den Speicher des Back-Buffers
+     * @return Zeiger, Größe, Zeilenabstand und Pixelformat des Back-Buffers
+     *
+     * FÜR FORTGESCHRITTENE:
+     * Anstatt einen eigenen QImage-Puffer zu verwalten und mit
+     * flipBuffer(const QImage&) zu übernehmen, kann direkt im Back-Buffer
+     * gelesen und geschrieben werden (z.B. für Blending). Der zurückgegebene
+     * Zeiger ist nur bis zum zugehörigen Aufruf von unmapBuffer, längstens
+     * jedoch bis zum Ende der render-Methode gültig. Zu jedem mapBuffer gehört
+     * genau ein unmapBuffer - am einfachsten mit GdvCanvas::ScopedMapping.
+     *
+     * Schreibzugriffe ausserhalb von width/height führen zu Abstürzen!
+     */
+    virtual BufferMapping mapBuffer() = 0;
+
+    /**
+     * @brief unmapBuffer Beendet den mit mapBuffer begonnenen direkten Zugriff
+     *
+     * Die Zeichenfläche geht davon aus, dass der gesamte Back-Buffer
+     * verändert wurde, und stellt beim nächsten flipBuffer alles neu dar.
+     */
+    virtual void unmapBuffer() = 0;
+
+    /**
+     * @brief unmapBuffer Beendet den direkten Zugriff, bei dem nur ein Teil des Back-Buffers verändert wurde
+     * @param modified Das Rechteck, das alle veränderten Pixel umschließt
+     *
+     * Wie unmapBuffer(), es werden aber nur die Pixel in modified neu
+     * dargestellt bzw. beim nächsten clearBuffer gelöscht. Wurde ausserhalb
+     * von modified geschrieben, ist die Darstellung undefiniert.
+     */
+    virtual void unmapBuffer(const QRect& modified) = 0;
+
     /**
      * @brief clearBuffer Löscht den aktuellen Backpuffer und setzt die Hintergrundfarbe auf den angegebenen Wert
      * @param clearColor Die zu setzende Farbe in RGB-Darstellung, jeweils im Bereich 0.0 bis 1.0
+     *
+     * Ein vorhandener Tiefenpuffer (siehe depthBuffer) wird ebenfalls gelöscht.
      */
     virtual void clearBuffer(const QVector3D& clearColor) = 0;
 
+    /**
+     * @brief depthBuffer Liefert den Tiefenpuffer der Zeichenfläche
+     * @return Der Tiefenpuffer, oder 0 falls die Abgabe keinen angefordert hat (siehe RendererBase::usesDepthBuffer)
+     *
+     * Der Tiefenpuffer hat immer dieselbe Größe wie der Back-Buffer.
+     */
+    virtual DepthBuffer* depthBuffer() = 0;
+
+    /**
+     * @brief multisampleBuffer Liefert die Samples der Zeichenfläche im Multisampling-Modus
+     * @return Die Samples, oder 0 falls die Abgabe kein Multisampling angefordert hat (siehe RendererBase::sampleCount)
+     *
+     * Alle Zeichenoperationen setzen dann sämtliche Samples eines Pixels;
+     * geglättete Kanten entstehen durch Primitives und Rasterizer, die nur die
+     * überdeckten Samples schreiben. mapBuffer liefert in diesem Modus die
+     * Ebene von Sample 0, deren veränderter Bereich bei unmapBuffer in alle
+     * übrigen Samples übernommen wird.
+     */
+    virtual MultisampleBuffer* multisampleBuffer() = 0;
+
+    /**
+     * @brief setToneMapping Legt fest, wie ein HDR-Back-Buffer beim flipBuffer dargestellt wird
+     * @param mode Das Verfahren zur Umrechnung heller Farbwerte
+     * @param exposure Faktor, mit dem alle Farbwerte vor der Umrechnung multipliziert werden
+     * @param sRGB true, falls die linearen Farbwerte zusätzlich in den sRGB-Farbraum umgerechnet werden sollen
+     *
+     * Hat nur eine Wirkung, wenn die Abgabe mit usesHDR() einen Fließkomma-
+     * Back-Buffer anfordert. Im Kachelmodus muss diese Methode in beginFrame
+     * aufgerufen werden.
+     */
+    virtual void setToneMapping(ToneMapping mode, float exposure = 1.0f, bool sRGB = false) = 0;
+
     /**
      * @brief flipBuffer Übernimmt die Änderungen seit dem letzten Aufruf
      *
@@ -66,6 +326,11 @@ public:
      * Durch das direkte verwenden eines QImages kann evtl. ein wenig Rechenzeit
      * eingespart werden, da direkt auf den Speicher des Bildes zugegriffen
      * werden kann.
+     *
+     * Das Bild wird nicht kopiert, sondern (wie bei QImage üblich) gemeinsam
+     * genutzt. Ein QImage, das auf eigenem Speicher angelegt wurde
+     * (QImage(uchar* data, ...)), darf daher bis zum nächsten flipBuffer
+     * nicht verändert werden.
      */
     virtual void flipBuffer(const QImage& buffer) = 0;
 };
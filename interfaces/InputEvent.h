@@ -0,0 +1,64 @@
+#ifndef INPUTEVENT_H
+#define INPUTEVENT_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Die InputEvent Struktur beschreibt eine Eingabe auf der Zeichenfläche
+ *
+ * Alle Eingaben seit dem letzten Bild werden gesammelt und unmittelbar vor
+ * dem nächsten render-Aufruf gemeinsam an RendererBase::inputEvents
+ * übergeben. Aufeinanderfolgende Mausbewegungen werden dabei zu einem
+ * Ereignis mit der letzten Position zusammengefasst, aufeinanderfolgende
+ * Mausradbewegungen zu einem Ereignis mit der Summe der Werte.
+ *
+ * type: Die Art der Eingabe
+ * x, y: Die Position des Mauszeigers (Mausereignisse)
+ * button: Die gedrückte bzw. losgelassene Maustaste (Qt::MouseButton),
+ *         bei MouseMoved alle gehaltenen Maustasten (Qt::MouseButtons)
+ * delta: Die Bewegung des Mausrads (WheelMoved)
+ * key: Der Tastencode (Qt::Key) der Taste (KeyPressed, KeyReleased)
+ * character: Das Zeichen der Taste als Unicode-Codepunkt, 0 ohne Zeichen
+ *            (z.B. Pfeiltasten); text() liefert es als QString wie bei
+ *            keyPressed bzw. keyReleased
+ * timestamp: Zeitpunkt der (letzten zusammengefassten) Eingabe in Mikrosekunden
+ * merged: Anzahl der in diesem Ereignis zusammengefassten Eingaben
+ */
+struct InputEvent
+{
+    enum Type
+    {
+        MousePressed,
+        MouseReleased,
+        MouseMoved,
+        WheelMoved,
+        KeyPressed,
+        KeyReleased
+    };
+
+    Type type;
+    int x, y;
+    int button;
+    int delta;
+    int key;
+    char32_t character;
+    qint64 timestamp;
+    int merged;
+
+    // Wird erst bei Bedarf erzeugt, damit Tastendrücke in der Warteschlange keinen Speicher anfordern
+    QString text() const
+    {
+        const uint code = character;
+        return code ? QString::fromUcs4(&code, 1) : QString();
+    }
+};
+
+#endif // INPUTEVENT_H
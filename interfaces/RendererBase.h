@@ -13,10 +13,13 @@
 #include <QtOpenGL>
 
 #include <QImage>
+#include <QRect>
 #include "GdvGui.h"
 #include "GdvCanvas.h"
+#include "InputEvent.h"
 
 #include "framework/meshloader.h"
+#include "framework/profiler.h"
 
 /**
  * @brief Die RendererBase Klasse
@@ -62,9 +65,57 @@ public:
      * 60 mal in der Sekunde aufgerufen wird.
      *
      * Wichtig: canvas ist nur im Kontext dieser Methode gültig!
+     *
+     * FÜR FORTGESCHRITTENE:
+     * Mit GDV_PROFILE_ZONE("Name") wird der Rest eines Blocks als eigene Zone
+     * gemessen, z.B. am Anfang einer Schleife über alle Dreiecke. Über
+     * "Record profiler trace" aufgezeichnet erscheinen die Zonen dann unterhalb
+     * von render neben denen des Frameworks (clear, flip, present, ...).
      */
     virtual void render(GdvCanvas& canvas) = 0;
 
+    /**
+     * @brief usesTiles Gibt an, ob diese Abgabe kachelweise auf allen Prozessorkernen gezeichnet werden kann
+     * @return true, falls renderTile statt render verwendet werden soll
+     *
+     * -- Die Implementierung dieser Methode ist optional.
+     *
+     * FÜR FORTGESCHRITTENE:
+     * Liefert diese Methode true, wird im nicht-OpenGL-Modus anstelle von
+     * render für jedes Bild einmal beginFrame und anschließend für jede Kachel
+     * des Viewports renderTile aufgerufen. Die Kacheln werden dabei
+     * gleichzeitig auf allen Prozessorkernen gezeichnet. flipBuffer wird vom
+     * Framework aufgerufen, nachdem alle Kacheln fertig sind.
+     */
+    virtual bool usesTiles() { return false; }
+
+    /**
+     * @brief beginFrame Wird im Kachelmodus vor dem Zeichnen der Kacheln eines Bildes aufgerufen
+     * @param canvas Die Zeichenfläche des gesamten Bildes
+     *
+     * -- Die Implementierung dieser Methode ist optional.
+     *
+     * Hier sollten alle Werte aktualisiert werden, die für das gesamte Bild
+     * gelten (z.B. die Zeit einer Animation oder das Tonemapping). Die
+     * Methode wird nicht parallel aufgerufen. In canvas sollte hier nicht
+     * gezeichnet werden.
+     */
+    virtual void beginFrame(GdvCanvas& canvas) { Q_UNUSED(canvas); }
+
+    /**
+     * @brief renderTile Zeichenmethode für eine einzelne Kachel im Kachelmodus
+     * @param canvas Die Zeichenfläche der Kachel
+     * @param tile Der Bereich des Viewports, der gezeichnet werden soll
+     *
+     * -- Die Implementierung dieser Methode ist optional.
+     *
+     * Zeichenoperationen ausserhalb von tile werden verworfen, clearBuffer
+     * löscht nur die Kachel. Wichtig: Diese Methode wird gleichzeitig aus
+     * mehreren Threads aufgerufen! Membervariablen dürfen hier nur gelesen,
+     * aber nicht verändert werden.
+     */
+    virtual void renderTile(GdvCanvas& canvas, const QRect& tile) { Q_UNUSED(canvas); Q_UNUSED(tile); }
+
     /**
      * @brief deinitialize Deinitialisierungsmethode, die vor dem Wechsel zu einer anderen Abgabe einmalig ausgeführt wird
      *
@@ -81,6 +132,8 @@ public:
      *
      * Eigene Buffer (Tiefenbuffer, Framebuffer, etc.) sollten - wann immer
      * diese Methode aufgerufen wird - angepasst bzw. reinitialisiert werden.
+     * Beim Aufziehen des Fensters geschieht das sehr häufig; mit PooledBuffer
+     * (framework/pooledbuffer.h) wird dabei nur selten Speicher angefordert.
      *
      * Hinweis: Auf manchen Systemen und QT-Versionen kann beim Start der GUI
      * kurzzeitig eine Höhe oder Breite von 0 auftauchen. Dieses Verhalten kann
@@ -99,6 +152,85 @@ public:
      */
     virtual bool usesOpenGL() = 0;
 
+    /**
+     * @brief usesRenderThread Gibt an, ob diese Abgabe in einem eigenen Render-Thread gezeichnet werden soll
+     * @return true, falls render unabhängig von der GUI in einem eigenen Thread aufgerufen werden soll
+     *
+     * -- Die Implementierung dieser Methode ist optional.
+     *
+     * FÜR FORTGESCHRITTENE:
+     * Im nicht-OpenGL-Modus wird render dann fortlaufend in einem eigenen
+     * Thread aufgerufen, sodass die GUI auch bei sehr langsamen Abgaben
+     * bedienbar bleibt. Sämtliche übrigen Methoden (Maus/Tastatur, Mesh,
+     * Textur, Größenänderung, Buttons und Auswahllisten) sowie die
+     * Änderungen verknüpfter GUI-Variablen werden zwischen zwei Bildern
+     * ebenfalls im Render-Thread ausgeführt.
+     *
+     * Wichtig: In diesem Modus dürfen in keiner Methode der Abgabe Fenster
+     * oder andere GUI-Elemente (z.B. QMessageBox) erzeugt werden!
+     */
+    virtual bool usesRenderThread() { return false; }
+
+    /**
+     * @brief usesHDR Gibt an, ob diese Abgabe in einen Fließkomma-Back-Buffer (HDR) zeichnen möchte
+     * @return true, falls Farbwerte ausserhalb von 0.0 bis 1.0 erhalten bleiben sollen
+     *
+     * -- Die Implementierung dieser Methode ist optional.
+     *
+     * FÜR FORTGESCHRITTENE:
+     * Im nicht-OpenGL-Modus werden die Farben dann unbegrenzt als floats
+     * gespeichert (mapBuffer liefert FormatRGBA32F) und erst beim flipBuffer
+     * mit dem per GdvCanvas::setToneMapping gewählten Verfahren in darstellbare
+     * Farben umgerechnet. So lässt sich Licht physikalisch korrekt aufsummieren.
+     */
+    virtual bool usesHDR() { return false; }
+
+    /**
+     * @brief usesDepthBuffer Gibt an, ob die Zeichenfläche einen Tiefenpuffer bereitstellen soll
+     * @return true, falls GdvCanvas::depthBuffer() einen Tiefenpuffer liefern soll
+     *
+     * -- Die Implementierung dieser Methode ist optional.
+     *
+     * Im nicht-OpenGL-Modus verwaltet das Framework dann einen Tiefenpuffer
+     * in der Größe der Zeichenfläche, der mit clearBuffer gelöscht und vom
+     * Rasterizer automatisch verwendet wird. Ein eigener z-Buffer ist nicht
+     * mehr notwendig.
+     */
+    virtual bool usesDepthBuffer() { return false; }
+
+    /**
+     * @brief sampleCount Gibt an, wie viele Farbwerte (Samples) je Pixel gespeichert werden sollen
+     * @return 1 (kein Multisampling), 2, 4 oder 8
+     *
+     * -- Die Implementierung dieser Methode ist optional.
+     *
+     * FÜR FORTGESCHRITTENE:
+     * Im nicht-OpenGL-Modus (und ohne Kachelmodus) verwaltet die
+     * Zeichenfläche dann einen MultisampleBuffer (siehe
+     * GdvCanvas::multisampleBuffer). Primitives und Rasterizer schreiben nur
+     * die von einem Primitiv überdeckten Samples, beim flipBuffer werden die
+     * Samples mit dem gewählten Filter zu geglätteten Pixeln zusammengefasst.
+     * Ein eigener, vergrößerter Puffer zur Kantenglättung ist nicht mehr
+     * notwendig.
+     */
+    virtual int sampleCount() { return 1; }
+
+    /**
+     * @brief targetFrameRate Gibt an, welche Bildrate die Zeichenfläche halten soll
+     * @return Bilder pro Sekunde, 0.0 (Voreinstellung): immer in Fenstergröße zeichnen
+     *
+     * -- Die Implementierung dieser Methode ist optional.
+     *
+     * FÜR FORTGESCHRITTENE:
+     * Im nicht-OpenGL-Modus zeichnet die Abgabe dann in eine interne
+     * Auflösung, die anhand der gemessenen Zeit je Bild laufend angepasst
+     * und bei der Darstellung auf die Fenstergröße skaliert wird (bis
+     * herunter auf ein Viertel der Kantenlänge). Jede Änderung wird mit
+     * sizeChanged gemeldet, dort und bei den Mausereignissen gelten also
+     * immer die Koordinaten der internen Auflösung.
+     */
+    virtual float targetFrameRate() { return 0.0f; }
+
     /**
      * @brief meshChanged Wird aufgerufen, wenn in der GUI der aktive Mesh geändert wurde
      * @param faces Eine Liste/Vektor mit den einzelnen Faces des Meshes
@@ -122,6 +254,8 @@ public:
      * wird diese Methode ausgeführt. Die Höhe und Breite der Textur kann über
      * die width() bzw. height() Methode des QImages ermittelt werden. Mit der
      * pixel(x, y)-Methode kann der Farbwert eines Pixels ermittelt werden.
+     * Für schnelle, gefilterte Zugriffe kann das Bild in ein Texture-Objekt
+     * (framework/texture.h) übernommen werden.
      *
      * Hinweis: Im OpenGL-Modus ist das übergebene QImage bereits in ein
      * kompatibles Format kovertiert worden. Mit der bits()-Methode kann auf den
@@ -189,6 +323,40 @@ public:
      */
     virtual void keyReleased(QString key)        { Q_UNUSED(key); }
 
+    /**
+     * @brief inputEvents Wird vor jedem render-Aufruf mit allen Eingaben seit dem letzten Bild aufgerufen
+     * @param events Die Eingaben in der Reihenfolge ihres Auftretens (siehe InputEvent)
+     *
+     * -- Die Implementierung dieser Methode ist optional.
+     *
+     * Ohne eigene Implementierung werden für jedes Ereignis die Methoden
+     * mousePressed, mouseReleased, mouseMoved, wheelMoved, keyPressed bzw.
+     * keyReleased aufgerufen. Aufeinanderfolgende Mausbewegungen sind bereits
+     * zusammengefasst, mouseMoved wird also höchstens einmal zwischen zwei
+     * Klicks und nur mit der letzten Position aufgerufen.
+     *
+     * FÜR FORTGESCHRITTENE:
+     * Wer alle Eingaben eines Bildes gemeinsam auswerten möchte (z.B. eine
+     * Kamera nur einmal je Bild neu berechnen), überschreibt diese Methode.
+     * Die Zeitstempel erlauben dabei bildratenunabhängige Bewegungen.
+     */
+    virtual void inputEvents(const QVector<InputEvent>& events)
+    {
+        for(int n = 0; n < events.size(); n++)
+        {
+            const InputEvent& event = events[n];
+            switch(event.type)
+            {
+            case InputEvent::MousePressed:  mousePressed(event.x, event.y);  break;
+            case InputEvent::MouseReleased: mouseReleased(event.x, event.y); break;
+            case InputEvent::MouseMoved:    mouseMoved(event.x, event.y);    break;
+            case InputEvent::WheelMoved:    wheelMoved(event.delta);         break;
+            case InputEvent::KeyPressed:    keyPressed(event.text());        break;
+            case InputEvent::KeyReleased:   keyReleased(event.text());       break;
+            }
+        }
+    }
+
     virtual ~RendererBase() {}
 };
 
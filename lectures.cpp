@@ -0,0 +1,19 @@
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+#include "lectures.h"
+#include "interfaces/GdvGui.h"
+
+#include "examples/frameworkexample.h"
+
+void registerLectures(GdvGui& gui)
+{
+    gui.addLecture("Beispielprojekt", new FrameworkExample());
+    // ...
+    // Hier können eigene Abgaben eingetragen werden.
+}
@@ -0,0 +1,22 @@
+#ifndef LECTURES_H
+#define LECTURES_H
+/**
+ ** Leibniz Universität Hannover - Institute for Man-Machine-Communication
+ ** Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+ **
+ ** You should have received a copy of the MIT License along with this program.
+ **
+ **/
+
+class GdvGui;
+
+/**
+ * @brief registerLectures Trägt alle Abgaben mit GdvGui::addLecture ein
+ *
+ * Wird sowohl vom Hauptprogramm als auch vom Headless-Runner (GDV-Headless)
+ * aufgerufen, eigene Abgaben müssen also nur in lectures.cpp eingetragen
+ * werden. Die zugehörigen Dateien gehören in lectures.pri.
+ */
+void registerLectures(GdvGui& gui);
+
+#endif // LECTURES_H
@@ -0,0 +1,17 @@
+#
+# Leibniz Universität Hannover - Institute for Man-Machine-Communication
+# Copyright (c) 2013-2016 Andreas Tarnowsky <tarnowsky@welfenlab.de>
+#
+# You should have received a copy of the MIT License along with this program.
+#
+# Die Abgaben. Eigene Dateien hier eintragen, damit sie sowohl im
+# Hauptprogramm als auch im Headless-Runner zur Verfügung stehen.
+#
+
+SOURCES += \
+    $$PWD/lectures.cpp \
+    $$PWD/examples/frameworkexample.cpp
+
+HEADERS += \
+    $$PWD/lectures.h \
+    $$PWD/examples/frameworkexample.h
@@ -9,7 +9,7 @@
 #include "framework/mainwindow.h"
 #include <QApplication>
 
-#include "examples/frameworkexample.h"
+#include "lectures.h"
 
 int main(int argc, char *argv[])
 {
@@ -19,10 +19,8 @@ int main(int argc, char *argv[])
     a.setOrganizationName("Leibniz Universität Hannover - Welfenlab");
     MainWindow w;
 
-    w.addLecture("Beispielprojekt", new FrameworkExample());
-    // ...
-    // Hier können eigene Abgaben eingetragen werden.
-   
+    // Eigene Abgaben werden in lectures.cpp eingetragen
+    registerLectures(w);
 
     w.setDefaultIndices(0,0,0);
     w.show();    